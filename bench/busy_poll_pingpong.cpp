@@ -0,0 +1,85 @@
+/**
+  ******************************************************************************
+  * @file           : busy_poll_pingpong.cpp
+  * @author         : huzhida
+  * @brief          : 回环ping-pong延迟对比:阻塞接收 vs 忙轮询接收
+  * @date           : 2026/10/18
+  ******************************************************************************
+  */
+
+#include "../src/Socket/Socket.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace {
+    const unsigned short bench_port = 9998;
+    const size_t message_size = 64;
+
+    struct Result {
+        double p50_us;
+        double p99_us;
+        double p999_us;
+    };
+
+    double percentile(std::vector<double>& samples,double percentile) {
+        auto index = static_cast<size_t>(percentile / 100.0 * static_cast<double>(samples.size() - 1));
+        std::nth_element(samples.begin(),samples.begin() + static_cast<long>(index),samples.end());
+        return samples[index];
+    }
+
+    Result run(bool is_busy_poll,int rounds) {
+        hzd::TcpListener listener("127.0.0.1",bench_port);
+        if(!listener.Bind() || !listener.Listen()) {
+            fprintf(stderr,"bind/listen failed\n");
+            exit(1);
+        }
+        hzd::BusyPollOptions options;
+        std::thread echo([&] {
+            hzd::TcpSocket server;
+            if(!listener.Accept(server)) return;
+            if(is_busy_poll) server.SetBusyPoll(true,options);
+            std::string data;
+            for(int i = 0; i < rounds; i++) {
+                if(server.Recv(data,message_size,false) != static_cast<long>(message_size)) return;
+                if(server.Send(data) != static_cast<long>(message_size)) return;
+            }
+        });
+
+        hzd::TcpClient client;
+        if(!client.Connect("127.0.0.1",bench_port)) {
+            fprintf(stderr,"connect failed\n");
+            exit(1);
+        }
+        if(is_busy_poll) client.SetBusyPoll(true,options);
+        std::string message(message_size,'x'),reply;
+        std::vector<double> samples;
+        samples.reserve(rounds);
+        for(int i = 0; i < rounds; i++) {
+            auto start = std::chrono::steady_clock::now();
+            client.Send(message);
+            client.Recv(reply,message_size,false);
+            samples.push_back(std::chrono::duration<double,std::micro>(std::chrono::steady_clock::now() - start).count());
+        }
+        echo.join();
+        client.Close();
+        listener.Close();
+        // 丢弃预热样本 & drop warm-up samples
+        samples.erase(samples.begin(),samples.begin() + std::min<long>(1000,static_cast<long>(samples.size()) / 10));
+        return {percentile(samples,50),percentile(samples,99),percentile(samples,99.9)};
+    }
+}
+
+int main(int argc,char** argv) {
+    int rounds = argc > 1 ? atoi(argv[1]) : 20000;
+    if(rounds < 10) rounds = 10;
+    Result blocking = run(false,rounds);
+    Result busy = run(true,rounds);
+    printf("%-12s %10s %10s %10s\n","mode","p50(us)","p99(us)","p99.9(us)");
+    printf("%-12s %10.2f %10.2f %10.2f\n","blocking",blocking.p50_us,blocking.p99_us,blocking.p999_us);
+    printf("%-12s %10.2f %10.2f %10.2f\n","busy-poll",busy.p50_us,busy.p99_us,busy.p999_us);
+    return 0;
+}
@@ -0,0 +1,440 @@
+/**
+  ******************************************************************************
+  * @file           : AsyncFile.cpp
+  * @author         : huzhida
+  * @brief          : None
+  * @date           : 2026/10/18
+  ******************************************************************************
+  */
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <thread>
+#elif _WIN32
+#define _CRT_SECURE_NO_WARNINGS
+#include <windows.h>
+#include <io.h>
+#include <fcntl.h>
+#endif
+#include <Mole.h>
+#include "AsyncFile.h"
+#include "../ThreadPool/ThreadPool.h"
+#include <algorithm>
+#include <vector>
+
+namespace hzd {
+
+    const std::string io_async_file_channel = "io.AsyncFile";
+
+    enum class AsyncOp {
+        OPEN,
+        READ,
+        WRITE,
+        FSYNC,
+        STAT,
+        CLOSE
+    };
+
+    struct AsyncFileService::Operation {
+        AsyncOp                     op;
+        int                         fd{-1};
+        std::string                 path;
+        int                         flags{0};
+        uint32_t                    mode{0};
+        uint64_t                    offset{0};
+        // 读缓冲区或待写数据 & read buffer or data to write
+        std::string                 buffer;
+        AsyncCallback               callback;
+        std::promise<AsyncResult>   promise;
+        AsyncResult                 result;
+#ifdef __linux__
+        struct statx                stx{};
+#endif
+    };
+
+#ifdef __linux__
+    struct AsyncFileService::Ring {
+        int                 fd{-1};
+        void*               sq_ptr{nullptr};
+        size_t              sq_size{0};
+        void*               cq_ptr{nullptr};
+        size_t              cq_size{0};
+        io_uring_sqe*       sqes{nullptr};
+        size_t              sqes_size{0};
+        unsigned*           sq_head{nullptr};
+        unsigned*           sq_tail{nullptr};
+        unsigned*           sq_mask{nullptr};
+        unsigned*           sq_array{nullptr};
+        unsigned            sq_entries{0};
+        unsigned*           cq_head{nullptr};
+        unsigned*           cq_tail{nullptr};
+        unsigned*           cq_mask{nullptr};
+        io_uring_cqe*       cqes{nullptr};
+        // 多个线程可能同时提交 & several threads may submit concurrently
+        std::mutex          mutex;
+        std::thread         thread;
+
+        ~Ring() {
+            if(sqes) munmap(sqes,sqes_size);
+            if(cq_ptr && cq_ptr != sq_ptr) munmap(cq_ptr,cq_size);
+            if(sq_ptr) munmap(sq_ptr,sq_size);
+            if(fd >= 0) close(fd);
+        }
+    };
+
+    static void statxToResult(const struct statx& stx,filesystem::StatResult& stat) {
+        using filesystem::EntryType;
+        stat.type = S_ISDIR(stx.stx_mode) ? EntryType::DIRECTORY : S_ISREG(stx.stx_mode) ? EntryType::FILE : S_ISLNK(stx.stx_mode) ? EntryType::SYMLINK : EntryType::OTHER;
+        stat.mode = stx.stx_mode & 07777;
+        stat.size = stx.stx_size;
+        stat.mtime_ns = static_cast<int64_t>(stx.stx_mtime.tv_sec) * 1000000000 + stx.stx_mtime.tv_nsec;
+        stat.inode = stx.stx_ino;
+    }
+#elif _WIN32
+    struct AsyncFileService::Ring {};
+#endif
+
+    AsyncFileService::AsyncFileService(const AsyncFileOptions &options_) : options(options_) {
+        if(options.queue_depth == 0) options.queue_depth = 1;
+        if(options.backend != AsyncBackend::THREAD_POOL && setupRing_()) {
+            backend = AsyncBackend::IO_URING;
+            return;
+        }
+        if(options.backend == AsyncBackend::IO_URING) {
+            MOLE_WARN(io_async_file_channel,"io_uring unavailable,fall back to thread pool");
+        }
+        backend = AsyncBackend::THREAD_POOL;
+        pool.reset(new ThreadPool(options.threads));
+    }
+
+    AsyncFileService::~AsyncFileService() {
+        Wait();
+#ifdef __linux__
+        if(ring) {
+            // user_data为0的空操作通知完成线程退出 & a nop with user_data 0 tells the completion thread to exit
+            {
+                std::lock_guard<std::mutex> guard(ring->mutex);
+                unsigned tail = *ring->sq_tail;
+                unsigned index = tail & *ring->sq_mask;
+                io_uring_sqe& sqe = ring->sqes[index];
+                memset(&sqe,0,sizeof(sqe));
+                sqe.opcode = IORING_OP_NOP;
+                ring->sq_array[index] = index;
+                __atomic_store_n(ring->sq_tail,tail + 1,__ATOMIC_RELEASE);
+                syscall(__NR_io_uring_enter,ring->fd,1,0,0,nullptr,0);
+            }
+            ring->thread.join();
+        }
+#endif
+    }
+
+    std::future<AsyncResult> AsyncFileService::Open(const std::string &path, int flags, AsyncCallback callback, uint32_t mode) {
+        auto operation = new Operation;
+        operation->op = AsyncOp::OPEN;
+        operation->path = path;
+        operation->flags = flags;
+        operation->mode = mode;
+        operation->callback = std::move(callback);
+        return submit_(operation);
+    }
+
+    std::future<AsyncResult> AsyncFileService::Read(int fd, uint64_t offset, size_t size, AsyncCallback callback) {
+        auto operation = new Operation;
+        operation->op = AsyncOp::READ;
+        operation->fd = fd;
+        operation->offset = offset;
+        operation->buffer.resize(size);
+        operation->callback = std::move(callback);
+        return submit_(operation);
+    }
+
+    std::future<AsyncResult> AsyncFileService::Write(int fd, uint64_t offset, std::string data, AsyncCallback callback) {
+        auto operation = new Operation;
+        operation->op = AsyncOp::WRITE;
+        operation->fd = fd;
+        operation->offset = offset;
+        operation->buffer = std::move(data);
+        operation->callback = std::move(callback);
+        return submit_(operation);
+    }
+
+    std::future<AsyncResult> AsyncFileService::Fsync(int fd, bool is_datasync, AsyncCallback callback) {
+        auto operation = new Operation;
+        operation->op = AsyncOp::FSYNC;
+        operation->fd = fd;
+        operation->flags = is_datasync ? 1 : 0;
+        operation->callback = std::move(callback);
+        return submit_(operation);
+    }
+
+    std::future<AsyncResult> AsyncFileService::Stat(const std::string &path, AsyncCallback callback) {
+        auto operation = new Operation;
+        operation->op = AsyncOp::STAT;
+        operation->path = path;
+        operation->callback = std::move(callback);
+        return submit_(operation);
+    }
+
+    std::future<AsyncResult> AsyncFileService::Close(int fd, AsyncCallback callback) {
+        auto operation = new Operation;
+        operation->op = AsyncOp::CLOSE;
+        operation->fd = fd;
+        operation->callback = std::move(callback);
+        return submit_(operation);
+    }
+
+    void AsyncFileService::Wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle_condition.wait(lock,[this] { return in_flight.load(std::memory_order_acquire) == 0; });
+    }
+
+    std::future<AsyncResult> AsyncFileService::submit_(Operation *operation) {
+        auto future = operation->promise.get_future();
+        // 有界队列:满时不阻塞调用线程 & bounded queue: never block the caller when full
+        if(in_flight.fetch_add(1,std::memory_order_acq_rel) >= options.queue_depth) {
+            operation->result.result = -EAGAIN;
+            complete_(operation);
+            return future;
+        }
+        if(ring) {
+            if(!submitRing_(operation)) complete_(operation);
+            return future;
+        }
+        pool->Submit([this,operation] {
+            execute_(operation);
+            complete_(operation);
+        });
+        return future;
+    }
+
+    void AsyncFileService::complete_(Operation *operation) {
+        if(operation->callback) operation->callback(operation->result);
+        operation->promise.set_value(std::move(operation->result));
+        delete operation;
+        if(in_flight.fetch_sub(1,std::memory_order_acq_rel) == 1) {
+            std::lock_guard<std::mutex> guard(mutex);
+            idle_condition.notify_all();
+        }
+    }
+
+    void AsyncFileService::execute_(Operation *operation) {
+        auto& result = operation->result;
+#ifdef __linux__
+        ssize_t ret = 0;
+        switch(operation->op) {
+            case AsyncOp::OPEN:
+                ret = open(operation->path.c_str(),operation->flags | O_CLOEXEC,operation->mode);
+                break;
+            case AsyncOp::READ:
+                ret = pread(operation->fd,&operation->buffer[0],operation->buffer.size(),static_cast<off_t>(operation->offset));
+                if(ret >= 0) {
+                    operation->buffer.resize(static_cast<size_t>(ret));
+                    result.data = std::move(operation->buffer);
+                }
+                break;
+            case AsyncOp::WRITE:
+                ret = pwrite(operation->fd,operation->buffer.data(),operation->buffer.size(),static_cast<off_t>(operation->offset));
+                break;
+            case AsyncOp::FSYNC:
+                ret = operation->flags ? fdatasync(operation->fd) : fsync(operation->fd);
+                break;
+            case AsyncOp::STAT:
+                ret = statx(AT_FDCWD,operation->path.c_str(),AT_SYMLINK_NOFOLLOW,STATX_BASIC_STATS,&operation->stx);
+                if(ret == 0) statxToResult(operation->stx,result.stat);
+                break;
+            case AsyncOp::CLOSE:
+                ret = close(operation->fd);
+                break;
+        }
+        result.result = ret < 0 ? -errno : ret;
+        if(operation->op == AsyncOp::STAT) result.stat.error = ret < 0 ? errno : 0;
+#elif _WIN32
+        HANDLE handle = operation->fd >= 0 ? reinterpret_cast<HANDLE>(_get_osfhandle(operation->fd)) : INVALID_HANDLE_VALUE;
+        OVERLAPPED overlapped{};
+        overlapped.Offset = static_cast<DWORD>(operation->offset);
+        overlapped.OffsetHigh = static_cast<DWORD>(operation->offset >> 32);
+        DWORD bytes = 0;
+        switch(operation->op) {
+            case AsyncOp::OPEN:
+                result.result = _open(operation->path.c_str(),operation->flags | _O_BINARY,static_cast<int>(operation->mode));
+                if(result.result < 0) result.result = -errno;
+                break;
+            case AsyncOp::READ:
+                // 带偏移的ReadFile不依赖共享文件指针,可并发 & ReadFile with offset doesn't use the shared file pointer,safe to run concurrently
+                if(ReadFile(handle,&operation->buffer[0],static_cast<DWORD>(operation->buffer.size()),&bytes,&overlapped) || GetLastError() == ERROR_HANDLE_EOF) {
+                    operation->buffer.resize(bytes);
+                    result.data = std::move(operation->buffer);
+                    result.result = bytes;
+                }else {
+                    result.result = -EIO;
+                }
+                break;
+            case AsyncOp::WRITE:
+                result.result = WriteFile(handle,operation->buffer.data(),static_cast<DWORD>(operation->buffer.size()),&bytes,&overlapped) ? static_cast<int64_t>(bytes) : -EIO;
+                break;
+            case AsyncOp::FSYNC:
+                result.result = _commit(operation->fd) == 0 ? 0 : -errno;
+                break;
+            case AsyncOp::STAT: {
+                std::vector<filesystem::StatResult> stats;
+                filesystem::stat_batch({operation->path},stats,filesystem::DIR_STAT_SIZE | filesystem::DIR_STAT_MTIME | filesystem::DIR_STAT_INODE,1);
+                result.stat = stats.front();
+                result.result = -result.stat.error;
+                break;
+            }
+            case AsyncOp::CLOSE:
+                result.result = _close(operation->fd) == 0 ? 0 : -errno;
+                break;
+        }
+#endif
+    }
+
+    bool AsyncFileService::setupRing_() {
+#ifdef __linux__
+        std::unique_ptr<Ring> candidate(new Ring);
+        io_uring_params params{};
+        candidate->fd = static_cast<int>(syscall(__NR_io_uring_setup,static_cast<unsigned>(options.queue_depth),&params));
+        if(candidate->fd < 0) return false;
+        // 需要5.6以上内核的READ/WRITE/OPENAT/STATX/CLOSE操作码 & needs READ/WRITE/OPENAT/STATX/CLOSE opcodes from kernel 5.6+
+        std::vector<char> probe_buffer(sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op),0);
+        auto probe = reinterpret_cast<io_uring_probe*>(probe_buffer.data());
+        if(syscall(__NR_io_uring_register,candidate->fd,IORING_REGISTER_PROBE,probe,256) < 0) return false;
+        for(int op : {IORING_OP_OPENAT,IORING_OP_READ,IORING_OP_WRITE,IORING_OP_FSYNC,IORING_OP_STATX,IORING_OP_CLOSE}) {
+            if(op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) return false;
+        }
+        candidate->sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        candidate->cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool is_single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if(is_single_mmap) candidate->sq_size = candidate->cq_size = std::max(candidate->sq_size,candidate->cq_size);
+        void* sq_ptr = mmap(nullptr,candidate->sq_size,PROT_READ | PROT_WRITE,MAP_SHARED | MAP_POPULATE,candidate->fd,IORING_OFF_SQ_RING);
+        if(sq_ptr == MAP_FAILED) return false;
+        candidate->sq_ptr = sq_ptr;
+        void* cq_ptr = sq_ptr;
+        if(!is_single_mmap) {
+            cq_ptr = mmap(nullptr,candidate->cq_size,PROT_READ | PROT_WRITE,MAP_SHARED | MAP_POPULATE,candidate->fd,IORING_OFF_CQ_RING);
+            if(cq_ptr == MAP_FAILED) return false;
+        }
+        candidate->cq_ptr = cq_ptr;
+        candidate->sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = mmap(nullptr,candidate->sqes_size,PROT_READ | PROT_WRITE,MAP_SHARED | MAP_POPULATE,candidate->fd,IORING_OFF_SQES);
+        if(sqes == MAP_FAILED) return false;
+        candidate->sqes = static_cast<io_uring_sqe*>(sqes);
+        auto sq_base = static_cast<char*>(sq_ptr);
+        auto cq_base = static_cast<char*>(cq_ptr);
+        candidate->sq_head = reinterpret_cast<unsigned*>(sq_base + params.sq_off.head);
+        candidate->sq_tail = reinterpret_cast<unsigned*>(sq_base + params.sq_off.tail);
+        candidate->sq_mask = reinterpret_cast<unsigned*>(sq_base + params.sq_off.ring_mask);
+        candidate->sq_array = reinterpret_cast<unsigned*>(sq_base + params.sq_off.array);
+        candidate->sq_entries = params.sq_entries;
+        candidate->cq_head = reinterpret_cast<unsigned*>(cq_base + params.cq_off.head);
+        candidate->cq_tail = reinterpret_cast<unsigned*>(cq_base + params.cq_off.tail);
+        candidate->cq_mask = reinterpret_cast<unsigned*>(cq_base + params.cq_off.ring_mask);
+        candidate->cqes = reinterpret_cast<io_uring_cqe*>(cq_base + params.cq_off.cqes);
+        // 在途操作不超过SQ长度,CQ为其两倍,不会溢出 & in-flight ops never exceed SQ length and CQ is twice that,so it can't overflow
+        options.queue_depth = std::min<size_t>(options.queue_depth,params.sq_entries);
+        ring = std::move(candidate);
+        ring->thread = std::thread(&AsyncFileService::runRing_,this);
+        return true;
+#elif _WIN32
+        return false;
+#endif
+    }
+
+    bool AsyncFileService::submitRing_(Operation *operation) {
+#ifdef __linux__
+        std::lock_guard<std::mutex> guard(ring->mutex);
+        unsigned tail = *ring->sq_tail;
+        unsigned index = tail & *ring->sq_mask;
+        io_uring_sqe& sqe = ring->sqes[index];
+        memset(&sqe,0,sizeof(sqe));
+        sqe.user_data = reinterpret_cast<uint64_t>(operation);
+        switch(operation->op) {
+            case AsyncOp::OPEN:
+                sqe.opcode = IORING_OP_OPENAT;
+                sqe.fd = AT_FDCWD;
+                sqe.addr = reinterpret_cast<uint64_t>(operation->path.c_str());
+                sqe.len = operation->mode;
+                sqe.open_flags = static_cast<uint32_t>(operation->flags | O_CLOEXEC);
+                break;
+            case AsyncOp::READ:
+            case AsyncOp::WRITE:
+                sqe.opcode = operation->op == AsyncOp::READ ? IORING_OP_READ : IORING_OP_WRITE;
+                sqe.fd = operation->fd;
+                sqe.addr = reinterpret_cast<uint64_t>(operation->buffer.data());
+                sqe.len = static_cast<uint32_t>(operation->buffer.size());
+                sqe.off = operation->offset;
+                break;
+            case AsyncOp::FSYNC:
+                sqe.opcode = IORING_OP_FSYNC;
+                sqe.fd = operation->fd;
+                sqe.fsync_flags = operation->flags ? IORING_FSYNC_DATASYNC : 0;
+                break;
+            case AsyncOp::STAT:
+                sqe.opcode = IORING_OP_STATX;
+                sqe.fd = AT_FDCWD;
+                sqe.addr = reinterpret_cast<uint64_t>(operation->path.c_str());
+                sqe.len = STATX_BASIC_STATS;
+                sqe.off = reinterpret_cast<uint64_t>(&operation->stx);
+                sqe.statx_flags = AT_SYMLINK_NOFOLLOW;
+                break;
+            case AsyncOp::CLOSE:
+                sqe.opcode = IORING_OP_CLOSE;
+                sqe.fd = operation->fd;
+                break;
+        }
+        ring->sq_array[index] = index;
+        __atomic_store_n(ring->sq_tail,tail + 1,__ATOMIC_RELEASE);
+        while(syscall(__NR_io_uring_enter,ring->fd,1,0,0,nullptr,0) < 0) {
+            if(errno == EINTR) continue;
+            // 内核未取走该项,撤回 & kernel didn't consume the entry,take it back
+            operation->result.result = -errno;
+            MOLE_ERROR(io_async_file_channel,strerror(errno));
+            __atomic_store_n(ring->sq_tail,tail,__ATOMIC_RELEASE);
+            return false;
+        }
+        return true;
+#elif _WIN32
+        return false;
+#endif
+    }
+
+    void AsyncFileService::runRing_() {
+#ifdef __linux__
+        while(true) {
+            if(syscall(__NR_io_uring_enter,ring->fd,0,1,IORING_ENTER_GETEVENTS,nullptr,0) < 0 && errno != EINTR) {
+                MOLE_ERROR(io_async_file_channel,strerror(errno));
+                return;
+            }
+            unsigned head = *ring->cq_head;
+            unsigned tail = __atomic_load_n(ring->cq_tail,__ATOMIC_ACQUIRE);
+            bool is_stop = false;
+            for(; head != tail; head++) {
+                const io_uring_cqe& cqe = ring->cqes[head & *ring->cq_mask];
+                if(cqe.user_data == 0) {
+                    is_stop = true;
+                    continue;
+                }
+                auto operation = reinterpret_cast<Operation*>(cqe.user_data);
+                operation->result.result = cqe.res;
+                if(operation->op == AsyncOp::READ && cqe.res >= 0) {
+                    operation->buffer.resize(static_cast<size_t>(cqe.res));
+                    operation->result.data = std::move(operation->buffer);
+                }else if(operation->op == AsyncOp::STAT) {
+                    operation->result.stat.error = cqe.res < 0 ? -cqe.res : 0;
+                    if(cqe.res == 0) statxToResult(operation->stx,operation->result.stat);
+                }
+                complete_(operation);
+            }
+            __atomic_store_n(ring->cq_head,head,__ATOMIC_RELEASE);
+            if(is_stop) return;
+        }
+#endif
+    }
+
+} // hzd
@@ -0,0 +1,143 @@
+/**
+  ******************************************************************************
+  * @file           : AsyncFile.h
+  * @author         : huzhida
+  * @brief          : 异步文件IO服务
+  * @date           : 2026/10/18
+  ******************************************************************************
+  */
+
+#ifndef IO_UTILS_ASYNCFILE_H
+#define IO_UTILS_ASYNCFILE_H
+
+#include "../FileSystem/FileSystem.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace hzd {
+
+    class ThreadPool;
+
+    // 异步IO后端
+    // async IO backend
+    enum class AsyncBackend {
+        // 优先io_uring,不可用时退回线程池 & prefer io_uring,fall back to thread pool
+        AUTO,
+        THREAD_POOL,
+        IO_URING
+    };
+
+    // 异步文件服务配置
+    // async file service options
+    struct AsyncFileOptions {
+        // 线程池后端的并发线程数 & concurrent threads of thread pool backend
+        size_t          threads{4};
+        // 最多同时进行的操作数,超出时立即以-EAGAIN完成 & max operations in flight,excess completes immediately with -EAGAIN
+        size_t          queue_depth{256};
+        AsyncBackend    backend{AsyncBackend::AUTO};
+    };
+
+    // 异步操作结果
+    // async operation result
+    struct AsyncResult {
+        // 成功时为字节数或fd,失败时为-errno & bytes or fd on success,-errno on failure
+        int64_t                 result{0};
+        // Read读到的数据 & data returned by Read
+        std::string             data;
+        // Stat的结果 & result of Stat
+        filesystem::StatResult  stat{};
+    };
+
+    // 完成回调,在完成线程中执行,可移走data & completion callback,runs on completion thread,may move data out
+    using AsyncCallback = std::function<void(AsyncResult&)>;
+
+    // 每个操作同时返回future,回调在future就绪前执行
+    // every operation also returns a future,callback runs before the future is ready
+    class AsyncFileService {
+    public:
+        explicit AsyncFileService(const AsyncFileOptions& options = AsyncFileOptions());
+        AsyncFileService(const AsyncFileService&) = delete;
+        AsyncFileService& operator=(const AsyncFileService&) = delete;
+        /**
+         * 析构函数,等待所有操作完成 & destructor,waits all operations
+         */
+        ~AsyncFileService();
+        /**
+         * 打开文件,result为fd & open file,result is fd
+         * @param path 文件路径 & file path
+         * @param flags open标志 & open flags
+         * @param callback 完成回调 & completion callback
+         * @param mode 创建时的权限 & permission when created
+         */
+        std::future<AsyncResult> Open(const std::string& path,int flags,AsyncCallback callback = nullptr,uint32_t mode = 0644);
+        /**
+         * 从偏移处读取 & read at offset
+         * @param fd 文件描述符 & file descriptor
+         * @param offset 偏移 & offset
+         * @param size 最多读取字节数 & max bytes to read
+         * @param callback 完成回调 & completion callback
+         */
+        std::future<AsyncResult> Read(int fd,uint64_t offset,size_t size,AsyncCallback callback = nullptr);
+        /**
+         * 在偏移处写入,数据由服务持有至完成 & write at offset,data is held by the service until completion
+         * @param fd 文件描述符 & file descriptor
+         * @param offset 偏移 & offset
+         * @param data 数据 & data
+         * @param callback 完成回调 & completion callback
+         */
+        std::future<AsyncResult> Write(int fd,uint64_t offset,std::string data,AsyncCallback callback = nullptr);
+        /**
+         * 同步到磁盘 & sync to disk
+         * @param fd 文件描述符 & file descriptor
+         * @param is_datasync 是否只同步数据 & whether sync data only
+         * @param callback 完成回调 & completion callback
+         */
+        std::future<AsyncResult> Fsync(int fd,bool is_datasync = false,AsyncCallback callback = nullptr);
+        /**
+         * 获取文件信息,不跟随符号链接 & get file info,doesn't follow symlink
+         * @param path 路径 & path
+         * @param callback 完成回调 & completion callback
+         */
+        std::future<AsyncResult> Stat(const std::string& path,AsyncCallback callback = nullptr);
+        /**
+         * 关闭文件 & close file
+         * @param fd 文件描述符 & file descriptor
+         * @param callback 完成回调 & completion callback
+         */
+        std::future<AsyncResult> Close(int fd,AsyncCallback callback = nullptr);
+        /**
+         * 等待所有已提交的操作完成 & wait all submitted operations
+         */
+        void Wait();
+        /**
+         * 实际使用的后端 & backend actually in use
+         */
+        inline AsyncBackend Backend() const { return backend; }
+    private:
+        struct Operation;
+        struct Ring;
+
+        std::future<AsyncResult> submit_(Operation* operation);
+        void execute_(Operation* operation);
+        void complete_(Operation* operation);
+        bool setupRing_();
+        bool submitRing_(Operation* operation);
+        void runRing_();
+
+        AsyncFileOptions                options;
+        AsyncBackend                    backend{AsyncBackend::THREAD_POOL};
+        std::unique_ptr<ThreadPool>     pool;
+        std::unique_ptr<Ring>           ring;
+        std::atomic<size_t>             in_flight{0};
+        std::mutex                      mutex;
+        std::condition_variable         idle_condition;
+    };
+
+} // hzd
+
+#endif //IO_UTILS_ASYNCFILE_H
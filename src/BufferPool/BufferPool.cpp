@@ -0,0 +1,327 @@
+/**
+  ******************************************************************************
+  * @file           : BufferPool.cpp
+  * @author         : huzhida
+  * @brief          : None
+  * @date           : 2026/10/18
+  ******************************************************************************
+  */
+#include <Mole.h>
+#include "BufferPool.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <unordered_map>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace hzd {
+
+    const std::string io_buffer_pool_channel = "io.BufferPool";
+
+    constexpr size_t BufferBlock::header_size;
+    static_assert(sizeof(BufferBlock) <= BufferBlock::header_size,"buffer block header exceeds reserved size");
+
+    namespace {
+        // 存活的池,线程退出时据此判断能否归还缓存块 & live pools,checked on thread exit before returning cached blocks
+        struct LivePools {
+            std::mutex                                  mutex;
+            std::unordered_map<uint64_t,BufferPool*>    pools;
+        };
+
+        LivePools& livePools() {
+            static auto* instance = new LivePools;
+            return *instance;
+        }
+
+        std::atomic<uint64_t> next_pool_id{1};
+
+        void updateHighWater(std::atomic<size_t>& high_water,size_t value) {
+            size_t current = high_water.load(std::memory_order_relaxed);
+            while(value > current && !high_water.compare_exchange_weak(current,value,std::memory_order_relaxed)) {}
+        }
+    }
+
+    struct BufferPool::ThreadCache {
+        std::vector<std::vector<BufferBlock*>> blocks;
+    };
+
+    // 线程本地缓存登记,线程退出时把缓存块还给仍存活的池
+    // thread local cache registry,returns cached blocks to live pools on thread exit
+    struct ThreadCacheRegistry {
+        struct Entry {
+            uint64_t                    id;
+            BufferPool*                 pool;
+            BufferPool::ThreadCache     cache;
+        };
+        std::vector<Entry*> entries;
+
+        ~ThreadCacheRegistry() {
+            auto& live = livePools();
+            std::lock_guard<std::mutex> guard(live.mutex);
+            for(auto entry : entries) {
+                if(live.pools.count(entry->id)) {
+                    for(size_t i = 0; i < entry->cache.blocks.size(); i++) {
+                        entry->pool->drain_(i,entry->cache.blocks[i],0);
+                    }
+                }
+                delete entry;
+            }
+        }
+
+        BufferPool::ThreadCache& Get(BufferPool* pool,uint64_t id,size_t class_count) {
+            for(auto entry : entries) {
+                if(entry->id == id) return entry->cache;
+            }
+            {
+                // 清理已销毁池的条目 & prune entries of destroyed pools
+                auto& live = livePools();
+                std::lock_guard<std::mutex> guard(live.mutex);
+                entries.erase(std::remove_if(entries.begin(),entries.end(),[&](Entry* entry) {
+                    if(live.pools.count(entry->id)) return false;
+                    delete entry;
+                    return true;
+                }),entries.end());
+            }
+            auto entry = new Entry{id,pool,{}};
+            entry->cache.blocks.resize(class_count);
+            entries.push_back(entry);
+            return entry->cache;
+        }
+    };
+
+    Buffer::Buffer(BufferBlock *block_) : block(block_) {}
+
+    Buffer::Buffer(const Buffer &other) : block(other.block) {
+        if(block) block->refs.fetch_add(1,std::memory_order_relaxed);
+    }
+
+    Buffer::Buffer(Buffer &&other) noexcept : block(other.block) {
+        other.block = nullptr;
+    }
+
+    Buffer &Buffer::operator=(const Buffer &other) {
+        if(this == &other) return *this;
+        if(other.block) other.block->refs.fetch_add(1,std::memory_order_relaxed);
+        Reset();
+        block = other.block;
+        return *this;
+    }
+
+    Buffer &Buffer::operator=(Buffer &&other) noexcept {
+        if(this == &other) return *this;
+        Reset();
+        block = other.block;
+        other.block = nullptr;
+        return *this;
+    }
+
+    Buffer::~Buffer() {
+        Reset();
+    }
+
+    void Buffer::Reset() {
+        if(!block) return;
+        if(block->refs.fetch_sub(1,std::memory_order_acq_rel) == 1) {
+            block->pool->Release(block);
+        }
+        block = nullptr;
+    }
+
+    uint32_t Buffer::RefCount() const {
+        return block ? block->refs.load(std::memory_order_acquire) : 0;
+    }
+
+    bool Buffer::Resize(size_t size) {
+        if(!block || size > block->capacity) return false;
+        block->size = size;
+        return true;
+    }
+
+    bool Buffer::Append(const char *data, size_t size) {
+        if(!block || block->size + size > block->capacity) return false;
+        memcpy(block->Data() + block->size,data,size);
+        block->size += size;
+        return true;
+    }
+
+    std::string Buffer::ToString() const {
+        return block ? std::string(block->Data(),block->size) : std::string();
+    }
+
+    BufferPool::BufferPool(const BufferPoolOptions &options_) : options(options_) {
+        std::sort(options.size_classes.begin(),options.size_classes.end());
+        options.size_classes.erase(std::unique(options.size_classes.begin(),options.size_classes.end()),options.size_classes.end());
+        class_count = options.size_classes.size();
+        classes.reset(new SizeClass[class_count]);
+        for(size_t i = 0; i < class_count; i++) {
+            classes[i].block_size = options.size_classes[i];
+            // 块起始按缓存行对齐 & block start aligned to cache line
+            classes[i].stride = (BufferBlock::header_size + options.size_classes[i] + 63) & ~size_t(63);
+        }
+        if(options.thread_cache_size == 0) options.thread_cache_size = 1;
+        id = next_pool_id.fetch_add(1);
+        auto& live = livePools();
+        std::lock_guard<std::mutex> guard(live.mutex);
+        live.pools[id] = this;
+    }
+
+    BufferPool::~BufferPool() {
+        {
+            auto& live = livePools();
+            std::lock_guard<std::mutex> guard(live.mutex);
+            live.pools.erase(id);
+        }
+        for(auto& slab : slabs) {
+#ifdef __linux__
+            munmap(slab.first,slab.second);
+#else
+            ::operator delete(slab.first);
+#endif
+        }
+    }
+
+    BufferPool &BufferPool::Default() {
+        static auto* pool = new BufferPool();
+        return *pool;
+    }
+
+    BufferPool::ThreadCache &BufferPool::threadCache_() {
+        thread_local ThreadCacheRegistry registry;
+        return registry.Get(this,id,class_count);
+    }
+
+    void BufferPool::allocateSlab_(size_t class_index) {
+        auto& size_class = classes[class_index];
+        size_t slab_size = std::max(options.slab_size,size_class.stride);
+        char* slab = nullptr;
+#ifdef __linux__
+        if(options.is_huge_page) {
+            const size_t huge_page_size = 2 * 1024 * 1024;
+            size_t huge_size = (slab_size + huge_page_size - 1) & ~(huge_page_size - 1);
+            void* memory = mmap(nullptr,huge_size,PROT_READ | PROT_WRITE,MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,-1,0);
+            if(memory != MAP_FAILED) {
+                slab = static_cast<char*>(memory);
+                slab_size = huge_size;
+                is_huge_page = true;
+            }
+        }
+        if(!slab) {
+            void* memory = mmap(nullptr,slab_size,PROT_READ | PROT_WRITE,MAP_PRIVATE | MAP_ANONYMOUS,-1,0);
+            if(memory == MAP_FAILED) {
+                MOLE_ERROR(io_buffer_pool_channel,strerror(errno));
+                throw std::bad_alloc();
+            }
+            slab = static_cast<char*>(memory);
+            // 预留的大页池不可用时退回透明大页 & fall back to transparent huge pages when reserved huge pages unavailable
+            if(options.is_huge_page) madvise(slab,slab_size,MADV_HUGEPAGE);
+        }
+#else
+        slab = static_cast<char*>(::operator new(slab_size));
+#endif
+        slabs.emplace_back(slab,slab_size);
+        reserved_bytes += slab_size;
+        size_class.slabs++;
+        size_t count = slab_size / size_class.stride;
+        for(size_t i = 0; i < count; i++) {
+            auto block = new (slab + i * size_class.stride) BufferBlock;
+            block->size_class = static_cast<int32_t>(class_index);
+            block->capacity = size_class.block_size;
+            block->pool = this;
+            block->next = size_class.free_list;
+            size_class.free_list = block;
+        }
+        size_class.blocks += count;
+    }
+
+    void BufferPool::refill_(size_t class_index, std::vector<BufferBlock *> &blocks, size_t count) {
+        std::lock_guard<std::mutex> guard(mutex);
+        auto& size_class = classes[class_index];
+        while(count--) {
+            if(!size_class.free_list) allocateSlab_(class_index);
+            auto block = size_class.free_list;
+            size_class.free_list = block->next;
+            blocks.push_back(block);
+        }
+    }
+
+    void BufferPool::drain_(size_t class_index, std::vector<BufferBlock *> &blocks, size_t keep) {
+        std::lock_guard<std::mutex> guard(mutex);
+        auto& size_class = classes[class_index];
+        while(blocks.size() > keep) {
+            auto block = blocks.back();
+            blocks.pop_back();
+            block->next = size_class.free_list;
+            size_class.free_list = block;
+        }
+    }
+
+    BufferBlock *BufferPool::acquireBlock_(size_t class_index) {
+        auto& cache = threadCache_().blocks[class_index];
+        if(cache.empty()) refill_(class_index,cache,std::max<size_t>(1,options.thread_cache_size / 2));
+        auto block = cache.back();
+        cache.pop_back();
+        auto& size_class = classes[class_index];
+        updateHighWater(size_class.high_water,size_class.in_use.fetch_add(1,std::memory_order_relaxed) + 1);
+        return block;
+    }
+
+    Buffer BufferPool::Acquire(size_t size) {
+        BufferBlock* block = nullptr;
+        for(size_t i = 0; i < class_count; i++) {
+            if(classes[i].block_size >= size) {
+                block = acquireBlock_(i);
+                break;
+            }
+        }
+        if(!block) {
+            // 超出最大级别的请求直接分配 & requests beyond largest class are allocated directly
+            void* memory = malloc(BufferBlock::header_size + size);
+            if(!memory) throw std::bad_alloc();
+            block = new (memory) BufferBlock;
+            block->capacity = size;
+            block->pool = this;
+            updateHighWater(oversize_high_water,oversize_in_use.fetch_add(1,std::memory_order_relaxed) + 1);
+        }
+        block->size = 0;
+        block->next = nullptr;
+        block->refs.store(1,std::memory_order_relaxed);
+        return Buffer(block);
+    }
+
+    void BufferPool::Release(BufferBlock *block) {
+        if(block->size_class < 0) {
+            oversize_in_use.fetch_sub(1,std::memory_order_relaxed);
+            block->~BufferBlock();
+            free(block);
+            return;
+        }
+        auto class_index = static_cast<size_t>(block->size_class);
+        classes[class_index].in_use.fetch_sub(1,std::memory_order_relaxed);
+        auto& cache = threadCache_().blocks[class_index];
+        cache.push_back(block);
+        if(cache.size() > options.thread_cache_size) drain_(class_index,cache,options.thread_cache_size / 2);
+    }
+
+    BufferPoolStats BufferPool::Stats() const {
+        BufferPoolStats stats;
+        std::lock_guard<std::mutex> guard(mutex);
+        for(size_t i = 0; i < class_count; i++) {
+            BufferClassStats class_stats;
+            class_stats.block_size = classes[i].block_size;
+            class_stats.slabs = classes[i].slabs;
+            class_stats.blocks = classes[i].blocks;
+            class_stats.in_use = classes[i].in_use.load(std::memory_order_relaxed);
+            class_stats.high_water = classes[i].high_water.load(std::memory_order_relaxed);
+            stats.classes.push_back(class_stats);
+        }
+        stats.reserved_bytes = reserved_bytes;
+        stats.oversize_in_use = oversize_in_use.load(std::memory_order_relaxed);
+        stats.oversize_high_water = oversize_high_water.load(std::memory_order_relaxed);
+        stats.is_huge_page = is_huge_page;
+        return stats;
+    }
+} // hzd
@@ -0,0 +1,193 @@
+/**
+  ******************************************************************************
+  * @file           : BufferPool.h
+  * @author         : huzhida
+  * @brief          : 固定大小slab分配的IO缓冲区池
+  * @date           : 2026/10/18
+  ******************************************************************************
+  */
+
+#ifndef IO_UTILS_BUFFERPOOL_H
+#define IO_UTILS_BUFFERPOOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace hzd {
+
+    class BufferPool;
+
+    // 缓冲区块头,紧邻数据之前
+    // buffer block header,right before data
+    struct BufferBlock {
+        // 引用计数 & reference count
+        std::atomic<uint32_t>   refs{0};
+        // 尺寸级别下标,超大块为-1 & size class index,-1 for oversize block
+        int32_t                 size_class{-1};
+        // 数据容量 & data capacity
+        size_t                  capacity{0};
+        // 有效数据长度 & valid data length
+        size_t                  size{0};
+        // 所属池 & owner pool
+        BufferPool*             pool{nullptr};
+        // 空闲链表指针 & free list pointer
+        BufferBlock*            next{nullptr};
+
+        inline char* Data() { return reinterpret_cast<char*>(this) + header_size; }
+
+        static constexpr size_t header_size = 64;
+    };
+
+    // 引用计数缓冲区句柄,复制句柄不复制数据
+    // reference counted buffer handle,copying the handle doesn't copy data
+    class Buffer {
+    public:
+        Buffer() = default;
+        explicit Buffer(BufferBlock* block);
+        Buffer(const Buffer& other);
+        Buffer(Buffer&& other) noexcept;
+        Buffer& operator=(const Buffer& other);
+        Buffer& operator=(Buffer&& other) noexcept;
+        ~Buffer();
+
+        inline char* Data() { return block ? block->Data() : nullptr; }
+        inline const char* Data() const { return block ? block->Data() : nullptr; }
+        inline size_t Size() const { return block ? block->size : 0; }
+        inline size_t Capacity() const { return block ? block->capacity : 0; }
+        inline bool Empty() const { return Size() == 0; }
+        inline explicit operator bool() const { return block != nullptr; }
+        /**
+         * 引用计数 & reference count
+         * @return 共享此块的句柄数 & handles sharing this block
+         */
+        uint32_t RefCount() const;
+        /**
+         * 设置有效长度 & set valid length
+         * @return true表示成功,false表示超出容量 & true for success,false for exceed capacity
+         */
+        bool Resize(size_t size);
+        /**
+         * 追加数据 & append data
+         * @return true表示成功,false表示超出容量 & true for success,false for exceed capacity
+         */
+        bool Append(const char* data,size_t size);
+        /**
+         * 复制为字符串 & copy to string
+         */
+        std::string ToString() const;
+        /**
+         * 释放对块的引用 & release reference of block
+         */
+        void Reset();
+    private:
+        BufferBlock* block{nullptr};
+    };
+
+    // 缓冲区池配置
+    // buffer pool options
+    struct BufferPoolOptions {
+        // 尺寸级别,升序 & size classes,ascending
+        std::vector<size_t>     size_classes{2048,4096,16384,65536};
+        // 每个slab字节数 & bytes per slab
+        size_t                  slab_size{2 * 1024 * 1024};
+        // 每线程每级别缓存块数上限 & max cached blocks per thread per class
+        size_t                  thread_cache_size{64};
+        // 是否使用大页 & whether use huge pages
+        bool                    is_huge_page{false};
+    };
+
+    // 单个尺寸级别统计
+    // statistics of one size class
+    struct BufferClassStats {
+        // 块容量 & block capacity
+        size_t                  block_size{0};
+        // slab数量 & slab count
+        size_t                  slabs{0};
+        // 总块数 & total blocks
+        size_t                  blocks{0};
+        // 使用中块数 & blocks in use
+        size_t                  in_use{0};
+        // 使用中块数峰值 & high-water mark of blocks in use
+        size_t                  high_water{0};
+    };
+
+    // 缓冲区池统计
+    // buffer pool statistics
+    struct BufferPoolStats {
+        std::vector<BufferClassStats>   classes;
+        // 向系统申请的总字节数 & total bytes reserved from system
+        size_t                          reserved_bytes{0};
+        // 超大块(直接分配)使用中数量 & oversize (directly allocated) blocks in use
+        size_t                          oversize_in_use{0};
+        // 超大块使用中数量峰值 & high-water mark of oversize blocks in use
+        size_t                          oversize_high_water{0};
+        // 是否实际使用了大页 & whether huge pages are actually used
+        bool                            is_huge_page{false};
+    };
+
+    class BufferPool {
+    public:
+        explicit BufferPool(const BufferPoolOptions& options = BufferPoolOptions());
+        BufferPool(const BufferPool&) = delete;
+        BufferPool& operator=(const BufferPool&) = delete;
+        /**
+         * 析构函数,池必须晚于所有由它分配的Buffer销毁 & destructor,pool must outlive all its buffers
+         */
+        ~BufferPool();
+        /**
+         * 申请缓冲区 & acquire buffer
+         * @param size 最小容量 & min capacity
+         * @return 有效长度为0的缓冲区 & buffer with zero valid length
+         */
+        Buffer Acquire(size_t size);
+        /**
+         * 获取统计信息 & get statistics
+         */
+        BufferPoolStats Stats() const;
+        /**
+         * 默认全局池 & default global pool
+         */
+        static BufferPool& Default();
+        /**
+         * 归还块,仅由Buffer调用 & return block,called by Buffer only
+         */
+        void Release(BufferBlock* block);
+    private:
+        struct SizeClass {
+            size_t                      block_size{0};
+            size_t                      stride{0};
+            BufferBlock*                free_list{nullptr};
+            size_t                      slabs{0};
+            size_t                      blocks{0};
+            std::atomic<size_t>         in_use{0};
+            std::atomic<size_t>         high_water{0};
+        };
+        struct ThreadCache;
+        friend struct ThreadCacheRegistry;
+
+        BufferBlock* acquireBlock_(size_t class_index);
+        void refill_(size_t class_index,std::vector<BufferBlock*>& blocks,size_t count);
+        void drain_(size_t class_index,std::vector<BufferBlock*>& blocks,size_t keep);
+        void allocateSlab_(size_t class_index);
+        ThreadCache& threadCache_();
+
+        BufferPoolOptions               options;
+        uint64_t                        id;
+        std::unique_ptr<SizeClass[]>    classes;
+        size_t                          class_count{0};
+        mutable std::mutex              mutex;
+        std::vector<std::pair<char*,size_t>> slabs;
+        size_t                          reserved_bytes{0};
+        bool                            is_huge_page{false};
+        std::atomic<size_t>             oversize_in_use{0};
+        std::atomic<size_t>             oversize_high_water{0};
+    };
+
+} // hzd
+
+#endif //IO_UTILS_BUFFERPOOL_H
@@ -0,0 +1,279 @@
+/**
+  ******************************************************************************
+  * @file           : Checksum.cpp
+  * @author         : huzhida
+  * @brief          : None
+  * @date           : 2026/10/18
+  ******************************************************************************
+  */
+#if defined(__x86_64__) || defined(_M_X64)
+#define IO_UTILS_CRC32C_SSE42
+#include <nmmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+#include "Checksum.h"
+#include "../MappedFile/MappedFile.h"
+#include "../ThreadPool/ThreadPool.h"
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace hzd {
+
+    // CRC32C(Castagnoli)反射多项式 & reflected CRC32C (Castagnoli) polynomial
+    static const uint32_t crc32c_poly = 0x82F63B78;
+
+    // slicing-by-8查表,无硬件指令时使用 & slicing-by-8 tables,used without hardware instructions
+    struct Crc32cTable {
+        uint32_t table[8][256];
+        Crc32cTable() {
+            for(uint32_t i = 0; i < 256; i++) {
+                uint32_t crc = i;
+                for(int j = 0; j < 8; j++) crc = (crc >> 1) ^ ((crc & 1) ? crc32c_poly : 0);
+                table[0][i] = crc;
+            }
+            for(uint32_t i = 0; i < 256; i++) {
+                for(int k = 1; k < 8; k++) table[k][i] = (table[k - 1][i] >> 8) ^ table[0][table[k - 1][i] & 0xFF];
+            }
+        }
+    };
+
+    static uint32_t crc32cSoftware(uint32_t crc,const unsigned char* data,size_t size) {
+        static const Crc32cTable tables;
+        const auto& t = tables.table;
+        while(size >= 8) {
+            uint64_t word;
+            memcpy(&word,data,8);
+            word ^= crc;
+            crc = t[7][word & 0xFF] ^ t[6][(word >> 8) & 0xFF] ^ t[5][(word >> 16) & 0xFF] ^ t[4][(word >> 24) & 0xFF] ^
+                  t[3][(word >> 32) & 0xFF] ^ t[2][(word >> 40) & 0xFF] ^ t[1][(word >> 48) & 0xFF] ^ t[0][word >> 56];
+            data += 8;
+            size -= 8;
+        }
+        while(size-- > 0) crc = (crc >> 8) ^ t[0][(crc ^ *data++) & 0xFF];
+        return crc;
+    }
+
+#ifdef IO_UTILS_CRC32C_SSE42
+#ifndef _MSC_VER
+    __attribute__((target("sse4.2")))
+#endif
+    static uint32_t crc32cHardware(uint32_t crc,const unsigned char* data,size_t size) {
+        uint64_t crc64 = crc;
+        while(size >= 8) {
+            uint64_t word;
+            memcpy(&word,data,8);
+            crc64 = _mm_crc32_u64(crc64,word);
+            data += 8;
+            size -= 8;
+        }
+        auto crc32 = static_cast<uint32_t>(crc64);
+        while(size-- > 0) crc32 = _mm_crc32_u8(crc32,*data++);
+        return crc32;
+    }
+
+    static bool hasSse42() {
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info,1);
+        return (info[2] & (1 << 20)) != 0;
+#else
+        return __builtin_cpu_supports("sse4.2");
+#endif
+    }
+#endif
+
+    using Crc32cImpl = uint32_t(*)(uint32_t,const unsigned char*,size_t);
+
+    static Crc32cImpl crc32cImpl() {
+#ifdef IO_UTILS_CRC32C_SSE42
+        static const Crc32cImpl impl = hasSse42() ? crc32cHardware : crc32cSoftware;
+#else
+        static const Crc32cImpl impl = crc32cSoftware;
+#endif
+        return impl;
+    }
+
+    uint32_t Crc32c::Compute(const void *data, size_t size, uint32_t crc) {
+        return ~crc32cImpl()(~crc,static_cast<const unsigned char*>(data),size);
+    }
+
+    bool Crc32c::IsHardware() {
+        return crc32cImpl() != crc32cSoftware;
+    }
+
+    static uint32_t gf2MatrixTimes(const uint32_t* matrix,uint32_t vector) {
+        uint32_t sum = 0;
+        for(; vector; vector >>= 1,matrix++) {
+            if(vector & 1) sum ^= *matrix;
+        }
+        return sum;
+    }
+
+    static void gf2MatrixSquare(uint32_t* square,const uint32_t* matrix) {
+        for(int n = 0; n < 32; n++) square[n] = gf2MatrixTimes(matrix,matrix[n]);
+    }
+
+    uint32_t Crc32c::Combine(uint32_t crc1, uint32_t crc2, uint64_t length2) {
+        // 在GF(2)上对crc1补length2个零字节,再与crc2异或 & extend crc1 by length2 zero bytes over GF(2),then xor with crc2
+        if(length2 == 0) return crc1;
+        uint32_t even[32],odd[32];
+        odd[0] = crc32c_poly;
+        for(int n = 1; n < 32; n++) odd[n] = 1u << (n - 1);
+        gf2MatrixSquare(even,odd);
+        gf2MatrixSquare(odd,even);
+        do {
+            gf2MatrixSquare(even,odd);
+            if(length2 & 1) crc1 = gf2MatrixTimes(even,crc1);
+            length2 >>= 1;
+            if(length2 == 0) break;
+            gf2MatrixSquare(odd,even);
+            if(length2 & 1) crc1 = gf2MatrixTimes(odd,crc1);
+            length2 >>= 1;
+        }while(length2);
+        return crc1 ^ crc2;
+    }
+
+    static const uint64_t xxh_prime1 = 11400714785074694791ULL;
+    static const uint64_t xxh_prime2 = 14029467366897019727ULL;
+    static const uint64_t xxh_prime3 = 1609587929392839161ULL;
+    static const uint64_t xxh_prime4 = 9650029242287828579ULL;
+    static const uint64_t xxh_prime5 = 2870177450012600261ULL;
+
+    static inline uint64_t rotl64(uint64_t value,int bits) {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    static inline uint64_t read64(const unsigned char* data) {
+        uint64_t value;
+        memcpy(&value,data,8);
+        return value;
+    }
+
+    static inline uint64_t xxhRound(uint64_t acc,uint64_t input) {
+        acc += input * xxh_prime2;
+        return rotl64(acc,31) * xxh_prime1;
+    }
+
+    static inline uint64_t xxhMerge(uint64_t acc,uint64_t value) {
+        acc ^= xxhRound(0,value);
+        return acc * xxh_prime1 + xxh_prime4;
+    }
+
+    Xxh64::Xxh64(uint64_t seed_) : seed(seed_) {
+        v[0] = seed + xxh_prime1 + xxh_prime2;
+        v[1] = seed + xxh_prime2;
+        v[2] = seed;
+        v[3] = seed - xxh_prime1;
+    }
+
+    void Xxh64::Update(const void *data_, size_t size) {
+        auto data = static_cast<const unsigned char*>(data_);
+        total_size += size;
+        if(buffer_size + size < 32) {
+            if(size > 0) memcpy(buffer + buffer_size,data,size);
+            buffer_size += size;
+            return;
+        }
+        if(buffer_size > 0) {
+            size_t fill = 32 - buffer_size;
+            memcpy(buffer + buffer_size,data,fill);
+            for(int i = 0; i < 4; i++) v[i] = xxhRound(v[i],read64(buffer + i * 8));
+            data += fill;
+            size -= fill;
+            buffer_size = 0;
+        }
+        while(size >= 32) {
+            for(int i = 0; i < 4; i++) v[i] = xxhRound(v[i],read64(data + i * 8));
+            data += 32;
+            size -= 32;
+        }
+        if(size > 0) memcpy(buffer,data,size);
+        buffer_size = size;
+    }
+
+    uint64_t Xxh64::Digest() const {
+        uint64_t hash;
+        if(total_size >= 32) {
+            hash = rotl64(v[0],1) + rotl64(v[1],7) + rotl64(v[2],12) + rotl64(v[3],18);
+            for(int i = 0; i < 4; i++) hash = xxhMerge(hash,v[i]);
+        }else {
+            hash = seed + xxh_prime5;
+        }
+        hash += total_size;
+        const unsigned char* cursor = buffer;
+        const unsigned char* end = buffer + buffer_size;
+        for(; cursor + 8 <= end; cursor += 8) {
+            hash ^= xxhRound(0,read64(cursor));
+            hash = rotl64(hash,27) * xxh_prime1 + xxh_prime4;
+        }
+        if(cursor + 4 <= end) {
+            uint32_t word;
+            memcpy(&word,cursor,4);
+            hash ^= static_cast<uint64_t>(word) * xxh_prime1;
+            hash = rotl64(hash,23) * xxh_prime2 + xxh_prime3;
+            cursor += 4;
+        }
+        for(; cursor < end; cursor++) {
+            hash ^= (*cursor) * xxh_prime5;
+            hash = rotl64(hash,11) * xxh_prime1;
+        }
+        hash ^= hash >> 33;
+        hash *= xxh_prime2;
+        hash ^= hash >> 29;
+        hash *= xxh_prime3;
+        hash ^= hash >> 32;
+        return hash;
+    }
+
+    uint64_t Xxh64::Compute(const void *data, size_t size, uint64_t seed) {
+        Xxh64 state(seed);
+        state.Update(data,size);
+        return state.Digest();
+    }
+
+    uint64_t hash_buffer(const void *data_, size_t size, HashType type, const HashOptions &options) {
+        auto data = static_cast<const char*>(data_);
+        size_t chunk_size = std::max<size_t>(options.chunk_size,1);
+        size_t chunk_count = (size + chunk_size - 1) / chunk_size;
+        if(chunk_count <= 1) {
+            return type == HashType::CRC32C ? Crc32c::Compute(data,size) : Xxh64::Compute(data,size);
+        }
+        // 各分块独立计算,顺序合并,结果与线程数无关 & chunks are hashed independently and merged in order,result is independent of thread count
+        std::vector<uint64_t> values(chunk_count);
+        auto hash_chunk = [&](size_t index) {
+            size_t offset = index * chunk_size;
+            size_t length = std::min(chunk_size,size - offset);
+            values[index] = type == HashType::CRC32C ? Crc32c::Compute(data + offset,length) : Xxh64::Compute(data + offset,length);
+        };
+        size_t threads = options.threads == 0 ? std::thread::hardware_concurrency() : options.threads;
+        threads = std::min(std::max<size_t>(threads,1),chunk_count);
+        if(threads == 1) {
+            for(size_t i = 0; i < chunk_count; i++) hash_chunk(i);
+        }else {
+            ThreadPool pool(threads);
+            for(size_t i = 0; i < chunk_count; i++) pool.Submit([&hash_chunk,i] { hash_chunk(i); });
+            pool.Wait();
+        }
+        if(type == HashType::CRC32C) {
+            auto crc = static_cast<uint32_t>(values[0]);
+            for(size_t i = 1; i < chunk_count; i++) {
+                crc = Crc32c::Combine(crc,static_cast<uint32_t>(values[i]),std::min(chunk_size,size - i * chunk_size));
+            }
+            return crc;
+        }
+        return Xxh64::Compute(values.data(),values.size() * sizeof(uint64_t));
+    }
+
+    bool hash_file(const std::string &path, HashType type, uint64_t &result, const HashOptions &options) {
+        MappedFile file;
+        if(!file.Open(path)) return false;
+        file.Advise(MapAdvice::SEQUENTIAL);
+        result = hash_buffer(file.Data(),file.Size(),type,options);
+        return true;
+    }
+
+} // hzd
@@ -0,0 +1,105 @@
+/**
+  ******************************************************************************
+  * @file           : Checksum.h
+  * @author         : huzhida
+  * @brief          : CRC32C与XXH64内容校验
+  * @date           : 2026/10/18
+  ******************************************************************************
+  */
+
+#ifndef IO_UTILS_CHECKSUM_H
+#define IO_UTILS_CHECKSUM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace hzd {
+
+    // 校验算法
+    // hash algorithm
+    enum class HashType {
+        // 硬件加速(SSE4.2)的CRC32C,分块结果可合并,与分块方式无关 & hardware accelerated (SSE4.2) CRC32C,chunk results combine exactly,independent of chunking
+        CRC32C,
+        // 64位非加密哈希,超过一个分块时为各分块摘要的XXH64 & 64-bit non-cryptographic hash,XXH64 of chunk digests when spanning more than one chunk
+        XXH64
+    };
+
+    // 流式CRC32C
+    // streaming CRC32C
+    class Crc32c {
+    public:
+        inline void Update(const void* data,size_t size) { crc = Compute(data,size,crc); }
+        inline uint32_t Value() const { return crc; }
+        inline void Reset() { crc = 0; }
+        /**
+         * 计算CRC32C,可在前一段结果上继续 & compute CRC32C,may continue from a previous result
+         * @param data 数据 & data
+         * @param size 数据大小 & data size
+         * @param crc 前一段的结果 & result of the previous part
+         */
+        static uint32_t Compute(const void* data,size_t size,uint32_t crc = 0);
+        /**
+         * 合并相邻两段的CRC & combine CRCs of two adjacent parts
+         * @param crc1 前一段的CRC & CRC of first part
+         * @param crc2 后一段的CRC & CRC of second part
+         * @param length2 后一段的长度 & length of second part
+         * @return 整体的CRC & CRC of the whole
+         */
+        static uint32_t Combine(uint32_t crc1,uint32_t crc2,uint64_t length2);
+        /**
+         * 是否使用硬件指令 & whether hardware instructions are used
+         */
+        static bool IsHardware();
+    private:
+        uint32_t        crc{0};
+    };
+
+    // 流式XXH64
+    // streaming XXH64
+    class Xxh64 {
+    public:
+        explicit Xxh64(uint64_t seed = 0);
+        void Update(const void* data,size_t size);
+        uint64_t Digest() const;
+        static uint64_t Compute(const void* data,size_t size,uint64_t seed = 0);
+    private:
+        uint64_t        v[4];
+        uint64_t        seed;
+        uint64_t        total_size{0};
+        unsigned char   buffer[32];
+        size_t          buffer_size{0};
+    };
+
+    // 分块并行校验配置
+    // chunked parallel hashing options
+    struct HashOptions {
+        // 并行线程数,0表示硬件并发数 & threads,0 for hardware concurrency
+        size_t          threads{0};
+        // 分块大小,XXH64的结果依赖此值 & chunk size,XXH64 result depends on it
+        size_t          chunk_size{4 * 1024 * 1024};
+    };
+
+    /**
+     * 分块并行计算内存块的校验值 & hash memory block in parallel chunks
+     * @param data 数据 & data
+     * @param size 数据大小 & data size
+     * @param type 校验算法 & hash algorithm
+     * @param options 配置 & options
+     * @return 校验值,CRC32C在低32位 & hash value,CRC32C in low 32 bits
+     */
+    uint64_t hash_buffer(const void* data,size_t size,HashType type,const HashOptions& options = HashOptions());
+
+    /**
+     * 经mmap分块并行计算文件的校验值 & hash file via mmap in parallel chunks
+     * @param path 文件路径 & file path
+     * @param type 校验算法 & hash algorithm
+     * @param result 校验值 & hash value
+     * @param options 配置 & options
+     * @return true表示成功,false表示失败 & true for success,false for failed
+     */
+    bool hash_file(const std::string& path,HashType type,uint64_t& result,const HashOptions& options = HashOptions());
+
+} // hzd
+
+#endif //IO_UTILS_CHECKSUM_H
@@ -0,0 +1,537 @@
+/**
+  ******************************************************************************
+  * @file           : DeltaSync.cpp
+  * @author         : huzhida
+  * @brief          : None
+  * @date           : 2026/10/18
+  ******************************************************************************
+  */
+#include <Mole.h>
+#include "DeltaSync.h"
+#include "../Checksum/Checksum.h"
+#include "../FileSystem/FileSystem.h"
+#include "../FileWriter/FileWriter.h"
+#include "../MappedFile/MappedFile.h"
+#include "../Socket/Socket.h"
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+namespace hzd {
+
+    namespace delta {
+
+        const std::string io_delta_sync_channel = "io.DeltaSync";
+
+        static const uint32_t signature_magic = 0x44534947;
+        static const uint32_t delta_magic = 0x44444C54;
+        // 反序列化时的上限,防止恶意长度 & limits when decoding,guards against bogus lengths
+        static const uint64_t max_blocks = 1ULL << 28;
+        // 编码长度: 签名头部,每块,增量头部,每个操作(不含新数据) & encoded sizes: signature header,per block,delta header,per op (literal excluded)
+        static const size_t signature_head_size = 4 + 4 + 8 + 8;
+        static const size_t block_encoded_size = 4 + 8;
+        static const size_t delta_head_size = 4 + 4 + 8 + 8 + 8;
+        static const size_t op_head_size = 1 + 8 + 8;
+
+        static size_t encodedSize(const DeltaOp& op) {
+            return op_head_size + op.data.size();
+        }
+
+        // rsync弱校验:a为字节和,b为加权和,各取低16位 & rsync weak checksum: a is byte sum,b is weighted sum,16 bits each
+        struct Rolling {
+            uint32_t a{0};
+            uint32_t b{0};
+            uint32_t length{0};
+
+            void Reset(const unsigned char* data,uint32_t size) {
+                a = b = 0;
+                length = size;
+                for(uint32_t i = 0; i < size; i++) {
+                    a += data[i];
+                    b += (size - i) * data[i];
+                }
+            }
+            // 窗口右移一个字节 & slide window by one byte
+            void Roll(unsigned char out,unsigned char in) {
+                a += in - out;
+                b += a - length * out;
+            }
+            uint32_t Value() const { return (a & 0xffff) | (b << 16); }
+        };
+
+        uint64_t Delta::LiteralBytes() const {
+            uint64_t bytes = 0;
+            for(const auto& op : ops) bytes += op.data.size();
+            return bytes;
+        }
+
+        static uint32_t chooseBlockSize(uint64_t file_size) {
+            // 约为文件大小的平方根,兼顾签名大小与匹配粒度 & about sqrt of file size,balancing signature size and match granularity
+            auto size = static_cast<uint64_t>(std::sqrt(static_cast<double>(file_size)));
+            size = (size + 7) & ~7ULL;
+            return static_cast<uint32_t>(std::min<uint64_t>(std::max<uint64_t>(size,1024),128 * 1024));
+        }
+
+        bool signature(const std::string& basis_path,Signature& signature,uint32_t block_size) {
+            signature = Signature();
+            MappedFile file;
+            if(!filesystem::exists(basis_path)) {
+                signature.block_size = block_size ? block_size : chooseBlockSize(0);
+                return true;
+            }
+            if(!file.Open(basis_path)) return false;
+            file.Advise(MapAdvice::SEQUENTIAL);
+            signature.block_size = block_size ? block_size : chooseBlockSize(file.Size());
+            signature.file_size = file.Size();
+            auto data = reinterpret_cast<const unsigned char*>(file.Data());
+            for(uint64_t offset = 0; offset < file.Size(); offset += signature.block_size) {
+                auto length = static_cast<uint32_t>(std::min<uint64_t>(signature.block_size,file.Size() - offset));
+                Rolling rolling;
+                rolling.Reset(data + offset,length);
+                signature.blocks.push_back(BlockSignature{rolling.Value(),Xxh64::Compute(data + offset,length)});
+            }
+            return true;
+        }
+
+        // 合并相邻COPY,拆分过长DATA后交给回调 & merges adjacent COPYs and splits long DATA before handing ops to the sink
+        struct OpEmitter {
+            const DeltaSink&    sink;
+            size_t              max_literal;
+            DeltaOp             pending{DeltaOp::COPY,0,0,std::string()};
+            DeltaOp             literal{DeltaOp::DATA,0,0,std::string()};
+
+            OpEmitter(const DeltaSink& sink_,size_t max_literal_) : sink(sink_),max_literal(std::max<size_t>(max_literal_,1)) {}
+
+            bool Copy(uint64_t block_index) {
+                if(pending.block_count > 0 && pending.block_index + pending.block_count == block_index) {
+                    pending.block_count++;
+                    return true;
+                }
+                if(!Flush()) return false;
+                pending.block_index = block_index;
+                pending.block_count = 1;
+                return true;
+            }
+            bool Data(const unsigned char* begin,const unsigned char* end) {
+                if(begin == end) return true;
+                if(!Flush()) return false;
+                // 新数据直接取自映射,每次只拷贝一段 & literal comes straight from the mapping,one chunk copied at a time
+                while(begin < end) {
+                    size_t size = std::min<size_t>(end - begin,max_literal);
+                    literal.data.assign(reinterpret_cast<const char*>(begin),size);
+                    if(!sink(literal)) return false;
+                    begin += size;
+                }
+                return true;
+            }
+            bool Flush() {
+                if(pending.block_count == 0) return true;
+                bool ret = sink(pending);
+                pending.block_count = 0;
+                return ret;
+            }
+        };
+
+        bool generate(const std::string& new_path,const Signature& signature,Delta& delta) {
+            delta = Delta();
+            return generate(new_path,signature,delta,[&delta](const DeltaOp& op) {
+                delta.ops.push_back(op);
+                return true;
+            },SIZE_MAX);
+        }
+
+        bool generate(const std::string& new_path,const Signature& signature,DeltaHeader& header,const DeltaSink& sink,size_t max_literal) {
+            header.block_size = signature.block_size;
+            header.file_size = 0;
+            header.file_hash = 0;
+            if(signature.block_size == 0) {
+                MOLE_ERROR(io_delta_sync_channel,"invalid signature");
+                return false;
+            }
+            MappedFile file;
+            if(!file.Open(new_path)) return false;
+            file.Advise(MapAdvice::SEQUENTIAL);
+            header.file_size = file.Size();
+            header.file_hash = Xxh64::Compute(file.Data(),file.Size());
+            const uint32_t block_size = signature.block_size;
+            // 只有完整块参与滚动匹配,不足一块的尾块只在文件末尾比较 & only full blocks take part in rolling match,short tail block is compared at file end only
+            size_t full_blocks = signature.blocks.size();
+            bool has_tail = signature.file_size % block_size != 0 && full_blocks > 0;
+            if(has_tail) full_blocks--;
+            std::unordered_map<uint32_t,std::vector<uint64_t>> index;
+            index.reserve(full_blocks);
+            for(uint64_t i = 0; i < full_blocks; i++) index[signature.blocks[i].weak].push_back(i);
+
+            OpEmitter emitter(sink,max_literal);
+            auto data = reinterpret_cast<const unsigned char*>(file.Data());
+            const uint64_t size = file.Size();
+            uint64_t literal_start = 0;
+            uint64_t cursor = 0;
+            Rolling rolling;
+            bool is_fresh = true;
+            while(cursor + block_size <= size && !index.empty()) {
+                if(is_fresh) {
+                    rolling.Reset(data + cursor,block_size);
+                    is_fresh = false;
+                }
+                auto it = index.find(rolling.Value());
+                if(it != index.end()) {
+                    uint64_t strong = Xxh64::Compute(data + cursor,block_size);
+                    auto match = std::find_if(it->second.begin(),it->second.end(),[&](uint64_t block) { return signature.blocks[block].strong == strong; });
+                    if(match != it->second.end()) {
+                        if(!emitter.Data(data + literal_start,data + cursor) || !emitter.Copy(*match)) return false;
+                        cursor += block_size;
+                        literal_start = cursor;
+                        is_fresh = true;
+                        continue;
+                    }
+                }
+                if(cursor + block_size < size) rolling.Roll(data[cursor],data[cursor + block_size]);
+                cursor++;
+            }
+            if(has_tail) {
+                const auto& tail = signature.blocks.back();
+                uint64_t tail_size = signature.file_size % block_size;
+                if(size - literal_start >= tail_size && Xxh64::Compute(data + size - tail_size,tail_size) == tail.strong) {
+                    if(!emitter.Data(data + literal_start,data + size - tail_size) || !emitter.Copy(signature.blocks.size() - 1)) return false;
+                    literal_start = size;
+                }
+            }
+            return emitter.Data(data + literal_start,data + size) && emitter.Flush();
+        }
+
+        Applier::~Applier() {
+            abort_();
+        }
+
+        void Applier::abort_() {
+            if(!is_open) return;
+            writer.Close();
+            basis.Close();
+            remove(temp.c_str());
+            is_open = false;
+        }
+
+        bool Applier::Open(const std::string& basis_path,const DeltaHeader& header_,const std::string& out_path_) {
+            abort_();
+            if(header_.block_size == 0) {
+                MOLE_ERROR(io_delta_sync_channel,"invalid delta header");
+                return false;
+            }
+            header = header_;
+            out_path = out_path_;
+            hash = Xxh64();
+            if(filesystem::exists(basis_path) && !basis.Open(basis_path)) return false;
+            temp = filesystem::temp_path(out_path);
+            FileWriterOptions options;
+            options.buffer_size = std::min<size_t>(options.buffer_size,std::max<uint64_t>(header.file_size,1));
+            options.preallocate = header.file_size;
+            if(!writer.Open(temp,options)) {
+                basis.Close();
+                return false;
+            }
+            is_open = true;
+            return true;
+        }
+
+        bool Applier::Apply(const DeltaOp& op) {
+            if(!is_open) {
+                MOLE_ERROR(io_delta_sync_channel,"applier not opened");
+                return false;
+            }
+            const char* data;
+            uint64_t size;
+            if(op.type == DeltaOp::DATA) {
+                data = op.data.data();
+                size = op.data.size();
+            }else {
+                uint64_t offset = op.block_index * header.block_size;
+                if(op.block_count == 0 || op.block_index >= basis.Size() || offset >= basis.Size()) {
+                    MOLE_ERROR(io_delta_sync_channel,"copy out of basis range",{ MOLE_VAR(op.block_index) });
+                    abort_();
+                    return false;
+                }
+                auto view = basis.View(offset,op.block_count * header.block_size);
+                data = view.data;
+                size = view.size;
+            }
+            // 对端给出的操作不可信,不写超出头部声明的大小 & ops from a peer are untrusted,never write past the size in the header
+            if(size > header.file_size - writer.Size()) {
+                MOLE_ERROR(io_delta_sync_channel,"delta exceeds file size",{ MOLE_VAR(out_path) });
+                abort_();
+                return false;
+            }
+            hash.Update(data,size);
+            if(!writer.Write(data,size)) {
+                abort_();
+                return false;
+            }
+            return true;
+        }
+
+        bool Applier::Finish() {
+            if(!is_open) {
+                MOLE_ERROR(io_delta_sync_channel,"applier not opened");
+                return false;
+            }
+            bool ret = writer.Close();
+            if(ret && (writer.Size() != header.file_size || hash.Digest() != header.file_hash)) {
+                MOLE_ERROR(io_delta_sync_channel,"content mismatch after apply",{ MOLE_VAR(out_path) });
+                ret = false;
+            }
+            // 映射需在替换前释放 & mapping must be released before replacing
+            basis.Close();
+            if(ret && !filesystem::move(temp,out_path,true)) ret = false;
+            if(!ret) remove(temp.c_str());
+            is_open = false;
+            return ret;
+        }
+
+        bool apply(const std::string& basis_path,const Delta& delta,const std::string& out_path) {
+            Applier applier;
+            if(!applier.Open(basis_path,delta,out_path)) return false;
+            for(const auto& op : delta.ops) {
+                if(!applier.Apply(op)) return false;
+            }
+            return applier.Finish();
+        }
+
+        bool sync(const std::string& src_path,const std::string& dest_path,uint64_t* literal_bytes) {
+            Signature basis_signature;
+            if(!signature(dest_path,basis_signature)) return false;
+            // 边生成边应用,不保存完整增量 & apply while generating,the whole delta is never held
+            Applier applier;
+            DeltaHeader header;
+            uint64_t literal = 0;
+            bool is_open = false;
+            bool ret = generate(src_path,basis_signature,header,[&](const DeltaOp& op) {
+                if(!is_open && !(is_open = applier.Open(dest_path,header,dest_path))) return false;
+                literal += op.data.size();
+                return applier.Apply(op);
+            });
+            if(!ret || (!is_open && !applier.Open(dest_path,header,dest_path))) return false;
+            if(literal_bytes) *literal_bytes = literal;
+            return applier.Finish();
+        }
+
+        static void putU32(std::string& out,uint32_t value) {
+            for(int i = 3; i >= 0; i--) out.push_back(static_cast<char>((value >> (i * 8)) & 0xff));
+        }
+
+        static void putU64(std::string& out,uint64_t value) {
+            for(int i = 7; i >= 0; i--) out.push_back(static_cast<char>((value >> (i * 8)) & 0xff));
+        }
+
+        // 顺序读取,越界时置失败 & sequential reader,marks failure on overrun
+        struct Reader {
+            const std::string& in;
+            size_t cursor{0};
+            bool is_ok{true};
+
+            explicit Reader(const std::string& in_) : in(in_) {}
+            uint64_t Get(int bytes) {
+                if(!is_ok || in.size() - cursor < static_cast<size_t>(bytes)) {
+                    is_ok = false;
+                    return 0;
+                }
+                uint64_t value = 0;
+                for(int i = 0; i < bytes; i++) value = (value << 8) | static_cast<unsigned char>(in[cursor++]);
+                return value;
+            }
+        };
+
+        void encode(const Signature& signature,std::string& out) {
+            out.clear();
+            out.reserve(signature_head_size + signature.blocks.size() * block_encoded_size);
+            putU32(out,signature_magic);
+            putU32(out,signature.block_size);
+            putU64(out,signature.file_size);
+            putU64(out,signature.blocks.size());
+            for(const auto& block : signature.blocks) {
+                putU32(out,block.weak);
+                putU64(out,block.strong);
+            }
+        }
+
+        bool decode(const std::string& in,Signature& signature) {
+            Reader reader(in);
+            signature = Signature();
+            if(reader.Get(4) != signature_magic) {
+                MOLE_ERROR(io_delta_sync_channel,"invalid signature header");
+                return false;
+            }
+            signature.block_size = static_cast<uint32_t>(reader.Get(4));
+            signature.file_size = reader.Get(8);
+            uint64_t count = reader.Get(8);
+            if(!reader.is_ok || count > max_blocks || count * block_encoded_size > in.size() - reader.cursor) {
+                MOLE_ERROR(io_delta_sync_channel,"invalid signature",{ MOLE_VAR(count) });
+                return false;
+            }
+            signature.blocks.resize(count);
+            for(auto& block : signature.blocks) {
+                block.weak = static_cast<uint32_t>(reader.Get(4));
+                block.strong = reader.Get(8);
+            }
+            return reader.is_ok;
+        }
+
+        void encode(const Delta& delta,std::string& out) {
+            out.clear();
+            out.reserve(delta_head_size + delta.LiteralBytes() + delta.ops.size() * op_head_size);
+            putU32(out,delta_magic);
+            putU32(out,delta.block_size);
+            putU64(out,delta.file_size);
+            putU64(out,delta.file_hash);
+            putU64(out,delta.ops.size());
+            for(const auto& op : delta.ops) {
+                out.push_back(static_cast<char>(op.type));
+                if(op.type == DeltaOp::COPY) {
+                    putU64(out,op.block_index);
+                    putU64(out,op.block_count);
+                }else {
+                    putU64(out,op.data.size());
+                    out.append(op.data);
+                }
+            }
+        }
+
+        bool decode(const std::string& in,Delta& delta) {
+            Reader reader(in);
+            delta = Delta();
+            if(reader.Get(4) != delta_magic) {
+                MOLE_ERROR(io_delta_sync_channel,"invalid delta header");
+                return false;
+            }
+            delta.block_size = static_cast<uint32_t>(reader.Get(4));
+            delta.file_size = reader.Get(8);
+            delta.file_hash = reader.Get(8);
+            uint64_t count = reader.Get(8);
+            // 每个操作至少9字节(DATA的类型加长度) & every op takes at least 9 bytes (type plus length of DATA)
+            if(!reader.is_ok || count > (in.size() - reader.cursor) / 9) {
+                MOLE_ERROR(io_delta_sync_channel,"invalid delta",{ MOLE_VAR(count) });
+                return false;
+            }
+            delta.ops.resize(count);
+            for(auto& op : delta.ops) {
+                op.type = static_cast<DeltaOp::Type>(reader.Get(1));
+                if(op.type == DeltaOp::COPY) {
+                    op.block_index = reader.Get(8);
+                    op.block_count = reader.Get(8);
+                }else if(op.type == DeltaOp::DATA) {
+                    uint64_t length = reader.Get(8);
+                    if(!reader.is_ok || length > in.size() - reader.cursor) {
+                        reader.is_ok = false;
+                        break;
+                    }
+                    op.data.assign(in,reader.cursor,length);
+                    reader.cursor += length;
+                }else {
+                    reader.is_ok = false;
+                }
+                if(!reader.is_ok) break;
+            }
+            if(!reader.is_ok) MOLE_ERROR(io_delta_sync_channel,"truncated delta");
+            return reader.is_ok;
+        }
+
+        // 发送带长度前缀的帧 & send length-prefixed frame
+        static bool sendFrame(TcpSocket& socket,const std::string& frame) {
+            std::string head;
+            putU64(head,frame.size());
+            return socket.SendAll(head.data(),head.size()) && socket.SendAll(frame.data(),frame.size());
+        }
+
+        // 接收带长度前缀的帧,超过上限的长度不做分配 & recv length-prefixed frame,lengths over the limit are not allocated
+        static bool recvFrame(TcpSocket& socket,std::string& frame) {
+            frame.resize(8);
+            if(!socket.RecvAll(&frame[0],frame.size())) return false;
+            Reader reader(frame);
+            uint64_t size = reader.Get(8);
+            if(size > max_frame) {
+                MOLE_ERROR(io_delta_sync_channel,"frame too large",{ MOLE_VAR(size) });
+                return false;
+            }
+            frame.resize(size);
+            return size == 0 || socket.RecvAll(&frame[0],size);
+        }
+
+        bool send(TcpSocket& socket,const std::string& file_path) {
+            // 1. 逐帧接收签名,块数由文件大小与块大小决定 & recv signature frame by frame,block count follows from file size and block size
+            std::string frame;
+            Signature basis_signature,part;
+            if(!recvFrame(socket,frame) || !decode(frame,basis_signature)) return false;
+            uint64_t block_size = basis_signature.block_size;
+            uint64_t expect_blocks = block_size == 0 ? 0 : basis_signature.file_size / block_size + (basis_signature.file_size % block_size != 0);
+            if(basis_signature.blocks.size() > expect_blocks) {
+                MOLE_ERROR(io_delta_sync_channel,"invalid signature frame");
+                return false;
+            }
+            while(basis_signature.blocks.size() < expect_blocks) {
+                if(!recvFrame(socket,frame) || !decode(frame,part)) return false;
+                if(part.block_size != basis_signature.block_size || part.file_size != basis_signature.file_size || part.blocks.empty() || part.blocks.size() > expect_blocks - basis_signature.blocks.size()) {
+                    MOLE_ERROR(io_delta_sync_channel,"invalid signature frame");
+                    return false;
+                }
+                basis_signature.blocks.insert(basis_signature.blocks.end(),part.blocks.begin(),part.blocks.end());
+            }
+            // 2. 边生成边发送,每帧攒满后发出,内存中最多一帧增量 & send while generating,a frame goes out once full,at most one frame of delta in memory
+            Delta batch;
+            size_t batch_size = delta_head_size;
+            bool is_sent = false;
+            auto flush = [&]() {
+                encode(batch,frame);
+                batch.ops.clear();
+                batch_size = delta_head_size;
+                is_sent = true;
+                return sendFrame(socket,frame);
+            };
+            bool ret = generate(file_path,basis_signature,batch,[&](const DeltaOp& op) {
+                size_t op_size = encodedSize(op);
+                if(!batch.ops.empty() && batch_size + op_size > max_frame && !flush()) return false;
+                batch.ops.push_back(op);
+                batch_size += op_size;
+                return true;
+            },max_frame - delta_head_size - op_head_size);
+            if(!ret) return false;
+            // 至少发出一帧以携带头部 & send at least one frame to carry the header
+            return (batch.ops.empty() && is_sent) || flush();
+        }
+
+        bool recv(TcpSocket& socket,const std::string& file_path) {
+            // 1. 签名按帧上限切分发送 & send signature split by the frame limit
+            std::string frame;
+            Signature basis_signature,part;
+            if(!signature(file_path,basis_signature)) return false;
+            part.block_size = basis_signature.block_size;
+            part.file_size = basis_signature.file_size;
+            const size_t frame_blocks = (max_frame - signature_head_size) / block_encoded_size;
+            size_t cursor = 0;
+            do {
+                size_t count = std::min(frame_blocks,basis_signature.blocks.size() - cursor);
+                part.blocks.assign(basis_signature.blocks.begin() + cursor,basis_signature.blocks.begin() + cursor + count);
+                encode(part,frame);
+                if(!sendFrame(socket,frame)) return false;
+                cursor += count;
+            }while(cursor < basis_signature.blocks.size());
+            // 2. 逐帧应用增量,直到写满头部声明的大小 & apply delta frame by frame until the size in the header is written
+            Delta batch;
+            if(!recvFrame(socket,frame) || !decode(frame,batch)) return false;
+            DeltaHeader header = batch;
+            Applier applier;
+            if(!applier.Open(file_path,header,file_path)) return false;
+            while(true) {
+                for(const auto& op : batch.ops) {
+                    if(!applier.Apply(op)) return false;
+                }
+                if(applier.Written() >= header.file_size) break;
+                if(!recvFrame(socket,frame) || !decode(frame,batch)) return false;
+                if(batch.block_size != header.block_size || batch.file_size != header.file_size || batch.file_hash != header.file_hash || batch.ops.empty()) {
+                    MOLE_ERROR(io_delta_sync_channel,"invalid delta frame");
+                    return false;
+                }
+            }
+            return applier.Finish();
+        }
+    }
+
+} // hzd
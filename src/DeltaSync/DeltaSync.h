@@ -0,0 +1,208 @@
+/**
+  ******************************************************************************
+  * @file           : DeltaSync.h
+  * @author         : huzhida
+  * @brief          : rsync式滚动校验增量同步
+  * @date           : 2026/10/18
+  ******************************************************************************
+  */
+
+#ifndef IO_UTILS_DELTASYNC_H
+#define IO_UTILS_DELTASYNC_H
+
+#include "../Checksum/Checksum.h"
+#include "../FileWriter/FileWriter.h"
+#include "../MappedFile/MappedFile.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace hzd {
+
+    class TcpSocket;
+
+    namespace delta {
+
+        // 块签名
+        // block signature
+        struct BlockSignature {
+            // 滚动弱校验 & rolling weak checksum
+            uint32_t        weak;
+            // XXH64强校验 & XXH64 strong hash
+            uint64_t        strong;
+        };
+
+        // 基准文件签名,由持有旧文件的一方生成
+        // basis file signature,produced by the side holding the old file
+        struct Signature {
+            uint32_t                        block_size{0};
+            uint64_t                        file_size{0};
+            // 最后一块可能不足block_size & last block may be shorter than block_size
+            std::vector<BlockSignature>     blocks;
+        };
+
+        // 增量操作
+        // delta operation
+        struct DeltaOp {
+            enum Type : uint8_t {
+                // 复制基准文件中连续的块 & copy consecutive blocks from basis
+                COPY,
+                // 新数据 & literal data
+                DATA
+            };
+            Type            type;
+            uint64_t        block_index;
+            uint64_t        block_count;
+            std::string     data;
+        };
+
+        // 增量头部,流式生成与应用时先于全部操作确定
+        // delta header,known before any op when generating or applying as a stream
+        struct DeltaHeader {
+            uint32_t                block_size{0};
+            // 新文件大小 & new file size
+            uint64_t                file_size{0};
+            // 新文件的XXH64,应用后校验 & XXH64 of new file,verified after apply
+            uint64_t                file_hash{0};
+        };
+
+        // 由签名与新文件生成的增量
+        // delta produced from signature and new file
+        struct Delta : DeltaHeader {
+            std::vector<DeltaOp>    ops;
+
+            /**
+             * 需传输的新数据字节数 & literal bytes to transfer
+             */
+            uint64_t LiteralBytes() const;
+        };
+
+        /**
+         * 计算基准文件签名,文件不存在时为空签名 & compute basis signature,empty signature when file doesn't exist
+         * @param basis_path 基准文件 & basis file
+         * @param signature 签名 & signature
+         * @param block_size 块大小,0表示按文件大小自动选择 & block size,0 for choosing by file size
+         * @return true表示成功,false表示失败 & true for success,false for failed
+         */
+        bool signature(const std::string& basis_path,Signature& signature,uint32_t block_size = 0);
+
+        /**
+         * 根据签名生成新文件的增量 & generate delta of new file against signature
+         * @param new_path 新文件 & new file
+         * @param signature 基准签名 & basis signature
+         * @param delta 增量 & delta
+         * @return true表示成功,false表示失败 & true for success,false for failed
+         */
+        bool generate(const std::string& new_path,const Signature& signature,Delta& delta);
+
+        // 增量操作回调,op仅在回调期间有效,返回false中止 & delta op callback,op is valid only during the call,return false to abort
+        using DeltaSink = std::function<bool(const DeltaOp& op)>;
+
+        /**
+         * 流式生成增量,不在内存中保存完整增量 & generate delta as a stream,without holding the whole delta in memory
+         * @brief 首次回调前header已填好,相邻COPY合并后输出 & header is filled before the first callback,adjacent COPYs are merged before output
+         * @param new_path 新文件 & new file
+         * @param signature 基准签名 & basis signature
+         * @param header 增量头部 & delta header
+         * @param sink 操作回调 & op callback
+         * @param max_literal 单个DATA操作的字节上限,更长的新数据被拆分 & max bytes of one DATA op,longer literal runs are split
+         * @return true表示成功,false表示失败或回调中止 & true for success,false for failed or aborted by callback
+         */
+        bool generate(const std::string& new_path,const Signature& signature,DeltaHeader& header,const DeltaSink& sink,size_t max_literal = 1024 * 1024);
+
+        /**
+         * 将增量应用到基准文件,写临时文件后rename,可原地更新 & apply delta to basis,writes temp file then renames,may update in place
+         * @param basis_path 基准文件 & basis file
+         * @param delta 增量 & delta
+         * @param out_path 输出文件,可与basis_path相同 & output file,may equal basis_path
+         * @return true表示成功,false表示失败(包括校验不符) & true for success,false for failed (including hash mismatch)
+         */
+        bool apply(const std::string& basis_path,const Delta& delta,const std::string& out_path);
+
+        // 逐个操作应用增量,配合流式生成与分帧传输,内存占用与增量大小无关
+        // applies delta op by op,pairs with streaming generate and framed transfer,memory use is independent of delta size
+        class Applier {
+        public:
+            Applier() = default;
+            Applier(const Applier&) = delete;
+            Applier& operator=(const Applier&) = delete;
+            /**
+             * 析构函数,未Finish时删除临时文件 & destructor,removes temp file when not finished
+             */
+            ~Applier();
+            /**
+             * 开始应用,写临时文件 & start applying,writing a temp file
+             * @param basis_path 基准文件 & basis file
+             * @param header 增量头部 & delta header
+             * @param out_path 输出文件,可与basis_path相同 & output file,may equal basis_path
+             * @return true表示成功,false表示失败 & true for success,false for failed
+             */
+            bool Open(const std::string& basis_path,const DeltaHeader& header,const std::string& out_path);
+            /**
+             * 应用一个操作 & apply one op
+             * @param op 增量操作 & delta op
+             * @return true表示成功,false表示失败(包括越界或超出文件大小) & true for success,false for failed (including out of range or beyond file size)
+             */
+            bool Apply(const DeltaOp& op);
+            /**
+             * 校验大小与哈希后rename到输出文件 & verify size and hash,then rename to output file
+             * @return true表示成功,false表示失败(包括校验不符) & true for success,false for failed (including hash mismatch)
+             */
+            bool Finish();
+            /**
+             * 已写入的字节数 & bytes written
+             */
+            inline uint64_t Written() const { return writer.Size(); }
+        private:
+            void abort_();
+
+            DeltaHeader     header;
+            std::string     out_path;
+            std::string     temp;
+            MappedFile      basis;
+            FileWriter      writer;
+            Xxh64           hash;
+            bool            is_open{false};
+        };
+
+        /**
+         * 本地增量同步,使dest与src内容一致 & local delta sync,makes dest match src
+         * @param src_path 源文件 & source file
+         * @param dest_path 目标文件 & destination file
+         * @param literal_bytes 实际需传输的字节数,可为空 & bytes that had to be transferred,can be null
+         * @return true表示成功,false表示失败 & true for success,false for failed
+         */
+        bool sync(const std::string& src_path,const std::string& dest_path,uint64_t* literal_bytes = nullptr);
+
+        // 序列化,整数为大端 & serialization,integers are big-endian
+        void encode(const Signature& signature,std::string& out);
+        bool decode(const std::string& in,Signature& signature);
+        void encode(const Delta& delta,std::string& out);
+        bool decode(const std::string& in,Delta& delta);
+
+        // 网络传输每帧的长度上限,签名与增量均分帧传输,超出即视为非法 & max length of a network frame,signature and delta are both sent in frames,anything larger is rejected
+        const size_t max_frame = 4 * 1024 * 1024;
+
+        /**
+         * 增量发送文件:接收对端的块签名,只发送变化部分 & delta send file: receive peer's block signature,send only changed parts
+         * @brief 阻塞直到发送完成,对端需使用recv接收,增量边生成边按帧发送 & blocks until done,peer must receive with recv,delta is sent in frames while generated
+         * @param socket 已连接的socket & connected socket
+         * @param file_path 新文件路径 & new file path
+         * @return true表示成功,false表示失败 & true for success,false for failed
+         */
+        bool send(TcpSocket& socket,const std::string& file_path);
+
+        /**
+         * 增量接收文件:发送本地文件的块签名,逐帧应用收到的增量,本地文件不存在时整体接收 & delta recv file: send block signature of local file,apply received delta frame by frame,whole file is received when local file is missing
+         * @brief 阻塞直到接收完成 & blocks until done
+         * @param socket 已连接的socket & connected socket
+         * @param file_path 本地文件路径,原地更新 & local file path,updated in place
+         * @return true表示成功,false表示失败 & true for success,false for failed
+         */
+        bool recv(TcpSocket& socket,const std::string& file_path);
+    }
+
+} // hzd
+
+#endif //IO_UTILS_DELTASYNC_H
@@ -8,14 +8,30 @@
   */
 #include <Mole.h>
 #include "FileSystem.h"
+#include "../Path/Path.h"
+#include "../ThreadPool/ThreadPool.h"
 #include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <bitset>
+#include <memory>
+#include <mutex>
+#include <set>
 
 
 #ifdef __linux__
 #include <sys/stat.h>
+#include <sys/statvfs.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <linux/fs.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <cstring>
 #include <dirent.h>
+#include <climits>
+#include <sys/syscall.h>
+#include <vector>
 #elif _WIN32
 
 #ifdef _M_AMD64
@@ -34,6 +50,7 @@
 #include <fileapi.h>
 #include <errhandlingapi.h>
 #include <WinBase.h>
+#include <processthreadsapi.h>
 
 namespace hzd {
     std::string GetLastError_() noexcept {
@@ -83,7 +100,190 @@ namespace hzd {
             return st.st_mode & S_IFDIR;
         }
 
-        bool copy(const std::string &src_path, const std::string &dest_path,bool is_overwrite) {
+#ifdef __linux__
+        bool _data_extents(int fd,uint64_t size,std::vector<Extent>& extents) {
+            extents.clear();
+            off_t offset = 0;
+            while(static_cast<uint64_t>(offset) < size) {
+                off_t data = lseek(fd,offset,SEEK_DATA);
+                if(data < 0) {
+                    // ENXIO表示其后全为空洞 & ENXIO means only holes follow
+                    if(errno == ENXIO) break;
+                    if(errno == EINVAL || errno == EOPNOTSUPP) {
+                        extents.assign(1,Extent{0,size});
+                        return true;
+                    }
+                    MOLE_ERROR(io_filesystem_channel,strerror(errno));
+                    return false;
+                }
+                off_t hole = lseek(fd,data,SEEK_HOLE);
+                if(hole < 0) {
+                    MOLE_ERROR(io_filesystem_channel,strerror(errno));
+                    return false;
+                }
+                if(static_cast<uint64_t>(hole) > size) hole = static_cast<off_t>(size);
+                if(hole > data) extents.push_back(Extent{static_cast<uint64_t>(data),static_cast<uint64_t>(hole - data)});
+                offset = hole;
+            }
+            return true;
+        }
+
+        // 逐区段复制并跳过空洞,最后用ftruncate补齐尾部空洞 & copy extent by extent skipping holes,ftruncate restores trailing hole
+        bool _copy_sparse(int in_fd,int out_fd,uint64_t size,const std::vector<Extent>& extents) {
+            std::vector<char> buffer;
+            for(auto& extent : extents) {
+                auto in_offset = static_cast<off_t>(extent.offset);
+                auto out_offset = static_cast<off_t>(extent.offset);
+                uint64_t copied = 0;
+                bool is_fallback = !buffer.empty();
+                while(copied < extent.length && !is_fallback) {
+                    ssize_t ret = copy_file_range(in_fd,&in_offset,out_fd,&out_offset,extent.length - copied,0);
+                    if(ret < 0) {
+                        if(errno == EINTR) continue;
+                        if(errno == ENOSYS || errno == EXDEV || errno == EINVAL || errno == EOPNOTSUPP || errno == EPERM) {
+                            is_fallback = true;
+                            break;
+                        }
+                        MOLE_ERROR(io_filesystem_channel,strerror(errno));
+                        return false;
+                    }
+                    if(ret == 0) break;
+                    copied += ret;
+                }
+                if(!is_fallback) continue;
+                if(buffer.empty()) buffer.resize(1024 * 1024);
+                while(copied < extent.length) {
+                    size_t need = std::min<uint64_t>(buffer.size(),extent.length - copied);
+                    ssize_t had_read = pread(in_fd,buffer.data(),need,static_cast<off_t>(extent.offset + copied));
+                    if(had_read < 0 && errno == EINTR) continue;
+                    if(had_read <= 0) {
+                        if(had_read < 0) MOLE_ERROR(io_filesystem_channel,strerror(errno));
+                        return had_read == 0;
+                    }
+                    ssize_t had_write = 0;
+                    while(had_write < had_read) {
+                        ssize_t ret = pwrite(out_fd,buffer.data() + had_write,had_read - had_write,static_cast<off_t>(extent.offset + copied + had_write));
+                        if(ret < 0) {
+                            if(errno == EINTR) continue;
+                            MOLE_ERROR(io_filesystem_channel,strerror(errno));
+                            return false;
+                        }
+                        had_write += ret;
+                    }
+                    copied += had_read;
+                }
+            }
+            if(ftruncate(out_fd,static_cast<off_t>(size)) != 0) {
+                MOLE_ERROR(io_filesystem_channel,strerror(errno));
+                return false;
+            }
+            return true;
+        }
+
+        // 在两个已打开的文件间复制内容,由快到慢逐级回退 & copy content between two opened files,falling back from fastest to slowest
+        bool _copy_fd(int in_fd,int out_fd,size_t size) {
+            // 1. reflink: 同一CoW文件系统上只复制元数据 & metadata-only copy on the same CoW filesystem
+            if(ioctl(out_fd,FICLONE,in_fd) == 0) return true;
+
+            // 分配块数少于文件大小说明存在空洞 & fewer allocated blocks than size means holes exist
+            struct stat in_st{};
+            if(fstat(in_fd,&in_st) == 0 && static_cast<uint64_t>(in_st.st_blocks) * 512 < size) {
+                std::vector<Extent> extents;
+                if(_data_extents(in_fd,size,extents)) return _copy_sparse(in_fd,out_fd,size,extents);
+            }
+
+            // 目标大小已知,预分配得到连续区段,空间不足时在复制前失败 & final size is known,preallocate for contiguous extents and fail before copying when space runs out
+            if(size > 0 && fallocate(out_fd,FALLOC_FL_KEEP_SIZE,0,static_cast<off_t>(size)) != 0 && errno == ENOSPC) {
+                MOLE_ERROR(io_filesystem_channel,strerror(errno),{ MOLE_VAR(size) });
+                return false;
+            }
+
+            size_t copied = 0;
+            // 2. copy_file_range: 内核内复制,支持的文件系统可下推到存储 & in-kernel copy,offloaded to storage where supported
+            while(copied < size) {
+                ssize_t ret = copy_file_range(in_fd,nullptr,out_fd,nullptr,size - copied,0);
+                if(ret < 0) {
+                    if(errno == EINTR) continue;
+                    if(copied == 0 && (errno == ENOSYS || errno == EXDEV || errno == EINVAL || errno == EOPNOTSUPP || errno == EPERM)) break;
+                    MOLE_ERROR(io_filesystem_channel,strerror(errno));
+                    return false;
+                }
+                if(ret == 0) break;
+                copied += ret;
+            }
+            if(copied >= size) return true;
+
+            // 3. sendfile: 仍在内核内,但经过页缓存 & still in kernel,through page cache
+            if(copied == 0) {
+                while(copied < size) {
+                    ssize_t ret = sendfile(out_fd,in_fd,nullptr,size - copied);
+                    if(ret < 0) {
+                        if(errno == EINTR) continue;
+                        if(copied == 0 && (errno == EINVAL || errno == ENOSYS)) break;
+                        MOLE_ERROR(io_filesystem_channel,strerror(errno));
+                        return false;
+                    }
+                    if(ret == 0) break;
+                    copied += ret;
+                }
+                if(copied >= size) return true;
+            }
+
+            // 4. 大缓冲读写,同时处理读取期间文件增长 & large-buffer read/write,also handles growth during copy
+            std::vector<char> buffer(1024 * 1024);
+            while(true) {
+                ssize_t had_read = read(in_fd,buffer.data(),buffer.size());
+                if(had_read < 0) {
+                    if(errno == EINTR) continue;
+                    MOLE_ERROR(io_filesystem_channel,strerror(errno));
+                    return false;
+                }
+                if(had_read == 0) break;
+                ssize_t had_write = 0;
+                while(had_write < had_read) {
+                    ssize_t ret = write(out_fd,buffer.data() + had_write,had_read - had_write);
+                    if(ret < 0) {
+                        if(errno == EINTR) continue;
+                        MOLE_ERROR(io_filesystem_channel,strerror(errno));
+                        return false;
+                    }
+                    had_write += ret;
+                }
+            }
+            return true;
+        }
+
+        bool _copy_file(const std::string& src_path,const std::string& dest_path,const struct stat& src_st,bool is_preserve_time) {
+            int in_fd = open(src_path.c_str(),O_RDONLY | O_CLOEXEC);
+            if(in_fd < 0) {
+                MOLE_ERROR(io_filesystem_channel,strerror(errno),{ MOLE_VAR(src_path) });
+                return false;
+            }
+            int out_fd = open(dest_path.c_str(),O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,src_st.st_mode & 07777);
+            if(out_fd < 0) {
+                MOLE_ERROR(io_filesystem_channel,"destination can't access.",{ MOLE_VAR(dest_path) });
+                close(in_fd);
+                return false;
+            }
+            bool ret = _copy_fd(in_fd,out_fd,src_st.st_size);
+            // open的mode受umask影响,显式设置 & open mode is masked by umask,set explicitly
+            if(ret && fchmod(out_fd,src_st.st_mode & 07777) != 0) {
+                MOLE_WARN(io_filesystem_channel,strerror(errno),{ MOLE_VAR(dest_path) });
+            }
+            if(ret && is_preserve_time) {
+                timespec times[2] = { src_st.st_atim,src_st.st_mtim };
+                if(futimens(out_fd,times) != 0) MOLE_WARN(io_filesystem_channel,strerror(errno),{ MOLE_VAR(dest_path) });
+            }
+            close(in_fd);
+            if(close(out_fd) != 0 && ret) {
+                MOLE_ERROR(io_filesystem_channel,strerror(errno),{ MOLE_VAR(dest_path) });
+                return false;
+            }
+            return ret;
+        }
+#endif
+
+        bool copy(const std::string &src_path, const std::string &dest_path,bool is_overwrite,bool is_preserve_time) {
             struct stat src_st{},dest_st{};
             if(!_exists(src_path,src_st)) {
                 MOLE_ERROR(io_filesystem_channel,"source file not exist",{ MOLE_VAR(src_path) });
@@ -103,41 +303,165 @@ namespace hzd {
             if(sub_start == std::string::npos) sub_start = 0;
             std::string src_file_name = processed_src_path.substr(sub_start);
 
-            std::ifstream src(src_path);
-            if(!_exists(dest_path,dest_st)) {
-                std::ofstream dest(dest_path);
-                if(!dest.is_open()) {
-                    MOLE_ERROR(io_filesystem_channel,"destination can't access.",{MOLE_VAR(dest_path)});
-                    return false;
-                }
-                dest << src.rdbuf();
-                return true;
-            }else{
+            std::string target_path = dest_path;
+            if(_exists(dest_path,dest_st)) {
                 if(dest_st.st_mode & S_IFDIR) {
-                    std::ofstream dest(dest_path + "/" + src_file_name);
-                    dest << src.rdbuf();
-                    return true;
+                    target_path = dest_path + "/" + src_file_name;
+                    if(!_exists(target_path,dest_st)) dest_st = {};
                 }
-                else {
-                    if(!is_overwrite) {
-                        MOLE_ERROR(io_filesystem_channel,"destination file already exist,maybe set is_overwrite = true?",{ MOLE_VAR(dest_path) });
-                        return false;
-                    }
-                    std::ofstream dest(dest_path,std::ios::out | std::ios::trunc);
-                    dest << src.rdbuf();
-                    return true;
+                else if(!is_overwrite) {
+                    MOLE_ERROR(io_filesystem_channel,"destination file already exist,maybe set is_overwrite = true?",{ MOLE_VAR(dest_path) });
+                    return false;
+                }
+                if(dest_st.st_dev == src_st.st_dev && dest_st.st_ino == src_st.st_ino) {
+                    MOLE_ERROR(io_filesystem_channel,"source and destination are the same file",{ MOLE_VAR(src_path),MOLE_VAR(dest_path) });
+                    return false;
                 }
             }
+#ifdef __linux__
+            return _copy_file(src_path,target_path,src_st,is_preserve_time);
+#elif _WIN32
+            std::ifstream src(src_path,std::ios::in | std::ios::binary);
+            std::ofstream dest(target_path,std::ios::out | std::ios::trunc | std::ios::binary);
+            if(!dest.is_open()) {
+                MOLE_ERROR(io_filesystem_channel,"destination can't access.",{MOLE_VAR(target_path)});
+                return false;
+            }
+            dest << src.rdbuf();
+            return true;
+#endif
         }
 
-        std::string pwd() {
-            char buffer[4096] = {0};
+        bool data_extents(const std::string& path,std::vector<Extent>& extents,uint64_t& file_size) {
+            struct stat st{};
+            if(!_exists(path,st)) {
+                MOLE_ERROR(io_filesystem_channel,"file not exist",{ MOLE_VAR(path) });
+                return false;
+            }
+            file_size = static_cast<uint64_t>(st.st_size);
+#ifdef __linux__
+            int fd = open(path.c_str(),O_RDONLY | O_CLOEXEC);
+            if(fd < 0) {
+                MOLE_ERROR(io_filesystem_channel,strerror(errno),{ MOLE_VAR(path) });
+                return false;
+            }
+            bool ret = _data_extents(fd,file_size,extents);
+            close(fd);
+            return ret;
+#elif _WIN32
+            extents.clear();
+            if(file_size > 0) extents.push_back(Extent{0,file_size});
+            return true;
+#endif
+        }
+
+        bool preallocate(const std::string& path,uint64_t offset,uint64_t length,bool is_keep_size) {
+#ifdef __linux__
+            int fd = open(path.c_str(),O_WRONLY | O_CREAT | O_CLOEXEC,0644);
+            if(fd < 0) {
+                MOLE_ERROR(io_filesystem_channel,strerror(errno),{ MOLE_VAR(path) });
+                return false;
+            }
+            int ret = fallocate(fd,is_keep_size ? FALLOC_FL_KEEP_SIZE : 0,static_cast<off_t>(offset),static_cast<off_t>(length));
+            // 不支持fallocate的文件系统由glibc写零模拟 & glibc emulates by writing zeros where fallocate is unsupported
+            if(ret != 0 && errno == EOPNOTSUPP && !is_keep_size) {
+                ret = posix_fallocate(fd,static_cast<off_t>(offset),static_cast<off_t>(length));
+                if(ret != 0) errno = ret;
+            }
+            if(ret != 0) {
+                MOLE_ERROR(io_filesystem_channel,strerror(errno),{ MOLE_VAR(path),MOLE_VAR(length) });
+                close(fd);
+                return false;
+            }
+            return close(fd) == 0;
+#elif _WIN32
+            HANDLE handle = CreateFileA(path.c_str(),GENERIC_WRITE,FILE_SHARE_READ | FILE_SHARE_WRITE,nullptr,OPEN_ALWAYS,FILE_ATTRIBUTE_NORMAL,nullptr);
+            if(handle == INVALID_HANDLE_VALUE) {
+                MOLE_ERROR(io_filesystem_channel,GetLastError_(),{ MOLE_VAR(path) });
+                return false;
+            }
+            FILE_ALLOCATION_INFO allocation{};
+            allocation.AllocationSize.QuadPart = static_cast<LONGLONG>(offset + length);
+            bool ret = SetFileInformationByHandle(handle,FileAllocationInfo,&allocation,sizeof(allocation)) != 0;
+            LARGE_INTEGER size{};
+            if(ret && !is_keep_size && GetFileSizeEx(handle,&size) && static_cast<uint64_t>(size.QuadPart) < offset + length) {
+                FILE_END_OF_FILE_INFO end_of_file{};
+                end_of_file.EndOfFile.QuadPart = static_cast<LONGLONG>(offset + length);
+                ret = SetFileInformationByHandle(handle,FileEndOfFileInfo,&end_of_file,sizeof(end_of_file)) != 0;
+            }
+            if(!ret) MOLE_ERROR(io_filesystem_channel,GetLastError_(),{ MOLE_VAR(path) });
+            CloseHandle(handle);
+            return ret;
+#endif
+        }
+
+        bool punch_hole(const std::string& path,uint64_t offset,uint64_t length) {
+#ifdef __linux__
+            int fd = open(path.c_str(),O_WRONLY | O_CLOEXEC);
+            if(fd < 0) {
+                MOLE_ERROR(io_filesystem_channel,strerror(errno),{ MOLE_VAR(path) });
+                return false;
+            }
+            bool ret = fallocate(fd,FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,static_cast<off_t>(offset),static_cast<off_t>(length)) == 0;
+            if(!ret) MOLE_ERROR(io_filesystem_channel,strerror(errno),{ MOLE_VAR(path) });
+            close(fd);
+            return ret;
+#elif _WIN32
+            MOLE_ERROR(io_filesystem_channel,"punch_hole is not supported on windows");
+            return false;
+#endif
+        }
+
+        bool truncate(const std::string& path,uint64_t size) {
+#ifdef __linux__
+            if(::truncate(path.c_str(),static_cast<off_t>(size)) != 0) {
+                MOLE_ERROR(io_filesystem_channel,strerror(errno),{ MOLE_VAR(path) });
+                return false;
+            }
+            return true;
+#elif _WIN32
+            HANDLE handle = CreateFileA(path.c_str(),GENERIC_WRITE,FILE_SHARE_READ | FILE_SHARE_WRITE,nullptr,OPEN_EXISTING,FILE_ATTRIBUTE_NORMAL,nullptr);
+            if(handle == INVALID_HANDLE_VALUE) {
+                MOLE_ERROR(io_filesystem_channel,GetLastError_(),{ MOLE_VAR(path) });
+                return false;
+            }
+            FILE_END_OF_FILE_INFO end_of_file{};
+            end_of_file.EndOfFile.QuadPart = static_cast<LONGLONG>(size);
+            bool ret = SetFileInformationByHandle(handle,FileEndOfFileInfo,&end_of_file,sizeof(end_of_file)) != 0;
+            if(!ret) MOLE_ERROR(io_filesystem_channel,GetLastError_(),{ MOLE_VAR(path) });
+            CloseHandle(handle);
+            return ret;
+#endif
+        }
+
+        bool space(const std::string& path,SpaceInfo& info) {
 #ifdef __linux__
-            getcwd(buffer,sizeof(buffer));
-#elif  _WIN32
-            _getcwd(buffer,sizeof(buffer));
+            struct statvfs st{};
+            if(statvfs(path.c_str(),&st) != 0) {
+                MOLE_ERROR(io_filesystem_channel,strerror(errno),{ MOLE_VAR(path) });
+                return false;
+            }
+            info.capacity = static_cast<uint64_t>(st.f_blocks) * st.f_frsize;
+            info.free = static_cast<uint64_t>(st.f_bfree) * st.f_frsize;
+            info.available = static_cast<uint64_t>(st.f_bavail) * st.f_frsize;
+            return true;
+#elif _WIN32
+            ULARGE_INTEGER available,capacity,free_bytes;
+            if(!GetDiskFreeSpaceExA(path.c_str(),&available,&capacity,&free_bytes)) {
+                MOLE_ERROR(io_filesystem_channel,GetLastError_(),{ MOLE_VAR(path) });
+                return false;
+            }
+            info.capacity = capacity.QuadPart;
+            info.free = free_bytes.QuadPart;
+            info.available = available.QuadPart;
+            return true;
 #endif
-            return buffer;
+        }
+
+        std::string pwd() {
+            Path path;
+            Path::Current(path);
+            return path.String();
         }
 
         bool createdir(const std::string &path) {
@@ -185,14 +509,93 @@ namespace hzd {
             return ::remove(path.c_str()) == 0;
         }
 
-        bool move(const std::string &src_path, const std::string &dest_path) {
-            bool ret = copy(src_path,dest_path);
-            if(!ret) return false;
-            if(!remove(src_path)) {
-                MOLE_ERROR(io_filesystem_channel,strerror(errno));
+        bool move(const std::string &src_path, const std::string &dest_path,bool is_overwrite) {
+            struct stat src_st{},dest_st{};
+            if(!_exists(src_path,src_st)) {
+                MOLE_ERROR(io_filesystem_channel,"source file or dir not exist",{ MOLE_VAR(src_path) });
                 return false;
             }
-            return true;
+            std::string target_path = dest_path;
+            if(_exists(dest_path,dest_st) && (dest_st.st_mode & S_IFDIR)) {
+                std::string processed_src_path = src_path;
+                for(auto& c : processed_src_path) {
+                    if(c == '\\') c = '/';
+                }
+                while(processed_src_path.size() > 1 && processed_src_path.back() == '/') processed_src_path.pop_back();
+                auto sub_start = processed_src_path.find_last_of('/');
+                target_path = dest_path + "/" + (sub_start == std::string::npos ? processed_src_path : processed_src_path.substr(sub_start + 1));
+            }
+#ifdef __linux__
+            // 1. 同一文件系统上rename为O(1)元数据操作 & rename is an O(1) metadata operation on the same filesystem
+            int ret;
+            if(is_overwrite) {
+                ret = ::rename(src_path.c_str(),target_path.c_str());
+            }else {
+                ret = static_cast<int>(syscall(SYS_renameat2,AT_FDCWD,src_path.c_str(),AT_FDCWD,target_path.c_str(),RENAME_NOREPLACE));
+                if(ret != 0 && (errno == ENOSYS || errno == EINVAL)) {
+                    // 内核或文件系统不支持RENAME_NOREPLACE,退回检查后rename & RENAME_NOREPLACE unsupported,fall back to check then rename
+                    struct stat target_st{};
+                    if(lstat(target_path.c_str(),&target_st) == 0) {
+                        errno = EEXIST;
+                    }else {
+                        ret = ::rename(src_path.c_str(),target_path.c_str());
+                    }
+                }
+            }
+            if(ret == 0) return true;
+            // 已允许覆盖时EEXIST/ENOTEMPTY表示目标为非空目录,照实报告 & with is_overwrite set,EEXIST/ENOTEMPTY means target is a non-empty dir,report it as is
+            if(!is_overwrite && (errno == EEXIST || errno == ENOTEMPTY)) {
+                MOLE_ERROR(io_filesystem_channel,"destination already exist,maybe set is_overwrite = true?",{ MOLE_VAR(target_path) });
+                return false;
+            }
+            if(errno != EXDEV) {
+                MOLE_ERROR(io_filesystem_channel,strerror(errno),{ MOLE_VAR(src_path),MOLE_VAR(target_path) });
+                return false;
+            }
+            // 2. 跨设备: 先复制到临时路径,成功后再替换目标并删除源,复制失败时原目标不受影响 & cross device: copy to a temp path,replace target and remove source only on success,so a failed copy leaves the existing target intact
+            struct stat target_st{};
+            if(lstat(target_path.c_str(),&target_st) == 0 && !is_overwrite) {
+                MOLE_ERROR(io_filesystem_channel,"destination already exist,maybe set is_overwrite = true?",{ MOLE_VAR(target_path) });
+                return false;
+            }
+            struct stat link_st{};
+            if(lstat(src_path.c_str(),&link_st) != 0) {
+                MOLE_ERROR(io_filesystem_channel,strerror(errno),{ MOLE_VAR(src_path) });
+                return false;
+            }
+            std::string temp = temp_path(target_path);
+            bool is_copied;
+            if(S_ISDIR(link_st.st_mode)) {
+                is_copied = copy_tree(src_path,temp);
+            }else if(S_ISLNK(link_st.st_mode)) {
+                std::vector<char> link(link_st.st_size > 0 ? link_st.st_size + 1 : PATH_MAX);
+                ssize_t size = readlink(src_path.c_str(),link.data(),link.size());
+                is_copied = size >= 0 && symlink(std::string(link.data(),size).c_str(),temp.c_str()) == 0;
+                if(!is_copied) MOLE_ERROR(io_filesystem_channel,strerror(errno),{ MOLE_VAR(src_path) });
+            }else {
+                is_copied = _copy_file(src_path,temp,link_st,true);
+            }
+            if(is_copied && ::rename(temp.c_str(),target_path.c_str()) != 0) {
+                // rename无法替换非空目录或不同类型的目标,复制已完成后再删除旧目标 & rename can't replace a non-empty dir or a target of another type,remove the old target only now that the copy is complete
+                bool is_replaceable = is_overwrite && (errno == ENOTEMPTY || errno == EEXIST || errno == EISDIR || errno == ENOTDIR);
+                std::string error = strerror(errno);
+                is_copied = is_replaceable && remove_all(target_path) && ::rename(temp.c_str(),target_path.c_str()) == 0;
+                if(!is_copied) {
+                    if(is_replaceable) error = strerror(errno);
+                    MOLE_ERROR(io_filesystem_channel,error.c_str(),{ MOLE_VAR(temp),MOLE_VAR(target_path) });
+                }
+            }
+            if(!is_copied) {
+                if(lstat(temp.c_str(),&target_st) == 0) remove_all(temp);
+                return false;
+            }
+            return remove_all(src_path);
+#elif _WIN32
+            DWORD flags = MOVEFILE_COPY_ALLOWED | (is_overwrite ? MOVEFILE_REPLACE_EXISTING : 0);
+            if(MoveFileExA(src_path.c_str(),target_path.c_str(),flags)) return true;
+            MOLE_ERROR(io_filesystem_channel,GetLastError_(),{ MOLE_VAR(src_path),MOLE_VAR(target_path) });
+            return false;
+#endif
         }
 
         bool rename(const std::string& old_name,const std::string& new_name) {
@@ -203,6 +606,122 @@ namespace hzd {
             }
         }
 
+        std::string parent_dir(const std::string& path) {
+            auto pos = path.find_last_of("/\\");
+            if(pos == std::string::npos) return ".";
+            if(pos == 0) return path.substr(0,1);
+            return path.substr(0,pos);
+        }
+
+        std::string temp_path(const std::string& path) {
+            static std::atomic<uint64_t> counter{0};
+#ifdef __linux__
+            long pid = static_cast<long>(getpid());
+#elif _WIN32
+            long pid = static_cast<long>(GetCurrentProcessId());
+#endif
+            return path + ".tmp." + std::to_string(pid) + "." + std::to_string(counter.fetch_add(1,std::memory_order_relaxed));
+        }
+
+        int open_temp(const std::string& path,std::string& temp) {
+            temp = temp_path(path);
+#ifdef __linux__
+            struct stat st{};
+            bool is_replace = stat(path.c_str(),&st) == 0 && S_ISREG(st.st_mode);
+            // 替换时先以0600创建,设置好属主与权限前不暴露内容 & create 0600 when replacing,content isn't exposed before owner and mode are set
+            int fd = open(temp.c_str(),O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC,is_replace ? 0600 : 0644);
+            if(fd < 0) {
+                MOLE_ERROR(io_filesystem_channel,strerror(errno),{ MOLE_VAR(temp) });
+                return -1;
+            }
+            if(!is_replace) return fd;
+            // 先chown,它会清除setuid/setgid位 & chown first,it clears setuid/setgid bits
+            if(fchown(fd,st.st_uid,st.st_gid) != 0) {
+                MOLE_WARN(io_filesystem_channel,"can't preserve owner of replaced file",{ MOLE_VAR(path) });
+            }
+            if(fchmod(fd,st.st_mode & 07777) != 0) {
+                MOLE_ERROR(io_filesystem_channel,strerror(errno),{ MOLE_VAR(temp) });
+                close(fd);
+                unlink(temp.c_str());
+                return -1;
+            }
+            return fd;
+#elif _WIN32
+            int fd = _open(temp.c_str(),_O_WRONLY | _O_CREAT | _O_EXCL | _O_BINARY,_S_IREAD | _S_IWRITE);
+            if(fd < 0) MOLE_ERROR(io_filesystem_channel,strerror(errno),{ MOLE_VAR(temp) });
+            return fd;
+#endif
+        }
+
+        bool sync_dir(const std::string& path) {
+#ifdef __linux__
+            int fd = open(path.c_str(),O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            if(fd < 0) {
+                MOLE_ERROR(io_filesystem_channel,strerror(errno),{ MOLE_VAR(path) });
+                return false;
+            }
+            int ret = fsync(fd);
+            int err = errno;
+            close(fd);
+            if(ret != 0) {
+                MOLE_ERROR(io_filesystem_channel,strerror(err),{ MOLE_VAR(path) });
+                return false;
+            }
+            return true;
+#elif _WIN32
+            // NTFS的元数据由日志保证,目录无法单独刷新 & NTFS journals metadata,dirs can't be flushed separately
+            return true;
+#endif
+        }
+
+        bool atomic_write(const std::string& path,const char* data,size_t size,bool is_sync) {
+#ifdef __linux__
+            std::string temp;
+            int fd = open_temp(path,temp);
+            if(fd < 0) return false;
+            size_t written = 0;
+            int err = 0;
+            while(written < size && err == 0) {
+                ssize_t ret = write(fd,data + written,size - written);
+                if(ret < 0) {
+                    if(errno != EINTR) err = errno;
+                    continue;
+                }
+                written += static_cast<size_t>(ret);
+            }
+            // rename前数据必须已落盘,否则崩溃后可能看到空文件 & data must be durable before rename,otherwise a crash may expose an empty file
+            if(err == 0 && is_sync && fdatasync(fd) != 0) err = errno;
+            if(close(fd) != 0 && err == 0) err = errno;
+            if(err == 0 && ::rename(temp.c_str(),path.c_str()) != 0) err = errno;
+            if(err != 0) {
+                MOLE_ERROR(io_filesystem_channel,strerror(err),{ MOLE_VAR(path) });
+                unlink(temp.c_str());
+                return false;
+            }
+            return !is_sync || sync_dir(parent_dir(path));
+#elif _WIN32
+            std::string temp = temp_path(path);
+            FILE* file = fopen(temp.c_str(),"wb");
+            if(!file) {
+                MOLE_ERROR(io_filesystem_channel,strerror(errno),{ MOLE_VAR(temp) });
+                return false;
+            }
+            bool ret = fwrite(data,1,size,file) == size && fflush(file) == 0;
+            if(ret && is_sync) ret = _commit(_fileno(file)) == 0;
+            if(fclose(file) != 0) ret = false;
+            if(ret && !MoveFileExA(temp.c_str(),path.c_str(),MOVEFILE_REPLACE_EXISTING | (is_sync ? MOVEFILE_WRITE_THROUGH : 0))) {
+                MOLE_ERROR(io_filesystem_channel,GetLastError_(),{ MOLE_VAR(path) });
+                ret = false;
+            }
+            if(!ret) remove(temp.c_str());
+            return ret;
+#endif
+        }
+
+        bool atomic_write(const std::string& path,const std::string& data,bool is_sync) {
+            return atomic_write(path,data.data(),data.size(),is_sync);
+        }
+
         bool listdir(const std::string& path,std::vector<std::string>& dirs_name,std::vector<std::string>& files_name) {
 #ifdef __linux__
             DIR* dir = opendir(path.c_str());
@@ -249,20 +768,1080 @@ namespace hzd {
                 return false;
             }
 #ifdef __linux__
-            char result[4096] = {0};
-            if(!realpath(path.c_str(),result)) {
+            // realpath(path,nullptr)按实际长度分配,不受PATH_MAX缓冲区限制 & realpath(path,nullptr) allocates the exact length,no PATH_MAX buffer
+            char* result = realpath(path.c_str(),nullptr);
+            if(!result) {
                 MOLE_ERROR(io_filesystem_channel,strerror(errno));
                 return false;
             }
+            absolute_path = result;
+            free(result);
 #elif _WIN32
-            char result[4096] = {0};
-            auto ret = GetFullPathName(path.c_str(),sizeof(result),result,nullptr);
-            if(ret == 0) {
+            auto size = GetFullPathName(path.c_str(),0,nullptr,nullptr);
+            if(size == 0) {
                 MOLE_ERROR(io_filesystem_channel,GetLastError_());
                 return false;
             }
+            absolute_path.resize(size);
+            size = GetFullPathName(path.c_str(),size,&absolute_path[0],nullptr);
+            if(size == 0) {
+                MOLE_ERROR(io_filesystem_channel,GetLastError_());
+                return false;
+            }
+            absolute_path.resize(size);
 #endif
-            absolute_path = result;
+            return true;
+        }
+
+#ifdef __linux__
+        // getdents64返回的目录项 & directory entry returned by getdents64
+        struct _linux_dirent64 {
+            uint64_t        d_ino;
+            int64_t         d_off;
+            unsigned short  d_reclen;
+            unsigned char   d_type;
+            char            d_name[1];
+        };
+
+        struct _WalkContext {
+            const WalkCallback&     callback;
+            const WalkOptions&      options;
+            int                     root_fd;
+            Path                    root;
+            ThreadPool&             pool;
+            std::atomic<bool>       is_failed{false};
+            // 跟随符号链接时已进入的目录 & dirs already entered when following symlinks
+            std::mutex              visited_mutex;
+            std::set<std::pair<uint64_t,uint64_t>> visited;
+
+            _WalkContext(const WalkCallback& callback_,const WalkOptions& options_,int root_fd_,const std::string& root_,ThreadPool& pool_)
+            : callback(callback_),options(options_),root_fd(root_fd_),root(root_),pool(pool_) {}
+
+            // 首次进入该目录时返回true & returns true on first entry into the dir
+            bool Visit(int fd) {
+                struct stat st{};
+                if(fstat(fd,&st) != 0) return true;
+                std::lock_guard<std::mutex> guard(visited_mutex);
+                return visited.emplace(static_cast<uint64_t>(st.st_dev),static_cast<uint64_t>(st.st_ino)).second;
+            }
+        };
+
+        // 用大缓冲区getdents64读取目录,跳过.和..,d_type缺失时用fstatat补全 & read dir with large-buffer getdents64,skip . and ..,fstatat when d_type is missing
+        // 按嵌套层数分配的线程内缓冲区,回调中再次读目录不会覆盖外层仍在遍历的缓冲区 & per-thread buffers indexed by nesting level,so reading a dir inside the callback doesn't clobber the buffer the outer loop is still walking
+        struct _DirBufferLease {
+            std::vector<char>* buffer;
+
+            _DirBufferLease() {
+                auto& buffers = pool_();
+                if(buffers.size() <= depth_()) buffers.emplace_back(new std::vector<char>(256 * 1024));
+                buffer = buffers[depth_()++].get();
+            }
+            ~_DirBufferLease() { depth_()--; }
+
+            static std::vector<std::unique_ptr<std::vector<char>>>& pool_() {
+                thread_local std::vector<std::unique_ptr<std::vector<char>>> buffers;
+                return buffers;
+            }
+            static size_t& depth_() {
+                thread_local size_t depth = 0;
+                return depth;
+            }
+        };
+
+        bool _read_dir(int fd,const std::function<void(const char*,unsigned char)>& callback) {
+            _DirBufferLease lease;
+            std::vector<char>& buffer = *lease.buffer;
+            while(true) {
+                long size = syscall(SYS_getdents64,fd,buffer.data(),buffer.size());
+                if(size < 0) {
+                    if(errno == EINTR) continue;
+                    return false;
+                }
+                if(size == 0) return true;
+                for(long offset = 0; offset < size;) {
+                    auto entry = reinterpret_cast<_linux_dirent64*>(buffer.data() + offset);
+                    offset += entry->d_reclen;
+                    const char* name = entry->d_name;
+                    if(name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) continue;
+                    unsigned char type = entry->d_type;
+                    struct stat st{};
+                    // 部分文件系统不填充d_type & some filesystems leave d_type unset
+                    if(type == DT_UNKNOWN && fstatat(fd,name,&st,AT_SYMLINK_NOFOLLOW) == 0) {
+                        type = S_ISDIR(st.st_mode) ? DT_DIR : S_ISREG(st.st_mode) ? DT_REG : S_ISLNK(st.st_mode) ? DT_LNK : DT_UNKNOWN;
+                    }
+                    callback(name,type);
+                }
+            }
+        }
+
+        // 子任务持有父目录fd,打开自身后即释放 & child tasks hold the parent dir fd and release it once they've opened themselves
+        struct _DirHandle {
+            int fd;
+
+            explicit _DirHandle(int fd_) : fd(fd_) {}
+            ~_DirHandle() { if(fd >= 0) close(fd); }
+        };
+
+        // 扫描一个目录,relative为相对根目录的路径,dir_name为其在parent中的名字 & scan one dir,relative is path relative to root,dir_name is its entry in parent
+        void _walk_dir(_WalkContext& context,std::shared_ptr<_DirHandle> parent,const std::string& dir_name,const Path& relative,int depth) {
+            // 相对父目录fd逐级打开,路径中途被换成符号链接也不会被跟随 & open level by level from the parent fd,so a path component swapped for a symlink midway isn't followed
+            int flags = O_RDONLY | O_DIRECTORY | O_CLOEXEC | (context.options.is_follow_symlink ? 0 : O_NOFOLLOW);
+            int fd = parent ? openat(parent->fd,dir_name.c_str(),flags) : dup(context.root_fd);
+            parent.reset();
+            if(fd < 0) {
+                std::string relative_path = relative.String();
+                MOLE_WARN(io_filesystem_channel,strerror(errno),{ MOLE_VAR(relative_path) });
+                context.is_failed.store(true,std::memory_order_relaxed);
+                return;
+            }
+            // 符号链接可能成环,每个目录只进入一次 & symlinks may form cycles,enter each dir only once
+            if(context.options.is_follow_symlink && !context.Visit(fd)) {
+                close(fd);
+                return;
+            }
+            auto handle = std::make_shared<_DirHandle>(fd);
+            // 本目录的完整路径,逐项Append/PopBack复用,条目路径不再逐个拼接分配 & full path of this dir,reused via Append/PopBack so entry paths aren't concatenated and allocated one by one
+            Path path(context.root);
+            path.Append(relative.View());
+            WalkEntry walk_entry;
+            walk_entry.depth = depth;
+            bool ret = _read_dir(fd,[&](const char* name,unsigned char type) {
+                struct stat st{};
+                if(type == DT_LNK && context.options.is_follow_symlink && fstatat(fd,name,&st,0) == 0) {
+                    type = S_ISDIR(st.st_mode) ? DT_DIR : S_ISREG(st.st_mode) ? DT_REG : DT_UNKNOWN;
+                }
+                size_t name_size = strlen(name);
+                path.Append(name,name_size);
+                // assign复用上一项的容量 & assign reuses capacity of the previous entry
+                walk_entry.path.assign(path.CStr(),path.Size());
+                path.PopBack();
+                walk_entry.type = type == DT_DIR ? EntryType::DIRECTORY : type == DT_REG ? EntryType::FILE : type == DT_LNK ? EntryType::SYMLINK : EntryType::OTHER;
+                bool is_descend = context.callback(walk_entry);
+                if(type != DT_DIR || !is_descend) return;
+                if(context.options.max_depth >= 0 && depth >= context.options.max_depth) return;
+                Path child(relative);
+                child.Append(name,name_size);
+                std::string child_name(name,name_size);
+                _WalkContext* context_ptr = &context;
+                context.pool.Submit([context_ptr,handle,child_name,child,depth] { _walk_dir(*context_ptr,handle,child_name,child,depth + 1); });
+            });
+            if(!ret) {
+                std::string relative_path = relative.String();
+                MOLE_WARN(io_filesystem_channel,strerror(errno),{ MOLE_VAR(relative_path) });
+                context.is_failed.store(true,std::memory_order_relaxed);
+            }
+        }
+
+        // 目录树节点,子目录全部完成后才处理自身(删除或设置属性) & tree node,processed (removed or attributed) only after all subdirs finish
+        struct _TreeNode {
+            std::shared_ptr<_TreeNode>  parent;
+            std::string                 relative;
+            std::string                 name;
+            // 任务开始时由父目录fd打开,子目录完成前保持打开 & opened from the parent's fd when the task starts,kept open until subdirs finish
+            int                         src_fd{-1};
+            int                         dest_fd{-1};
+            struct stat                 st{};
+            // 自身扫描加未完成子目录数 & own scan plus unfinished subdirs
+            std::atomic<size_t>         pending{1};
+
+            ~_TreeNode() {
+                if(src_fd >= 0) close(src_fd);
+                if(dest_fd >= 0) close(dest_fd);
+            }
+        };
+
+        struct _TreeContext {
+            const TreeOptions&      options;
+            ThreadPool&             pool;
+            bool                    is_copy{false};
+            std::mutex              mutex;
+            std::vector<TreeError>  errors;
+
+            _TreeContext(const TreeOptions& options_,ThreadPool& pool_) : options(options_),pool(pool_) {}
+
+            void Fail(const std::string& relative) {
+                int code = errno;
+                std::lock_guard<std::mutex> guard(mutex);
+                errors.push_back(TreeError{relative,code});
+            }
+        };
+
+        void _tree_finish(_TreeContext& context,std::shared_ptr<_TreeNode> node) {
+            while(node && node->pending.fetch_sub(1,std::memory_order_acq_rel) == 1) {
+                if(!node->relative.empty()) {
+                    if(context.is_copy) {
+                        // 子项创建完成后再设置目录权限与时间 & set dir mode and times after children are created
+                        if(fchmod(node->dest_fd,node->st.st_mode & 07777) != 0) context.Fail(node->relative);
+                        timespec times[2] = { node->st.st_atim,node->st.st_mtim };
+                        if(context.options.is_preserve_time && futimens(node->dest_fd,times) != 0) context.Fail(node->relative);
+                    }else if(unlinkat(node->parent->src_fd,node->name.c_str(),AT_REMOVEDIR) != 0) {
+                        context.Fail(node->relative);
+                    }
+                }
+                node = node->parent;
+            }
+        }
+
+        bool _copy_entry(_TreeContext& context,int src_dir,int dest_dir,const char* name,unsigned char type) {
+            struct stat st{};
+            if(fstatat(src_dir,name,&st,AT_SYMLINK_NOFOLLOW) != 0) return false;
+            if(type == DT_LNK || S_ISLNK(st.st_mode)) {
+                std::vector<char> target(st.st_size > 0 ? st.st_size + 1 : PATH_MAX);
+                ssize_t size = readlinkat(src_dir,name,target.data(),target.size());
+                if(size < 0) return false;
+                std::string link(target.data(),size);
+                if(symlinkat(link.c_str(),dest_dir,name) == 0) return true;
+                if(errno != EEXIST || !context.options.is_overwrite) return false;
+                return unlinkat(dest_dir,name,0) == 0 && symlinkat(link.c_str(),dest_dir,name) == 0;
+            }
+            if(!S_ISREG(st.st_mode)) {
+                errno = ENOTSUP;
+                return false;
+            }
+            int in_fd = openat(src_dir,name,O_RDONLY | O_CLOEXEC | O_NOFOLLOW);
+            if(in_fd < 0) return false;
+            int flags = O_WRONLY | O_CREAT | O_CLOEXEC | O_NOFOLLOW | (context.options.is_overwrite ? O_TRUNC : O_EXCL);
+            int out_fd = openat(dest_dir,name,flags,st.st_mode & 07777);
+            if(out_fd < 0) {
+                close(in_fd);
+                return false;
+            }
+            bool ret = _copy_fd(in_fd,out_fd,st.st_size) && fchmod(out_fd,st.st_mode & 07777) == 0;
+            if(ret && context.options.is_preserve_time) {
+                timespec times[2] = { st.st_atim,st.st_mtim };
+                ret = futimens(out_fd,times) == 0;
+            }
+            int err = errno;
+            close(in_fd);
+            if(close(out_fd) != 0 && ret) {
+                ret = false;
+                err = errno;
+            }
+            errno = err;
+            return ret;
+        }
+
+        void _tree_dir(_TreeContext& context,std::shared_ptr<_TreeNode> node) {
+            int flags = O_RDONLY | O_DIRECTORY | O_CLOEXEC | O_NOFOLLOW;
+            if(node->parent) {
+                // O_NOFOLLOW只保护最后一段,相对父目录fd逐级打开,路径中途被换成符号链接也无法越出树 & O_NOFOLLOW guards only the last component,opening level by level from the parent fd keeps a component swapped for a symlink from escaping the tree
+                node->src_fd = openat(node->parent->src_fd,node->name.c_str(),flags);
+                if(node->src_fd >= 0 && context.is_copy) node->dest_fd = openat(node->parent->dest_fd,node->name.c_str(),flags);
+                if(node->src_fd < 0 || (context.is_copy && node->dest_fd < 0)) {
+                    context.Fail(node->relative);
+                    _tree_finish(context,node);
+                    return;
+                }
+            }
+            int src_dir = node->src_fd;
+            int dest_dir = node->dest_fd;
+            bool ret = _read_dir(src_dir,[&](const char* name,unsigned char type) {
+                std::string child = node->relative.empty() ? name : node->relative + "/" + name;
+                if(type == DT_DIR) {
+                    auto child_node = std::make_shared<_TreeNode>();
+                    child_node->parent = node;
+                    child_node->relative = child;
+                    child_node->name = name;
+                    if(context.is_copy) {
+                        if(fstatat(src_dir,name,&child_node->st,AT_SYMLINK_NOFOLLOW) != 0) {
+                            context.Fail(child);
+                            return;
+                        }
+                        // 先以可写权限创建,完成后再恢复原权限 & create writable first,restore original mode when done
+                        if(mkdirat(dest_dir,name,(child_node->st.st_mode & 07777) | S_IRWXU) != 0 && errno != EEXIST) {
+                            context.Fail(child);
+                            return;
+                        }
+                    }
+                    node->pending.fetch_add(1,std::memory_order_relaxed);
+                    _TreeContext* context_ptr = &context;
+                    context.pool.Submit([context_ptr,child_node] { _tree_dir(*context_ptr,child_node); });
+                    return;
+                }
+                bool is_done = context.is_copy ? _copy_entry(context,src_dir,dest_dir,name,type) : unlinkat(src_dir,name,0) == 0;
+                if(!is_done) context.Fail(child);
+            });
+            if(!ret) context.Fail(node->relative);
+            _tree_finish(context,node);
+        }
+
+        bool _tree_report(const char* operation,std::vector<TreeError>& collected,std::vector<TreeError>* errors) {
+            if(!collected.empty()) {
+                size_t error_count = collected.size();
+                std::string first_path = collected.front().path;
+                std::string first_error = strerror(collected.front().code);
+                MOLE_ERROR(io_filesystem_channel,operation,{ MOLE_VAR(error_count),MOLE_VAR(first_path),MOLE_VAR(first_error) });
+            }
+            bool ret = collected.empty();
+            if(errors) errors->insert(errors->end(),collected.begin(),collected.end());
+            return ret;
+        }
+#elif _WIN32
+        bool _walk_dir(const std::string& path,const WalkCallback& callback,const WalkOptions& options,int depth) {
+            _finddata_t file_data;
+            intptr_t handle = _findfirst((path + "\\*").c_str(),&file_data);
+            if(handle == -1L) {
+                MOLE_WARN(io_filesystem_channel,"can't match path",{ MOLE_VAR(path) });
+                return false;
+            }
+            bool ret = true;
+            do {
+                if(strcmp(file_data.name,".") == 0 || strcmp(file_data.name,"..") == 0) continue;
+                WalkEntry entry;
+                entry.path = path + "/" + file_data.name;
+                entry.type = (file_data.attrib & _A_SUBDIR) ? EntryType::DIRECTORY : EntryType::FILE;
+                entry.depth = depth;
+                bool is_descend = callback(entry);
+                if(entry.type != EntryType::DIRECTORY || !is_descend) continue;
+                if(options.max_depth >= 0 && depth >= options.max_depth) continue;
+                ret = _walk_dir(entry.path,callback,options,depth + 1) && ret;
+            }while(_findnext(handle,&file_data) == 0);
+            _findclose(handle);
+            return ret;
+        }
+#endif
+
+        bool walk(const std::string& root,const WalkCallback& callback,const WalkOptions& options) {
+            std::string processed_root = root;
+            while(processed_root.size() > 1 && (processed_root.back() == '/' || processed_root.back() == '\\')) processed_root.pop_back();
+#ifdef __linux__
+            int root_fd = open(processed_root.c_str(),O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            if(root_fd < 0) {
+                MOLE_ERROR(io_filesystem_channel,strerror(errno),{ MOLE_VAR(root) });
+                return false;
+            }
+            bool is_failed;
+            {
+                ThreadPool pool(options.threads);
+                _WalkContext context(callback,options,root_fd,processed_root,pool);
+                _WalkContext* context_ptr = &context;
+                pool.Submit([context_ptr] { _walk_dir(*context_ptr,nullptr,std::string(),Path(),1); });
+                pool.Wait();
+                is_failed = context.is_failed.load();
+            }
+            close(root_fd);
+            return !is_failed;
+#elif _WIN32
+            if(!is_directory(processed_root)) return false;
+            return _walk_dir(processed_root,callback,options,1);
+#endif
+        }
+
+        bool remove_all(const std::string& path,const TreeOptions& options,std::vector<TreeError>* errors) {
+#ifdef __linux__
+            struct stat st{};
+            if(lstat(path.c_str(),&st) != 0) {
+                MOLE_ERROR(io_filesystem_channel,"file or dir not exist",{ MOLE_VAR(path) });
+                if(errors) errors->push_back(TreeError{path,errno});
+                return false;
+            }
+            if(!S_ISDIR(st.st_mode)) {
+                if(unlink(path.c_str()) == 0) return true;
+                MOLE_ERROR(io_filesystem_channel,strerror(errno),{ MOLE_VAR(path) });
+                if(errors) errors->push_back(TreeError{path,errno});
+                return false;
+            }
+            int root_fd = open(path.c_str(),O_RDONLY | O_DIRECTORY | O_CLOEXEC | O_NOFOLLOW);
+            if(root_fd < 0) {
+                MOLE_ERROR(io_filesystem_channel,strerror(errno),{ MOLE_VAR(path) });
+                if(errors) errors->push_back(TreeError{path,errno});
+                return false;
+            }
+            std::vector<TreeError> collected;
+            {
+                ThreadPool pool(options.threads);
+                _TreeContext context(options,pool);
+                _TreeContext* context_ptr = &context;
+                auto node = std::make_shared<_TreeNode>();
+                node->src_fd = dup(root_fd);
+                pool.Submit([context_ptr,node] { _tree_dir(*context_ptr,node); });
+                pool.Wait();
+                collected.swap(context.errors);
+            }
+            close(root_fd);
+            for(auto& error : collected) error.path = path + "/" + error.path;
+            if(collected.empty() && rmdir(path.c_str()) != 0) collected.push_back(TreeError{path,errno});
+            return _tree_report("remove_all failed",collected,errors);
+#elif _WIN32
+            if(is_file(path)) return remove(path);
+            std::vector<std::string> dirs,files;
+            if(!listdir(path,dirs,files)) return false;
+            bool ret = true;
+            for(auto& name : files) {
+                if(!remove(path + "/" + name)) {
+                    ret = false;
+                    if(errors) errors->push_back(TreeError{path + "/" + name,errno});
+                }
+            }
+            for(auto& name : dirs) ret = remove_all(path + "/" + name,options,errors) && ret;
+            return ret && remove(path);
+#endif
+        }
+
+        bool copy_tree(const std::string& src_path,const std::string& dest_path,const TreeOptions& options,std::vector<TreeError>* errors) {
+#ifdef __linux__
+            struct stat st{};
+            if(stat(src_path.c_str(),&st) != 0 || !S_ISDIR(st.st_mode)) {
+                MOLE_ERROR(io_filesystem_channel,"source dir not exist",{ MOLE_VAR(src_path) });
+                if(errors) errors->push_back(TreeError{src_path,errno ? errno : ENOTDIR});
+                return false;
+            }
+            if(mkdir(dest_path.c_str(),(st.st_mode & 07777) | S_IRWXU) != 0 && errno != EEXIST) {
+                MOLE_ERROR(io_filesystem_channel,strerror(errno),{ MOLE_VAR(dest_path) });
+                if(errors) errors->push_back(TreeError{dest_path,errno});
+                return false;
+            }
+            int src_fd = open(src_path.c_str(),O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            int dest_fd = open(dest_path.c_str(),O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            if(src_fd < 0 || dest_fd < 0) {
+                MOLE_ERROR(io_filesystem_channel,strerror(errno),{ MOLE_VAR(src_path),MOLE_VAR(dest_path) });
+                if(errors) errors->push_back(TreeError{src_fd < 0 ? src_path : dest_path,errno});
+                if(src_fd >= 0) close(src_fd);
+                if(dest_fd >= 0) close(dest_fd);
+                return false;
+            }
+            std::vector<TreeError> collected;
+            {
+                ThreadPool pool(options.threads);
+                _TreeContext context(options,pool);
+                context.is_copy = true;
+                _TreeContext* context_ptr = &context;
+                auto node = std::make_shared<_TreeNode>();
+                node->src_fd = dup(src_fd);
+                node->dest_fd = dup(dest_fd);
+                pool.Submit([context_ptr,node] { _tree_dir(*context_ptr,node); });
+                pool.Wait();
+                collected.swap(context.errors);
+            }
+            for(auto& error : collected) error.path = src_path + "/" + error.path;
+            if(fchmod(dest_fd,st.st_mode & 07777) != 0) collected.push_back(TreeError{dest_path,errno});
+            timespec times[2] = { st.st_atim,st.st_mtim };
+            if(options.is_preserve_time && futimens(dest_fd,times) != 0) collected.push_back(TreeError{dest_path,errno});
+            close(src_fd);
+            close(dest_fd);
+            return _tree_report("copy_tree failed",collected,errors);
+#elif _WIN32
+            if(!is_directory(src_path)) return false;
+            if(!exists(dest_path) && !createdir(dest_path)) return false;
+            std::vector<std::string> dirs,files;
+            if(!listdir(src_path,dirs,files)) return false;
+            bool ret = true;
+            for(auto& name : files) {
+                if(!copy(src_path + "/" + name,dest_path + "/" + name,options.is_overwrite,options.is_preserve_time)) {
+                    ret = false;
+                    if(errors) errors->push_back(TreeError{src_path + "/" + name,errno});
+                }
+            }
+            for(auto& name : dirs) ret = copy_tree(src_path + "/" + name,dest_path + "/" + name,options,errors) && ret;
+            return ret;
+#endif
+        }
+
+#ifdef __linux__
+        struct _UsageContext {
+            const DiskUsageOptions& options;
+            ThreadPool&             pool;
+            int                     root_fd;
+            uint64_t                root_dev;
+            std::atomic<uint64_t>   apparent_size{0};
+            std::atomic<uint64_t>   allocated_size{0};
+            std::atomic<uint64_t>   files{0};
+            std::atomic<uint64_t>   dirs{0};
+            std::atomic<uint64_t>   symlinks{0};
+            std::atomic<uint64_t>   hardlinks{0};
+            std::atomic<bool>       is_limit_reached{false};
+            // 多链接inode集合,按inode分片以减少争用 & multi-link inode sets,sharded by inode to reduce contention
+            static const size_t     shard_count = 16;
+            std::mutex              inode_mutexes[shard_count];
+            std::set<std::pair<uint64_t,uint64_t>> inodes[shard_count];
+            std::mutex              mutex;
+            std::vector<TreeError>  errors;
+
+            _UsageContext(const DiskUsageOptions& options_,ThreadPool& pool_,int root_fd_,uint64_t root_dev_)
+            : options(options_),pool(pool_),root_fd(root_fd_),root_dev(root_dev_) {}
+
+            void Fail(const std::string& relative) {
+                int code = errno;
+                std::lock_guard<std::mutex> guard(mutex);
+                errors.push_back(TreeError{relative,code});
+            }
+
+            bool IsFirstLink(uint64_t dev,uint64_t inode) {
+                size_t shard = inode % shard_count;
+                std::lock_guard<std::mutex> guard(inode_mutexes[shard]);
+                return inodes[shard].emplace(dev,inode).second;
+            }
+
+            void Add(DiskUsage& local) {
+                apparent_size.fetch_add(local.apparent_size,std::memory_order_relaxed);
+                uint64_t allocated = allocated_size.fetch_add(local.allocated_size,std::memory_order_relaxed) + local.allocated_size;
+                files.fetch_add(local.files,std::memory_order_relaxed);
+                dirs.fetch_add(local.dirs,std::memory_order_relaxed);
+                symlinks.fetch_add(local.symlinks,std::memory_order_relaxed);
+                hardlinks.fetch_add(local.hardlinks,std::memory_order_relaxed);
+                if(options.limit > 0 && allocated >= options.limit) is_limit_reached.store(true,std::memory_order_relaxed);
+                local = DiskUsage();
+            }
+        };
+
+        bool _usage_stat(int dir_fd,const char* name,struct statx& stx) {
+            unsigned int mask = STATX_TYPE | STATX_SIZE | STATX_BLOCKS | STATX_NLINK | STATX_INO;
+            return statx(dir_fd,name,AT_SYMLINK_NOFOLLOW | AT_STATX_DONT_SYNC,mask,&stx) == 0;
+        }
+
+        uint64_t _usage_dev(const struct statx& stx) {
+            return (static_cast<uint64_t>(stx.stx_dev_major) << 32) | stx.stx_dev_minor;
+        }
+
+        void _usage_dir(_UsageContext& context,std::shared_ptr<_DirHandle> parent,const std::string& dir_name,const std::string& relative) {
+            if(context.is_limit_reached.load(std::memory_order_relaxed)) return;
+            // 相对父目录fd逐级打开,不重复解析整条路径 & open level by level from the parent fd instead of re-resolving the whole path
+            int flags = O_RDONLY | O_DIRECTORY | O_CLOEXEC | O_NOFOLLOW;
+            int fd = parent ? openat(parent->fd,dir_name.c_str(),flags) : dup(context.root_fd);
+            parent.reset();
+            if(fd < 0) {
+                context.Fail(relative);
+                return;
+            }
+            auto handle = std::make_shared<_DirHandle>(fd);
+            // 先在本地累计,定期合并,大目录也能及时触发limit & accumulate locally and merge periodically,so limit triggers in time even in huge dirs
+            const uint64_t merge_interval = 1024;
+            DiskUsage local;
+            uint64_t pending = 0;
+            bool ret = _read_dir(fd,[&](const char* name,unsigned char) {
+                if(context.is_limit_reached.load(std::memory_order_relaxed)) return;
+                struct statx stx{};
+                if(!_usage_stat(fd,name,stx)) {
+                    context.Fail(relative.empty() ? name : relative + "/" + name);
+                    return;
+                }
+                if(S_ISDIR(stx.stx_mode)) {
+                    if(context.options.is_one_filesystem && _usage_dev(stx) != context.root_dev) return;
+                    local.dirs++;
+                    std::string child = relative.empty() ? name : relative + "/" + name;
+                    std::string child_name(name);
+                    _UsageContext* context_ptr = &context;
+                    context.pool.Submit([context_ptr,handle,child_name,child] { _usage_dir(*context_ptr,handle,child_name,child); });
+                }else if(S_ISLNK(stx.stx_mode)) {
+                    local.symlinks++;
+                }else if(stx.stx_nlink > 1 && !context.IsFirstLink(_usage_dev(stx),stx.stx_ino)) {
+                    local.hardlinks++;
+                    return;
+                }else {
+                    local.files++;
+                }
+                local.apparent_size += stx.stx_size;
+                local.allocated_size += stx.stx_blocks * 512;
+                if(++pending % merge_interval == 0) context.Add(local);
+            });
+            if(!ret) context.Fail(relative);
+            context.Add(local);
+        }
+#elif _WIN32
+        void _usage_dir(const std::string& path,DiskUsage& usage,const DiskUsageOptions& options,std::vector<TreeError>& collected) {
+            _finddata_t file_data;
+            intptr_t handle = _findfirst((path + "\\*").c_str(),&file_data);
+            if(handle == -1L) {
+                collected.push_back(TreeError{path,errno});
+                return;
+            }
+            do {
+                if(strcmp(file_data.name,".") == 0 || strcmp(file_data.name,"..") == 0) continue;
+                if(options.limit > 0 && usage.allocated_size >= options.limit) {
+                    usage.is_limit_reached = true;
+                    break;
+                }
+                // _findfirst不提供分配大小,以表观大小代替 & _findfirst doesn't report allocation,apparent size stands in
+                if(file_data.attrib & _A_SUBDIR) {
+                    usage.dirs++;
+                    _usage_dir(path + "/" + file_data.name,usage,options,collected);
+                }else {
+                    usage.files++;
+                    usage.apparent_size += file_data.size;
+                    usage.allocated_size += file_data.size;
+                }
+            }while(_findnext(handle,&file_data) == 0);
+            _findclose(handle);
+        }
+#endif
+
+        bool disk_usage(const std::string& path,DiskUsage& usage,const DiskUsageOptions& options,std::vector<TreeError>* errors) {
+            usage = DiskUsage();
+            std::vector<TreeError> collected;
+#ifdef __linux__
+            struct statx stx{};
+            if(!_usage_stat(AT_FDCWD,path.c_str(),stx)) {
+                MOLE_ERROR(io_filesystem_channel,strerror(errno),{ MOLE_VAR(path) });
+                if(errors) errors->push_back(TreeError{path,errno});
+                return false;
+            }
+            usage.apparent_size = stx.stx_size;
+            usage.allocated_size = stx.stx_blocks * 512;
+            if(!S_ISDIR(stx.stx_mode)) {
+                if(S_ISLNK(stx.stx_mode)) usage.symlinks = 1;
+                else usage.files = 1;
+                return true;
+            }
+            usage.dirs = 1;
+            int root_fd = open(path.c_str(),O_RDONLY | O_DIRECTORY | O_CLOEXEC | O_NOFOLLOW);
+            if(root_fd < 0) {
+                MOLE_ERROR(io_filesystem_channel,strerror(errno),{ MOLE_VAR(path) });
+                if(errors) errors->push_back(TreeError{path,errno});
+                return false;
+            }
+            {
+                ThreadPool pool(options.threads);
+                _UsageContext context(options,pool,root_fd,_usage_dev(stx));
+                context.Add(usage);
+                _UsageContext* context_ptr = &context;
+                pool.Submit([context_ptr] { _usage_dir(*context_ptr,nullptr,std::string(),std::string()); });
+                pool.Wait();
+                usage.apparent_size = context.apparent_size.load();
+                usage.allocated_size = context.allocated_size.load();
+                usage.files = context.files.load();
+                usage.dirs = context.dirs.load();
+                usage.symlinks = context.symlinks.load();
+                usage.hardlinks = context.hardlinks.load();
+                usage.is_limit_reached = context.is_limit_reached.load();
+                collected.swap(context.errors);
+            }
+            close(root_fd);
+            for(auto& error : collected) error.path = error.path.empty() ? path : path + "/" + error.path;
+            return _tree_report("disk_usage failed",collected,errors);
+#elif _WIN32
+            if(!is_directory(path)) {
+                long long size = fsize(path);
+                if(size < 0) return false;
+                usage.files = 1;
+                usage.apparent_size = usage.allocated_size = static_cast<uint64_t>(size);
+                return true;
+            }
+            usage.dirs = 1;
+            _usage_dir(path,usage,options,collected);
+            if(errors) errors->insert(errors->end(),collected.begin(),collected.end());
+            return collected.empty();
+#endif
+        }
+
+        // 编译后的单段模式 & compiled single segment pattern
+        struct _GlobSegment {
+            enum Kind : uint8_t { CHAR,ANY,STAR,CLASS };
+            struct Token {
+                Kind            kind;
+                unsigned char   ch;
+                uint32_t        class_index;
+            };
+            // "**",匹配零或多级 & "**",matches zero or more levels
+            bool                            is_recursive{false};
+            // 无通配符,可直接stat & no wildcard,can be stat'ed directly
+            bool                            is_literal{true};
+            std::string                     literal;
+            std::vector<Token>              tokens;
+            std::vector<std::bitset<256>>   classes;
+
+            void Compile(const std::string& pattern) {
+                for(size_t i = 0; i < pattern.size(); i++) {
+                    auto ch = static_cast<unsigned char>(pattern[i]);
+                    if(ch == '\\' && i + 1 < pattern.size()) {
+                        ch = static_cast<unsigned char>(pattern[++i]);
+                    }else if(ch == '*') {
+                        is_literal = false;
+                        if(tokens.empty() || tokens.back().kind != STAR) tokens.push_back(Token{STAR,0,0});
+                        continue;
+                    }else if(ch == '?') {
+                        is_literal = false;
+                        tokens.push_back(Token{ANY,0,0});
+                        continue;
+                    }else if(ch == '[' && compileClass_(pattern,i)) {
+                        is_literal = false;
+                        continue;
+                    }
+                    literal.push_back(static_cast<char>(ch));
+                    tokens.push_back(Token{CHAR,ch,0});
+                }
+            }
+
+            bool Match(const char* name,size_t length) const {
+                if(is_literal) return literal.size() == length && memcmp(literal.data(),name,length) == 0;
+                // 贪心匹配,失配时回溯到最近的'*' & greedy match,backtrack to the latest '*' on mismatch
+                size_t token = 0,cursor = 0,star_token = SIZE_MAX,star_cursor = 0;
+                while(cursor < length) {
+                    if(token < tokens.size() && tokens[token].kind == STAR) {
+                        star_token = token++;
+                        star_cursor = cursor;
+                        continue;
+                    }
+                    if(token < tokens.size() && matchOne_(tokens[token],static_cast<unsigned char>(name[cursor]))) {
+                        token++;
+                        cursor++;
+                        continue;
+                    }
+                    if(star_token == SIZE_MAX) return false;
+                    token = star_token + 1;
+                    cursor = ++star_cursor;
+                }
+                while(token < tokens.size() && tokens[token].kind == STAR) token++;
+                return token == tokens.size();
+            }
+
+        private:
+            // 解析[...],未闭合时按字面量处理 & parse [...],treated as literal when unclosed
+            bool compileClass_(const std::string& pattern,size_t& index) {
+                size_t cursor = index + 1;
+                bool is_negate = cursor < pattern.size() && (pattern[cursor] == '!' || pattern[cursor] == '^');
+                if(is_negate) cursor++;
+                std::bitset<256> set;
+                bool is_first = true;
+                while(cursor < pattern.size() && (pattern[cursor] != ']' || is_first)) {
+                    auto low = static_cast<unsigned char>(pattern[cursor]);
+                    auto high = low;
+                    if(cursor + 2 < pattern.size() && pattern[cursor + 1] == '-' && pattern[cursor + 2] != ']') {
+                        high = static_cast<unsigned char>(pattern[cursor + 2]);
+                        cursor += 2;
+                    }
+                    for(unsigned int ch = low; ch <= high; ch++) set.set(ch);
+                    cursor++;
+                    is_first = false;
+                }
+                if(cursor >= pattern.size()) return false;
+                if(is_negate) set.flip();
+                tokens.push_back(Token{CLASS,0,static_cast<uint32_t>(classes.size())});
+                classes.push_back(set);
+                index = cursor;
+                return true;
+            }
+
+            bool matchOne_(const Token& token,unsigned char ch) const {
+                switch(token.kind) {
+                    case CHAR: return token.ch == ch;
+                    case ANY: return true;
+                    case CLASS: return classes[token.class_index].test(ch);
+                    default: return false;
+                }
+            }
+        };
+
+        // 按段编译的路径模式,匹配状态为段下标的位集 & path pattern compiled per segment,match state is a bitset of segment indices
+        struct _GlobPattern {
+            // 最多段数,接受状态占用最后一位 & max segments,accept state takes the last bit
+            static const size_t             max_segments = 63;
+            std::vector<_GlobSegment>       segments;
+
+            bool Compile(const std::string& pattern) {
+                size_t begin = 0;
+                while(begin <= pattern.size()) {
+                    size_t end = pattern.find('/',begin);
+                    if(end == std::string::npos) end = pattern.size();
+                    std::string part = pattern.substr(begin,end - begin);
+                    begin = end + 1;
+                    if(part.empty() || part == ".") continue;
+                    _GlobSegment segment;
+                    if(part == "**") {
+                        // 连续的"**"等价于一个 & consecutive "**" equal one
+                        if(!segments.empty() && segments.back().is_recursive) continue;
+                        segment.is_recursive = true;
+                        segment.is_literal = false;
+                    }else {
+                        segment.Compile(part);
+                    }
+                    segments.push_back(std::move(segment));
+                }
+                return !segments.empty() && segments.size() <= max_segments;
+            }
+
+            inline uint64_t Accept() const { return 1ULL << segments.size(); }
+
+            // "**"可匹配零级,使下一段同时生效 & "**" may match zero levels,activating the next segment too
+            uint64_t Closure(uint64_t states) const {
+                for(size_t i = 0; i < segments.size(); i++) {
+                    if((states >> i & 1) && segments[i].is_recursive) states |= 1ULL << (i + 1);
+                }
+                return states;
+            }
+
+            uint64_t Step(uint64_t states,const char* name,size_t length) const {
+                uint64_t next = 0;
+                for(size_t i = 0; i < segments.size(); i++) {
+                    if(!(states >> i & 1)) continue;
+                    if(segments[i].is_recursive) next |= 1ULL << i;
+                    else if(segments[i].Match(name,length)) next |= 1ULL << (i + 1);
+                }
+                return Closure(next);
+            }
+
+            // 活跃状态是否全为字面量段 & whether all active states are literal segments
+            bool IsLiteral(uint64_t states) const {
+                for(size_t i = 0; i < segments.size(); i++) {
+                    if((states >> i & 1) && !segments[i].is_literal) return false;
+                }
+                return true;
+            }
+        };
+
+        bool match_name(const std::string& pattern,const std::string& name) {
+            _GlobSegment segment;
+            segment.Compile(pattern);
+            return segment.Match(name.data(),name.size());
+        }
+
+        bool _glob_filter(const GlobOptions& options,EntryType type,int64_t size,int64_t mtime_ns) {
+            if(options.is_files_only && type != EntryType::FILE) return false;
+            if(options.min_size >= 0 && size < options.min_size) return false;
+            if(options.max_size >= 0 && size > options.max_size) return false;
+            if(options.min_mtime_ns != 0 && mtime_ns < options.min_mtime_ns) return false;
+            if(options.max_mtime_ns != 0 && mtime_ns > options.max_mtime_ns) return false;
+            return true;
+        }
+
+        inline bool _glob_need_stat(const GlobOptions& options) {
+            return options.min_size >= 0 || options.max_size >= 0 || options.min_mtime_ns != 0 || options.max_mtime_ns != 0;
+        }
+
+#ifdef __linux__
+        struct _GlobContext {
+            const _GlobPattern&         pattern;
+            const GlobOptions&          options;
+            int                         root_fd;
+            std::string                 root;
+            ThreadPool&                 pool;
+            std::mutex                  mutex;
+            std::vector<std::string>&   results;
+            std::atomic<bool>           is_failed{false};
+
+            _GlobContext(const _GlobPattern& pattern_,const GlobOptions& options_,int root_fd_,std::string root_,ThreadPool& pool_,std::vector<std::string>& results_)
+            : pattern(pattern_),options(options_),root_fd(root_fd_),root(std::move(root_)),pool(pool_),results(results_) {}
+        };
+
+        void _glob_dir(_GlobContext& context,std::shared_ptr<_DirHandle> parent,const std::string& dir_name,const std::string& relative,uint64_t states) {
+            // 相对父目录fd逐级打开,路径中途被换成符号链接也不会被跟随 & open level by level from the parent fd,so a path component swapped for a symlink midway isn't followed
+            int flags = O_RDONLY | O_DIRECTORY | O_CLOEXEC | O_NOFOLLOW;
+            int fd = parent ? openat(parent->fd,dir_name.c_str(),flags) : dup(context.root_fd);
+            parent.reset();
+            if(fd < 0) {
+                MOLE_WARN(io_filesystem_channel,strerror(errno),{ MOLE_VAR(relative) });
+                context.is_failed.store(true,std::memory_order_relaxed);
+                return;
+            }
+            auto handle = std::make_shared<_DirHandle>(fd);
+            std::vector<std::string> matched;
+            auto visit = [&](const char* name,unsigned char type) {
+                uint64_t next = context.pattern.Step(states,name,strlen(name));
+                if(next == 0) return;
+                std::string child = relative.empty() ? name : relative + "/" + name;
+                if((next & context.pattern.Accept()) != 0) {
+                    EntryType entry_type = type == DT_DIR ? EntryType::DIRECTORY : type == DT_REG ? EntryType::FILE : type == DT_LNK ? EntryType::SYMLINK : EntryType::OTHER;
+                    struct statx stx{};
+                    bool is_match = true;
+                    if(_glob_need_stat(context.options)) {
+                        is_match = statx(fd,name,AT_SYMLINK_NOFOLLOW | AT_STATX_DONT_SYNC,STATX_SIZE | STATX_MTIME,&stx) == 0;
+                    }
+                    int64_t mtime_ns = static_cast<int64_t>(stx.stx_mtime.tv_sec) * 1000000000 + stx.stx_mtime.tv_nsec;
+                    if(is_match && _glob_filter(context.options,entry_type,static_cast<int64_t>(stx.stx_size),mtime_ns)) matched.push_back(context.root + "/" + child);
+                }
+                // 仍有未完成的段才进入子目录 & descend only while some segment remains unmatched
+                if(type == DT_DIR && (next & ~context.pattern.Accept()) != 0) {
+                    std::string child_name(name);
+                    _GlobContext* context_ptr = &context;
+                    context.pool.Submit([context_ptr,handle,child_name,child,next] { _glob_dir(*context_ptr,handle,child_name,child,next); });
+                }
+            };
+            bool ret = true;
+            if(context.pattern.IsLiteral(states)) {
+                // 字面量段不必列目录 & literal segments need no listing
+                std::set<std::string> names;
+                for(size_t i = 0; i < context.pattern.segments.size(); i++) {
+                    if(states >> i & 1) names.insert(context.pattern.segments[i].literal);
+                }
+                for(auto& name : names) {
+                    struct stat st{};
+                    if(fstatat(fd,name.c_str(),&st,AT_SYMLINK_NOFOLLOW) != 0) continue;
+                    visit(name.c_str(),S_ISDIR(st.st_mode) ? DT_DIR : S_ISREG(st.st_mode) ? DT_REG : S_ISLNK(st.st_mode) ? DT_LNK : DT_UNKNOWN);
+                }
+            }else {
+                ret = _read_dir(fd,visit);
+            }
+            if(!ret) {
+                MOLE_WARN(io_filesystem_channel,strerror(errno),{ MOLE_VAR(relative) });
+                context.is_failed.store(true,std::memory_order_relaxed);
+            }
+            handle.reset();
+            if(matched.empty()) return;
+            std::lock_guard<std::mutex> guard(context.mutex);
+            context.results.insert(context.results.end(),matched.begin(),matched.end());
+        }
+#elif _WIN32
+        bool _glob_dir(const _GlobPattern& pattern,const GlobOptions& options,const std::string& path,uint64_t states,std::vector<std::string>& results) {
+            _finddata_t file_data;
+            intptr_t handle = _findfirst((path + "\\*").c_str(),&file_data);
+            if(handle == -1L) {
+                MOLE_WARN(io_filesystem_channel,"can't match path",{ MOLE_VAR(path) });
+                return false;
+            }
+            bool ret = true;
+            do {
+                if(strcmp(file_data.name,".") == 0 || strcmp(file_data.name,"..") == 0) continue;
+                uint64_t next = pattern.Step(states,file_data.name,strlen(file_data.name));
+                if(next == 0) continue;
+                bool is_dir = (file_data.attrib & _A_SUBDIR) != 0;
+                std::string child = path + "/" + file_data.name;
+                int64_t mtime_ns = static_cast<int64_t>(file_data.time_write) * 1000000000;
+                if((next & pattern.Accept()) != 0 && _glob_filter(options,is_dir ? EntryType::DIRECTORY : EntryType::FILE,file_data.size,mtime_ns)) results.push_back(child);
+                if(is_dir && (next & ~pattern.Accept()) != 0) ret = _glob_dir(pattern,options,child,next,results) && ret;
+            }while(_findnext(handle,&file_data) == 0);
+            _findclose(handle);
+            return ret;
+        }
+#endif
+
+        bool glob(const std::string& root,const std::string& pattern,std::vector<std::string>& results,const GlobOptions& options) {
+            results.clear();
+            _GlobPattern compiled;
+            if(!compiled.Compile(pattern)) {
+                MOLE_ERROR(io_filesystem_channel,"invalid glob pattern",{ MOLE_VAR(pattern) });
+                return false;
+            }
+            std::string processed_root = root;
+            while(processed_root.size() > 1 && (processed_root.back() == '/' || processed_root.back() == '\\')) processed_root.pop_back();
+            uint64_t states = compiled.Closure(1);
+            bool ret;
+#ifdef __linux__
+            int root_fd = open(processed_root.c_str(),O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            if(root_fd < 0) {
+                MOLE_ERROR(io_filesystem_channel,strerror(errno),{ MOLE_VAR(root) });
+                return false;
+            }
+            if(processed_root == "/") processed_root.clear();
+            {
+                ThreadPool pool(options.threads);
+                _GlobContext context(compiled,options,root_fd,processed_root,pool,results);
+                _GlobContext* context_ptr = &context;
+                pool.Submit([context_ptr,states] { _glob_dir(*context_ptr,nullptr,std::string(),std::string(),states); });
+                pool.Wait();
+                ret = !context.is_failed.load();
+            }
+            close(root_fd);
+#elif _WIN32
+            if(!is_directory(processed_root)) return false;
+            ret = _glob_dir(compiled,options,processed_root,states,results);
+#endif
+            std::sort(results.begin(),results.end());
+            return ret;
+        }
+
+        DirEntry& DirListing::Append(const char* name,size_t length,EntryType type) {
+            DirEntry entry{};
+            entry.name_offset = static_cast<uint32_t>(names.size());
+            entry.name_length = static_cast<uint32_t>(length);
+            entry.type = type;
+            names.insert(names.end(),name,name + length);
+            names.push_back('\0');
+            entries.push_back(entry);
+            return entries.back();
+        }
+
+        void DirListing::Clear() {
+            entries.clear();
+            names.clear();
+        }
+
+        bool listdir(const std::string& path,DirListing& listing,uint32_t stat_mask) {
+            listing.Clear();
+#ifdef __linux__
+            int fd = open(path.c_str(),O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            if(fd < 0) {
+                MOLE_ERROR(io_filesystem_channel,strerror(errno),{ MOLE_VAR(path) });
+                return false;
+            }
+            unsigned int statx_mask = 0;
+            if(stat_mask & DIR_STAT_SIZE) statx_mask |= STATX_SIZE;
+            if(stat_mask & DIR_STAT_MTIME) statx_mask |= STATX_MTIME;
+            if(stat_mask & DIR_STAT_INODE) statx_mask |= STATX_INO;
+            bool ret = _read_dir(fd,[&](const char* name,unsigned char type) {
+                auto& entry = listing.Append(name,strlen(name),type == DT_DIR ? EntryType::DIRECTORY : type == DT_REG ? EntryType::FILE : type == DT_LNK ? EntryType::SYMLINK : EntryType::OTHER);
+                if(!statx_mask) return;
+                // 只请求需要的字段,网络文件系统可据此跳过同步 & request only needed fields,network filesystems may skip sync
+                struct statx stx{};
+                if(statx(fd,name,AT_SYMLINK_NOFOLLOW | AT_STATX_DONT_SYNC,statx_mask,&stx) != 0) {
+                    MOLE_WARN(io_filesystem_channel,strerror(errno),{ MOLE_VAR(path) });
+                    return;
+                }
+                entry.size = stx.stx_size;
+                entry.mtime_ns = static_cast<int64_t>(stx.stx_mtime.tv_sec) * 1000000000 + stx.stx_mtime.tv_nsec;
+                entry.inode = stx.stx_ino;
+            });
+            if(!ret) MOLE_ERROR(io_filesystem_channel,strerror(errno),{ MOLE_VAR(path) });
+            close(fd);
+            return ret;
+#elif _WIN32
+            _finddata_t file_data;
+            intptr_t handle = _findfirst((path + "\\*").c_str(),&file_data);
+            if(handle == -1L) {
+                MOLE_ERROR(io_filesystem_channel,"can't match path",{ MOLE_VAR(path) });
+                return false;
+            }
+            do {
+                if(strcmp(file_data.name,".") == 0 || strcmp(file_data.name,"..") == 0) continue;
+                auto& entry = listing.Append(file_data.name,strlen(file_data.name),(file_data.attrib & _A_SUBDIR) ? EntryType::DIRECTORY : EntryType::FILE);
+                // _findfirst已带回大小与时间,无需额外查询 & _findfirst already returns size and time,no extra query needed
+                entry.size = file_data.size;
+                entry.mtime_ns = static_cast<int64_t>(file_data.time_write) * 1000000000;
+            }while(_findnext(handle,&file_data) == 0);
+            _findclose(handle);
+            return true;
+#endif
+        }
+
+        void _stat_one(const std::string& path,StatResult& result,uint32_t stat_mask) {
+            result = StatResult{};
+#ifdef __linux__
+            unsigned int statx_mask = STATX_TYPE | STATX_MODE;
+            if(stat_mask & DIR_STAT_SIZE) statx_mask |= STATX_SIZE;
+            if(stat_mask & DIR_STAT_MTIME) statx_mask |= STATX_MTIME;
+            if(stat_mask & DIR_STAT_INODE) statx_mask |= STATX_INO;
+            struct statx stx{};
+            if(statx(AT_FDCWD,path.c_str(),AT_SYMLINK_NOFOLLOW | AT_STATX_DONT_SYNC,statx_mask,&stx) != 0) {
+                result.error = errno;
+                return;
+            }
+            result.type = S_ISDIR(stx.stx_mode) ? EntryType::DIRECTORY : S_ISREG(stx.stx_mode) ? EntryType::FILE : S_ISLNK(stx.stx_mode) ? EntryType::SYMLINK : EntryType::OTHER;
+            result.mode = stx.stx_mode & 07777;
+            result.size = stx.stx_size;
+            result.mtime_ns = static_cast<int64_t>(stx.stx_mtime.tv_sec) * 1000000000 + stx.stx_mtime.tv_nsec;
+            result.inode = stx.stx_ino;
+#elif _WIN32
+            struct stat st{};
+            if(stat(path.c_str(),&st) != 0) {
+                result.error = errno;
+                return;
+            }
+            result.type = (st.st_mode & S_IFDIR) ? EntryType::DIRECTORY : EntryType::FILE;
+            result.mode = st.st_mode & 0777;
+            result.size = st.st_size;
+            result.mtime_ns = static_cast<int64_t>(st.st_mtime) * 1000000000;
+            result.inode = st.st_ino;
+#endif
+        }
+
+        bool stat_batch(const std::vector<std::string>& paths,std::vector<StatResult>& results,uint32_t stat_mask,size_t threads) {
+            results.resize(paths.size());
+            // 小批量时建线程的开销大于收益 & for small batches spawning threads costs more than it saves
+            const size_t inline_limit = 64;
+            const size_t chunk_size = 256;
+            if(paths.size() <= inline_limit || threads == 1) {
+                for(size_t i = 0; i < paths.size(); i++) _stat_one(paths[i],results[i],stat_mask);
+            }else {
+                ThreadPool pool(threads);
+                for(size_t begin = 0; begin < paths.size(); begin += chunk_size) {
+                    size_t end = std::min(begin + chunk_size,paths.size());
+                    pool.Submit([&paths,&results,stat_mask,begin,end] {
+                        for(size_t i = begin; i < end; i++) _stat_one(paths[i],results[i],stat_mask);
+                    });
+                }
+                pool.Wait();
+            }
+            for(auto& result : results) {
+                if(result.error != 0) return false;
+            }
             return true;
         }
     }
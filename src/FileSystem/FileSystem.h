@@ -10,6 +10,8 @@
 #ifndef IO_UTILS_FILESYSTEM_H
 #define IO_UTILS_FILESYSTEM_H
 
+#include <cstdint>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -17,6 +19,202 @@ namespace hzd {
 
     namespace filesystem {
 
+        // 文件数据区段
+        // file data extent
+        struct Extent {
+            // C++11下成员默认值使其不再是聚合类型,需显式构造函数支持Extent{offset,length} & under C++11 member initializers make it a non-aggregate,so Extent{offset,length} needs an explicit constructor
+            Extent() = default;
+            Extent(uint64_t offset_,uint64_t length_) : offset(offset_),length(length_) {}
+            // 起始偏移 & start offset
+            uint64_t    offset{0};
+            // 长度 & length
+            uint64_t    length{0};
+        };
+
+        // 文件系统空间信息,单位字节
+        // filesystem space info,in bytes
+        struct SpaceInfo {
+            // 总容量 & total capacity
+            uint64_t    capacity;
+            // 空闲空间,含保留块 & free space,including reserved blocks
+            uint64_t    free;
+            // 非特权用户可用空间 & space available to unprivileged users
+            uint64_t    available;
+        };
+
+        // 目录项类型
+        // directory entry type
+        enum class EntryType {
+            FILE,
+            DIRECTORY,
+            SYMLINK,
+            OTHER
+        };
+
+        // 遍历得到的目录项
+        // entry delivered by walk
+        struct WalkEntry {
+            // 路径,以遍历根为前缀 & path,prefixed with walk root
+            std::string     path;
+            // 类型,跟随符号链接时为目标类型 & type,target type when following symlinks
+            EntryType       type;
+            // 深度,根的直接子项为1 & depth,1 for direct children of root
+            int             depth;
+        };
+
+        // 遍历配置
+        // walk options
+        struct WalkOptions {
+            // 线程数,0表示硬件并发数 & thread count,0 for hardware concurrency
+            size_t          threads{0};
+            // 最大深度,-1表示不限 & max depth,-1 for unlimited
+            int             max_depth{-1};
+            // 是否跟随指向目录的符号链接,按(设备,inode)去重,每个目录只进入一次,可避免成环 & whether follow symlinks to dirs,deduplicated by (device,inode) so each dir is entered once and cycles terminate
+            bool            is_follow_symlink{false};
+        };
+
+        // 目录项附加属性掩码
+        // directory entry extra attribute mask
+        enum DirStatMask : uint32_t {
+            DIR_STAT_NONE   = 0,
+            DIR_STAT_SIZE   = 1 << 0,
+            DIR_STAT_MTIME  = 1 << 1,
+            DIR_STAT_INODE  = 1 << 2
+        };
+
+        // 紧凑目录项,名字存放于DirListing的字符串表中
+        // compact directory entry,name stored in string table of DirListing
+        struct DirEntry {
+            // 名字在字符串表中的偏移 & name offset in string table
+            uint32_t        name_offset;
+            // 名字长度 & name length
+            uint32_t        name_length;
+            // 类型,取自d_type & type,taken from d_type
+            EntryType       type;
+            // 文件大小,需DIR_STAT_SIZE & file size,needs DIR_STAT_SIZE
+            uint64_t        size;
+            // 修改时间(ns),需DIR_STAT_MTIME & modify time (ns),needs DIR_STAT_MTIME
+            int64_t         mtime_ns;
+            // inode编号,需DIR_STAT_INODE & inode number,needs DIR_STAT_INODE
+            uint64_t        inode;
+        };
+
+        // 批量stat的单项结果
+        // single result of batch stat
+        struct StatResult {
+            // 0表示成功,否则为errno & 0 for success,errno otherwise
+            int             error;
+            // 类型 & type
+            EntryType       type;
+            // 权限位 & permission bits
+            uint32_t        mode;
+            // 文件大小,需DIR_STAT_SIZE & file size,needs DIR_STAT_SIZE
+            uint64_t        size;
+            // 修改时间(ns),需DIR_STAT_MTIME & modify time (ns),needs DIR_STAT_MTIME
+            int64_t         mtime_ns;
+            // inode编号,需DIR_STAT_INODE & inode number,needs DIR_STAT_INODE
+            uint64_t        inode;
+        };
+
+        // 目录列表,所有名字连续存放在一块以'\0'分隔的内存中
+        // directory listing,all names stored contiguously in one '\0' separated block
+        class DirListing {
+        public:
+            inline size_t Size() const { return entries.size(); }
+            inline bool Empty() const { return entries.empty(); }
+            inline const DirEntry& operator[](size_t index) const { return entries[index]; }
+            inline std::vector<DirEntry>::const_iterator begin() const { return entries.begin(); }
+            inline std::vector<DirEntry>::const_iterator end() const { return entries.end(); }
+            /**
+             * 目录项名字,以'\0'结尾 & entry name,'\0' terminated
+             */
+            inline const char* Name(size_t index) const { return names.data() + entries[index].name_offset; }
+            inline const char* Name(const DirEntry& entry) const { return names.data() + entry.name_offset; }
+            /**
+             * 追加目录项 & append entry
+             * @param name 名字 & name
+             * @param length 名字长度 & name length
+             * @param type 类型 & type
+             * @return 新目录项 & new entry
+             */
+            DirEntry& Append(const char* name,size_t length,EntryType type);
+            /**
+             * 清空并保留容量 & clear and keep capacity
+             */
+            void Clear();
+        private:
+            std::vector<DirEntry>   entries;
+            std::vector<char>       names;
+        };
+
+        // 目录树操作配置
+        // tree operation options
+        struct TreeOptions {
+            // 并行度,0表示硬件并发数 & parallelism,0 for hardware concurrency
+            size_t          threads{0};
+            // 是否覆盖目标中已存在的文件 & whether overwrite existing files in destination
+            bool            is_overwrite{false};
+            // 是否保留访问与修改时间 & whether preserve access and modify time
+            bool            is_preserve_time{true};
+        };
+
+        // 目录树操作中的单个错误
+        // single error of tree operation
+        struct TreeError {
+            // 出错路径 & failed path
+            std::string     path;
+            // 错误码(errno) & error code (errno)
+            int             code;
+        };
+
+        // 磁盘占用统计配置
+        // disk usage options
+        struct DiskUsageOptions {
+            // 线程数,0表示硬件并发数 & thread count,0 for hardware concurrency
+            size_t          threads{0};
+            // 占用空间达到该值即停止扫描,0表示不限 & stop scanning once allocated bytes reach it,0 for unlimited
+            uint64_t        limit{0};
+            // 是否不跨越文件系统(挂载点) & whether stay on one filesystem (skip mount points)
+            bool            is_one_filesystem{false};
+        };
+
+        // 目录树统计结果
+        // tree statistics
+        struct DiskUsage {
+            // 表观大小(st_size之和) & apparent size (sum of st_size)
+            uint64_t        apparent_size{0};
+            // 实际分配的字节数(st_blocks * 512) & allocated bytes (st_blocks * 512)
+            uint64_t        allocated_size{0};
+            // 文件数,硬链接只计一次 & file count,hard links counted once
+            uint64_t        files{0};
+            // 目录数,含根目录 & dir count,including root
+            uint64_t        dirs{0};
+            // 符号链接数 & symlink count
+            uint64_t        symlinks{0};
+            // 因与已统计inode相同而跳过的硬链接数 & hard links skipped as duplicates of a counted inode
+            uint64_t        hardlinks{0};
+            // 是否因达到limit提前停止,此时各项为部分结果 & whether stopped early at limit,fields are partial then
+            bool            is_limit_reached{false};
+        };
+
+        // glob匹配配置,谓词只作用于匹配到的项
+        // glob options,predicates apply to matched entries only
+        struct GlobOptions {
+            // 线程数,0表示硬件并发数 & thread count,0 for hardware concurrency
+            size_t          threads{0};
+            // 是否只返回普通文件 & whether return regular files only
+            bool            is_files_only{false};
+            // 文件大小下限与上限(含),-1表示不限 & min and max file size (inclusive),-1 for unlimited
+            int64_t         min_size{-1};
+            int64_t         max_size{-1};
+            // 修改时间(ns)下限与上限(含),0表示不限 & min and max modify time (ns,inclusive),0 for unlimited
+            int64_t         min_mtime_ns{0};
+            int64_t         max_mtime_ns{0};
+        };
+
+        // 遍历回调,可能被多个线程并发调用,对目录返回false表示不进入 & walk callback,may be called concurrently,return false on a dir to skip it
+        using WalkCallback = std::function<bool(const WalkEntry&)>;
+
         /**
          * 判断是否存在文件或目录
          * @return true表示存在,false表示不存在 & true for exist,false for not exist
@@ -38,12 +236,61 @@ namespace hzd {
 
         /**
          * 复制源文件到目标路径下 & copy src file to destination path
-         * @brief 只用当文件或目录真实存在时才会成功 & only success when file or dir exist
+         * @brief 只用当文件或目录真实存在时才会成功,依次尝试reflink、copy_file_range、sendfile与大缓冲读写,并保留权限 & only success when file or dir exist,tries reflink,copy_file_range,sendfile then large-buffer read/write,permissions preserved
          * @param src_path 源路径 & source path
          * @param dest_path 目标路径 & destination path
+         * @param is_overwrite 是否覆盖已存在文件 & whether overwrite existing file
+         * @param is_preserve_time 是否保留访问与修改时间 & whether preserve access and modify time
+         * @return true表示成功,false表示失败 & true for success,false for failed
+         */
+        bool copy(const std::string &src_path, const std::string &dest_path, bool is_overwrite = false, bool is_preserve_time = false);
+
+        /**
+         * 获取文件的数据区段(跳过空洞) & get data extents of file (holes skipped)
+         * @brief 不支持SEEK_DATA的平台或文件系统返回覆盖整个文件的单个区段 & a single whole-file extent is returned where SEEK_DATA is unsupported
+         * @param path 文件路径 & file path
+         * @param extents 数据区段 & data extents
+         * @param file_size 文件大小 & file size
          * @return true表示成功,false表示失败 & true for success,false for failed
          */
-        bool copy(const std::string &src_path, const std::string &dest_path, bool is_overwrite = false);
+        bool data_extents(const std::string& path,std::vector<Extent>& extents,uint64_t& file_size);
+
+        /**
+         * 为文件预分配磁盘空间,文件不存在时创建 & preallocate disk space for file,created when missing
+         * @brief 一次性分配得到连续区段,空间不足在写入前即失败 & allocating at once yields contiguous extents,and running out of space fails before writing
+         * @param path 文件路径 & file path
+         * @param offset 起始偏移 & start offset
+         * @param length 长度 & length
+         * @param is_keep_size 是否保持文件大小不变,false时文件扩展到offset+length & whether keep file size,file is extended to offset+length when false
+         * @return true表示成功,false表示失败 & true for success,false for failed
+         */
+        bool preallocate(const std::string& path,uint64_t offset,uint64_t length,bool is_keep_size = false);
+
+        /**
+         * 释放文件区间占用的磁盘空间,文件大小不变,该区间读为0 & free disk space of file range,file size unchanged,range reads as zeros
+         * @brief 需要文件系统支持,Windows下不支持 & needs filesystem support,not supported on windows
+         * @param path 文件路径 & file path
+         * @param offset 起始偏移 & start offset
+         * @param length 长度 & length
+         * @return true表示成功,false表示失败 & true for success,false for failed
+         */
+        bool punch_hole(const std::string& path,uint64_t offset,uint64_t length);
+
+        /**
+         * 截断或扩展文件到指定大小 & truncate or extend file to given size
+         * @param path 文件路径 & file path
+         * @param size 新大小 & new size
+         * @return true表示成功,false表示失败 & true for success,false for failed
+         */
+        bool truncate(const std::string& path,uint64_t size);
+
+        /**
+         * 查询路径所在文件系统的空间 & query space of the filesystem holding path
+         * @param path 路径 & path
+         * @param info 空间信息 & space info
+         * @return true表示成功,false表示失败 & true for success,false for failed
+         */
+        bool space(const std::string& path,SpaceInfo& info);
 
         /**
          * 获取当前工作目录的绝对路径 & get current work dir absolute path
@@ -73,10 +320,13 @@ namespace hzd {
 
         /**
          * 移动文件或重命名 & move file or directory,or rename
-         * @brief 只用当文件或目录真实存在时才会成功 & only success when file or dir exist
+         * @brief 只用当文件或目录真实存在时才会成功,同一文件系统上为rename,跨设备时复制后删除源 & only success when file or dir exist,rename on the same filesystem,copy then remove source across devices
+         * @param src_path 源路径 & source path
+         * @param dest_path 目标路径,为已存在目录时移入其中 & destination path,moved into it when it is an existing dir
+         * @param is_overwrite 是否覆盖已存在目标 & whether overwrite existing destination
          * @return true表示成功,false表示失败 & true for success,false for failed
          */
-        bool move(const std::string &src_path, const std::string &dest_path);
+        bool move(const std::string &src_path, const std::string &dest_path, bool is_overwrite = false);
 
         /**
          * 重命名文件 & rename file
@@ -85,6 +335,48 @@ namespace hzd {
          */
         bool rename(const std::string& old_name,const std::string& new_name);
 
+        /**
+         * 原子替换写入文件 & atomically replace file content
+         * @brief 写临时文件,fdatasync,rename覆盖,再fsync所在目录,读者只会看到旧内容或完整的新内容 & write temp file,fdatasync,rename over,then fsync parent dir,readers see either old or complete new content
+         * @param path 文件路径 & file path
+         * @param data 数据 & data
+         * @param size 数据大小 & data size
+         * @param is_sync 是否落盘,false时只保证原子性不保证持久 & whether make durable,false keeps atomicity without durability
+         * @return true表示成功,false表示失败 & true for success,false for failed
+         */
+        bool atomic_write(const std::string& path,const char* data,size_t size,bool is_sync = true);
+        bool atomic_write(const std::string& path,const std::string& data,bool is_sync = true);
+
+        /**
+         * 将目录项的变化(新建,删除,rename)落盘 & make dir entry changes (create,delete,rename) durable
+         * @param path 目录路径 & dir path
+         * @return true表示成功,false表示失败 & true for success,false for failed
+         */
+        bool sync_dir(const std::string& path);
+
+        /**
+         * 同目录下的临时文件名,用于写后rename & temp file name in the same dir,for write then rename
+         * @param path 目标路径 & target path
+         * @return 临时文件路径 & temp file path
+         */
+        std::string temp_path(const std::string& path);
+
+        /**
+         * 创建用于替换目标的临时文件,目标已存在时继承其权限与属主 & create temp file to replace target,inheriting mode and owner of an existing target
+         * @brief rename覆盖后不会放宽0600等权限,无权chown时保留权限并告警 & rename over target won't widen modes like 0600,keeps mode and warns when chown is not permitted
+         * @param path 目标路径 & target path
+         * @param temp 生成的临时文件路径 & generated temp file path
+         * @return 可写的文件描述符,-1表示失败 & writable file descriptor,-1 for failed
+         */
+        int open_temp(const std::string& path,std::string& temp);
+
+        /**
+         * 所在目录 & parent dir
+         * @param path 路径 & path
+         * @return 所在目录,无目录部分时为"." & parent dir,"." when path has no dir part
+         */
+        std::string parent_dir(const std::string& path);
+
         /**
          * 列表目录下文件或目录名 & list files or dirs in path
          * @brief 只用当文件或目录真实存在时才会成功 & only success when file or dir exist
@@ -92,12 +384,95 @@ namespace hzd {
          */
         bool listdir(const std::string& path,std::vector<std::string>& dirs_name,std::vector<std::string>& files_name);
 
+        /**
+         * 列出目录下的紧凑目录项 & list compact entries in dir
+         * @brief 类型取自d_type,仅当stat_mask非空时对每项做一次statx & type taken from d_type,one statx per entry only when stat_mask is set
+         * @param path 目录路径 & dir path
+         * @param listing 目录列表,先被清空 & listing,cleared first
+         * @param stat_mask DirStatMask的组合 & combination of DirStatMask
+         * @return true表示成功,false表示失败 & true for success,false for failed
+         */
+        bool listdir(const std::string& path,DirListing& listing,uint32_t stat_mask = DIR_STAT_NONE);
+
+        /**
+         * 批量并行查询文件属性 & batch parallel query of file attributes
+         * @brief 在线程池上并发statx,逐项记录错误码而不打印日志,不跟随末端符号链接 & statx concurrently on a thread pool,per-path error codes instead of log lines,final symlinks not followed
+         * @param paths 路径列表 & path list
+         * @param results 结果,大小调整为paths.size()且一一对应 & results,resized to paths.size() and index-aligned
+         * @param stat_mask DirStatMask的组合,类型与权限总是返回 & combination of DirStatMask,type and mode always returned
+         * @param threads 线程数,0表示硬件并发数 & thread count,0 for hardware concurrency
+         * @return true表示全部成功,false表示有路径失败 & true for all success,false if any path failed
+         */
+        bool stat_batch(const std::vector<std::string>& paths,std::vector<StatResult>& results,uint32_t stat_mask = DIR_STAT_SIZE | DIR_STAT_MTIME,size_t threads = 0);
+
         /**
          * 获取文件或目录的绝对路径 & get absolute path for file or dir
          * @brief 只用当文件或目录真实存在时才会成功 & only success when file or dir exist
          * @return true表示成功,false表示失败 & true for success,false for failed
          */
         bool absolute(const std::string& path,std::string& absolute_path);
+
+        /**
+         * 并行递归遍历目录树 & parallel recursive directory walk
+         * @brief 子目录分发到工作窃取线程池,目录项类型取自d_type,不逐项stat & subdirs fan out over a work-stealing pool,entry type taken from d_type without per-entry stat
+         * @param root 根目录 & root dir
+         * @param callback 目录项回调 & entry callback
+         * @param options 遍历配置 & walk options
+         * @return true表示成功,false表示根目录无法打开或有子目录读取失败 & true for success,false when root can't be opened or some subdir failed
+         */
+        bool walk(const std::string& root,const WalkCallback& callback,const WalkOptions& options = WalkOptions());
+
+        /**
+         * 并行递归删除文件或目录树 & parallel recursive remove of file or dir tree
+         * @brief 基于unlinkat的目录fd相对操作,互不依赖的子树并发处理,出错时继续删除其余部分,符号链接本身被删除而不跟随 & dirfd-relative unlinkat,independent subtrees run concurrently,continues past errors,symlinks are removed not followed
+         * @param path 路径 & path
+         * @param options 配置,仅使用threads & options,only threads is used
+         * @param errors 收集的错误,可为空 & collected errors,can be null
+         * @return true表示全部删除,false表示有错误 & true for all removed,false for any error
+         */
+        bool remove_all(const std::string& path,const TreeOptions& options = TreeOptions(),std::vector<TreeError>* errors = nullptr);
+
+        /**
+         * 并行递归复制目录树 & parallel recursive copy of dir tree
+         * @brief 基于openat/mkdirat的目录fd相对操作,文件走copy的加速路径,保留权限与符号链接,出错时继续复制其余部分 & dirfd-relative openat/mkdirat,files use the accelerated copy path,mode and symlinks preserved,continues past errors
+         * @param src_path 源目录 & source dir
+         * @param dest_path 目标目录,可已存在 & destination dir,may exist
+         * @param options 配置 & options
+         * @param errors 收集的错误,可为空 & collected errors,can be null
+         * @return true表示全部复制,false表示有错误 & true for all copied,false for any error
+         */
+        bool copy_tree(const std::string& src_path,const std::string& dest_path,const TreeOptions& options = TreeOptions(),std::vector<TreeError>* errors = nullptr);
+
+        /**
+         * 并行统计目录树的磁盘占用 & parallel disk usage of dir tree
+         * @brief 基于目录fd相对的statx,每项一次,按(设备,inode)对硬链接去重,不跟随符号链接 & one dirfd-relative statx per entry,hard links deduplicated by (device,inode),symlinks not followed
+         * @param path 文件或目录 & file or dir
+         * @param usage 统计结果 & statistics
+         * @param options 配置 & options
+         * @param errors 收集的错误,可为空 & collected errors,can be null
+         * @return true表示全部统计(含达到limit提前停止),false表示有错误 & true for all counted (including early stop at limit),false for any error
+         */
+        bool disk_usage(const std::string& path,DiskUsage& usage,const DiskUsageOptions& options = DiskUsageOptions(),std::vector<TreeError>* errors = nullptr);
+
+        /**
+         * 单个名字的通配符匹配 & wildcard match of a single name
+         * @brief 支持*,?,[abc],[a-z],[!a-z]与反斜杠转义,点开头的名字不特殊处理 & supports *,?,[abc],[a-z],[!a-z] and backslash escape,leading dots are not special
+         * @param pattern 模式 & pattern
+         * @param name 名字 & name
+         * @return true表示匹配 & true for matched
+         */
+        bool match_name(const std::string& pattern,const std::string& name);
+
+        /**
+         * 在目录树中并行查找匹配模式的路径 & parallel search of paths matching pattern in dir tree
+         * @brief 模式按'/'分段编译一次,"**"匹配零或多级目录,无法再匹配的子树不进入,全为字面量的段直接stat而不列目录,不跟随符号链接 & pattern is compiled once per '/' segment,"**" matches zero or more dirs,subtrees that can no longer match are pruned,all-literal segments are stat'ed instead of listed,symlinks not followed
+         * @param root 根目录 & root dir
+         * @param pattern 相对root的模式,段间以'/'分隔,如"logs","**","seg-*.log"三段 & pattern relative to root,segments separated by '/',e.g. the three segments "logs","**","seg-*.log"
+         * @param results 匹配路径,以root为前缀并排序 & matched paths,prefixed with root and sorted
+         * @param options 配置 & options
+         * @return true表示成功,false表示模式非法,根目录无法打开或有子目录读取失败 & true for success,false for bad pattern,root can't be opened or some subdir failed
+         */
+        bool glob(const std::string& root,const std::string& pattern,std::vector<std::string>& results,const GlobOptions& options = GlobOptions());
     }
 
 } // hzd
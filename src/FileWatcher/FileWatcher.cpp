@@ -0,0 +1,234 @@
+/**
+  ******************************************************************************
+  * @file           : FileWatcher.cpp
+  * @author         : huzhida
+  * @brief          : None
+  * @date           : 2026/10/18
+  ******************************************************************************
+  */
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+#include <Mole.h>
+#include "FileWatcher.h"
+#include "../FileSystem/FileSystem.h"
+
+namespace hzd {
+
+    const std::string io_file_watcher_channel = "io.FileWatcher";
+
+#ifdef __linux__
+    // 递归需要的事件总是订阅,回调前再按用户掩码过滤 & events needed for recursion are always subscribed,filtered by user mask before callback
+    static const uint32_t inotify_mask = IN_CREATE | IN_DELETE | IN_MODIFY | IN_MOVED_FROM | IN_MOVED_TO | IN_CLOSE_WRITE | IN_DELETE_SELF | IN_ONLYDIR;
+
+    static uint32_t toWatchMask(uint32_t mask) {
+        uint32_t ret = 0;
+        if(mask & IN_CREATE) ret |= WATCH_CREATE;
+        if(mask & (IN_DELETE | IN_DELETE_SELF)) ret |= WATCH_DELETE;
+        if(mask & IN_MODIFY) ret |= WATCH_MODIFY;
+        if(mask & (IN_MOVED_FROM | IN_MOVED_TO)) ret |= WATCH_MOVE;
+        if(mask & IN_CLOSE_WRITE) ret |= WATCH_CLOSE_WRITE;
+        return ret;
+    }
+#endif
+
+    static std::string joinPath(const std::string& dir,const char* name) {
+        std::string path = dir;
+        if(path.empty() || path.back() != '/') path += '/';
+        return path += name;
+    }
+
+    FileWatcher::~FileWatcher() {
+        Close();
+    }
+
+    bool FileWatcher::Open(WatchCallback callback_) {
+        Close();
+        callback = std::move(callback_);
+#ifdef __linux__
+        fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if(fd < 0) {
+            MOLE_ERROR(io_file_watcher_channel,strerror(errno));
+            return false;
+        }
+        return true;
+#elif _WIN32
+        MOLE_ERROR(io_file_watcher_channel,"FileWatcher is not supported on windows");
+        return false;
+#endif
+    }
+
+    void FileWatcher::Close() {
+#ifdef __linux__
+        if(fd >= 0) close(fd);
+#endif
+        fd = -1;
+        watches.clear();
+        roots.clear();
+    }
+
+    bool FileWatcher::Add(const std::string &path_, const WatchOptions &options) {
+        if(fd < 0) {
+            MOLE_ERROR(io_file_watcher_channel,"watcher not opened");
+            return false;
+        }
+        std::string path = path_;
+        while(path.size() > 1 && path.back() == '/') path.pop_back();
+        if(!addTree_(path,options,nullptr)) return false;
+        roots.push_back(Watch{path,options});
+        return true;
+    }
+
+    bool FileWatcher::Remove(const std::string &path_) {
+        std::string path = path_;
+        while(path.size() > 1 && path.back() == '/') path.pop_back();
+        bool is_found = false;
+        for(auto it = roots.begin(); it != roots.end();) {
+            if(it->path == path) {
+                it = roots.erase(it);
+                is_found = true;
+            }else {
+                ++it;
+            }
+        }
+        if(!is_found) {
+            MOLE_ERROR(io_file_watcher_channel,"path not watched",{ MOLE_VAR(path) });
+            return false;
+        }
+        removeTree_(path);
+        return true;
+    }
+
+    bool FileWatcher::addTree_(const std::string &path, const WatchOptions &options, const EventSink *sink) {
+#ifdef __linux__
+        int wd = inotify_add_watch(fd,path.c_str(),inotify_mask);
+        if(wd < 0) {
+            MOLE_ERROR(io_file_watcher_channel,strerror(errno),{ MOLE_VAR(path) });
+            return false;
+        }
+        watches[wd] = Watch{path,options};
+        if(!options.is_recursive && !sink) return true;
+        // 监视建立前已出现的内容需要补发事件,否则会漏掉 & content that appeared before the watch existed needs synthetic events,otherwise it's missed
+        filesystem::DirListing listing;
+        if(!filesystem::listdir(path,listing)) return false;
+        for(const auto& entry : listing) {
+            std::string child = joinPath(path,listing.Name(entry));
+            bool is_dir = entry.type == filesystem::EntryType::DIRECTORY;
+            if(sink) (*sink)(child,WATCH_CREATE,is_dir);
+            if(is_dir && options.is_recursive) addTree_(child,options,sink);
+        }
+        return true;
+#elif _WIN32
+        return false;
+#endif
+    }
+
+    void FileWatcher::removeTree_(const std::string &path) {
+        const std::string prefix = joinPath(path,"");
+        for(auto it = watches.begin(); it != watches.end();) {
+            if(it->second.path == path || it->second.path.compare(0,prefix.size(),prefix) == 0) {
+#ifdef __linux__
+                inotify_rm_watch(fd,it->first);
+#endif
+                it = watches.erase(it);
+            }else {
+                ++it;
+            }
+        }
+    }
+
+    int FileWatcher::Dispatch() {
+        if(fd < 0) return -1;
+#ifdef __linux__
+        std::vector<WatchEvent> events;
+        std::unordered_map<std::string,size_t> event_index;
+        EventSink sink = [&events,&event_index](const std::string& path,uint32_t mask,bool is_dir) {
+            auto it = event_index.find(path);
+            if(it != event_index.end()) {
+                events[it->second].mask |= mask;
+                return;
+            }
+            event_index.emplace(path,events.size());
+            events.push_back(WatchEvent{path,mask,is_dir});
+        };
+        bool is_overflow = false;
+        alignas(struct inotify_event) char buffer[64 * 1024];
+        while(true) {
+            ssize_t size = read(fd,buffer,sizeof(buffer));
+            if(size < 0) {
+                if(errno == EINTR) continue;
+                if(errno == EAGAIN) break;
+                MOLE_ERROR(io_file_watcher_channel,strerror(errno));
+                return -1;
+            }
+            if(size == 0) break;
+            for(char* cursor = buffer; cursor < buffer + size;) {
+                auto event = reinterpret_cast<const struct inotify_event*>(cursor);
+                cursor += sizeof(struct inotify_event) + event->len;
+                if(event->mask & IN_Q_OVERFLOW) {
+                    is_overflow = true;
+                    continue;
+                }
+                auto it = watches.find(event->wd);
+                if(it == watches.end()) continue;
+                if(event->mask & IN_IGNORED) {
+                    watches.erase(it);
+                    continue;
+                }
+                const Watch watch = it->second;
+                std::string path = event->len > 0 ? joinPath(watch.path,event->name) : watch.path;
+                bool is_dir = (event->mask & IN_ISDIR) != 0;
+                if(is_dir && watch.options.is_recursive) {
+                    if(event->mask & (IN_MOVED_FROM | IN_DELETE)) {
+                        removeTree_(path);
+                    }else if(event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                        // 子目录可能在监视建立前已有内容 & subdir may already have content before its watch exists
+                        EventSink filtered = [&sink,&watch](const std::string& child,uint32_t mask,bool child_is_dir) {
+                            if(mask & watch.options.mask) sink(child,mask & watch.options.mask,child_is_dir);
+                        };
+                        addTree_(path,watch.options,&filtered);
+                    }
+                }
+                uint32_t mask = toWatchMask(event->mask) & watch.options.mask;
+                if(mask) sink(path,mask,is_dir);
+            }
+        }
+        if(is_overflow) {
+            // 队列溢出后重建监视树,补上期间新建的子目录,并通知调用者对账 & after overflow rebuild watch tree to catch subdirs created meanwhile,and tell caller to reconcile
+            MOLE_WARN(io_file_watcher_channel,"inotify queue overflow,rescanning");
+            for(const auto& root : roots) {
+                addTree_(root.path,root.options,nullptr);
+                if(root.options.mask & WATCH_OVERFLOW) sink(root.path,WATCH_OVERFLOW,true);
+            }
+        }
+        if(callback) {
+            for(const auto& event : events) callback(event);
+        }
+        return static_cast<int>(events.size());
+#elif _WIN32
+        return -1;
+#endif
+    }
+
+    int FileWatcher::Poll(int timeout_ms) {
+        if(fd < 0) return -1;
+#ifdef __linux__
+        struct pollfd poll_fd{fd,POLLIN,0};
+        int ret = poll(&poll_fd,1,timeout_ms);
+        if(ret < 0) {
+            if(errno == EINTR) return 0;
+            MOLE_ERROR(io_file_watcher_channel,strerror(errno));
+            return -1;
+        }
+        if(ret == 0) return 0;
+        return Dispatch();
+#elif _WIN32
+        return -1;
+#endif
+    }
+
+} // hzd
@@ -0,0 +1,124 @@
+/**
+  ******************************************************************************
+  * @file           : FileWatcher.h
+  * @author         : huzhida
+  * @brief          : 基于inotify的文件监视器
+  * @date           : 2026/10/18
+  ******************************************************************************
+  */
+
+#ifndef IO_UTILS_FILEWATCHER_H
+#define IO_UTILS_FILEWATCHER_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace hzd {
+
+    // 监视事件掩码
+    // watch event mask
+    enum WatchEventMask : uint32_t {
+        WATCH_CREATE        = 1,
+        WATCH_DELETE        = 2,
+        WATCH_MODIFY        = 4,
+        // 移入或移出被监视目录 & moved into or out of a watched dir
+        WATCH_MOVE          = 8,
+        // 写入后关闭,文件内容已完整 & closed after write,content is complete
+        WATCH_CLOSE_WRITE   = 16,
+        // 内核事件队列溢出,事件可能丢失,需自行全量对账 & kernel queue overflowed,events may be lost,reconcile fully
+        WATCH_OVERFLOW      = 32,
+        WATCH_ALL           = 63
+    };
+
+    // 监视事件,同一批次内同一路径的事件合并为一个,掩码按位或 & watch event,events of the same path in one batch are merged with masks OR-ed
+    struct WatchEvent {
+        std::string     path;
+        uint32_t        mask;
+        bool            is_dir;
+    };
+
+    using WatchCallback = std::function<void(const WatchEvent&)>;
+
+    // 监视配置
+    // watch options
+    struct WatchOptions {
+        // 是否递归监视子目录,新建的子目录自动加入 & whether watch subdirs recursively,new subdirs are added automatically
+        bool            is_recursive{true};
+        // 关心的事件 & events of interest
+        uint32_t        mask{WATCH_ALL};
+    };
+
+    // 暴露可poll的fd,由调用者的事件循环驱动
+    // exposes a pollable fd,driven by the caller's event loop
+    class FileWatcher {
+    public:
+        FileWatcher() = default;
+        FileWatcher(const FileWatcher&) = delete;
+        FileWatcher& operator=(const FileWatcher&) = delete;
+        ~FileWatcher();
+        /**
+         * 初始化 & initialize
+         * @param callback 事件回调 & event callback
+         * @return true表示成功,false表示失败 & true for success,false for failed
+         */
+        bool Open(WatchCallback callback);
+        /**
+         * 关闭,移除全部监视 & close,removes all watches
+         */
+        void Close();
+        /**
+         * 添加监视目录 & add watched dir
+         * @param path 目录路径 & dir path
+         * @param options 监视配置 & watch options
+         * @return true表示成功,false表示失败 & true for success,false for failed
+         */
+        bool Add(const std::string& path,const WatchOptions& options = WatchOptions());
+        /**
+         * 移除监视目录及其子目录 & remove watched dir and its subdirs
+         * @param path 目录路径 & dir path
+         * @return true表示成功,false表示失败 & true for success,false for failed
+         */
+        bool Remove(const std::string& path);
+        /**
+         * 非阻塞读取全部待处理事件并回调,fd可读时调用 & read all pending events without blocking and invoke callback,call when fd is readable
+         * @return 回调的事件数,-1表示失败 & events dispatched,-1 for failed
+         */
+        int Dispatch();
+        /**
+         * 等待事件并分发 & wait for events and dispatch
+         * @param timeout_ms 超时(ms),-1表示一直等待 & timeout (ms),-1 for infinite
+         * @return 回调的事件数,-1表示失败 & events dispatched,-1 for failed
+         */
+        int Poll(int timeout_ms);
+        /**
+         * 可读时表示有事件待分发 & readable means events are pending
+         */
+        inline int Fd() const { return fd; }
+        /**
+         * 当前监视的目录数 & number of watched dirs
+         */
+        inline size_t WatchCount() const { return watches.size(); }
+    private:
+        struct Watch {
+            std::string     path;
+            WatchOptions    options;
+        };
+        using EventSink = std::function<void(const std::string&,uint32_t,bool)>;
+
+        bool addTree_(const std::string& path,const WatchOptions& options,const EventSink* sink);
+        void removeTree_(const std::string& path);
+
+        int                                 fd{-1};
+        WatchCallback                       callback;
+        // wd到目录的映射 & wd to dir
+        std::unordered_map<int,Watch>       watches;
+        // Add添加的根目录 & roots added by Add
+        std::vector<Watch>                  roots;
+    };
+
+} // hzd
+
+#endif //IO_UTILS_FILEWATCHER_H
@@ -0,0 +1,265 @@
+/**
+  ******************************************************************************
+  * @file           : FileWriter.cpp
+  * @author         : huzhida
+  * @brief          : None
+  * @date           : 2026/10/18
+  ******************************************************************************
+  */
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <cstdlib>
+#elif _WIN32
+#define _CRT_SECURE_NO_WARNINGS
+#include <cstdio>
+#include <malloc.h>
+#endif
+#include <Mole.h>
+#include "FileWriter.h"
+#include <algorithm>
+
+namespace hzd {
+
+    const std::string io_file_writer_channel = "io.FileWriter";
+
+    // O_DIRECT要求的缓冲区地址、偏移与长度对齐 & alignment of buffer address,offset and length required by O_DIRECT
+    static const size_t direct_alignment = 4096;
+
+    static inline size_t alignUp(size_t value) {
+        return (value + direct_alignment - 1) & ~(direct_alignment - 1);
+    }
+
+    FileWriter::~FileWriter() {
+        Close();
+    }
+
+    bool FileWriter::Open(const std::string &path_, const FileWriterOptions &options_) {
+        if(is_open) Close();
+        path = path_;
+        options = options_;
+        options.buffer_size = alignUp(std::max<size_t>(options.buffer_size,direct_alignment));
+        options.buffer_count = std::max<size_t>(options.buffer_count,2);
+        offset = 0;
+        fill = 0;
+        error = 0;
+        is_direct = false;
+#ifdef __linux__
+        int flags = O_WRONLY | O_CREAT | O_CLOEXEC | (options.is_append ? 0 : O_TRUNC);
+        if(options.is_direct) {
+            fd = open(path.c_str(),flags | O_DIRECT,0644);
+            if(fd >= 0) {
+                is_direct = true;
+            }else if(errno == EINVAL) {
+                MOLE_WARN(io_file_writer_channel,"O_DIRECT not supported,fall back to buffered write",{ MOLE_VAR(path) });
+            }
+        }
+        if(fd < 0) fd = open(path.c_str(),flags,0644);
+        if(fd < 0) {
+            MOLE_ERROR(io_file_writer_channel,strerror(errno),{ MOLE_VAR(path) });
+            return false;
+        }
+        if(options.is_append) {
+            struct stat st{};
+            fstat(fd,&st);
+            offset = static_cast<uint64_t>(st.st_size);
+            if(is_direct && offset % direct_alignment != 0) {
+                // 未对齐的追加起点无法直接IO,关闭O_DIRECT & unaligned append start can't use direct IO,drop O_DIRECT
+                fcntl(fd,F_SETFL,fcntl(fd,F_GETFL) & ~O_DIRECT);
+                is_direct = false;
+            }
+        }
+        // 预分配减少碎片与写入时的元数据更新 & preallocation reduces fragmentation and metadata updates during writes
+        if(options.preallocate > 0 && fallocate(fd,FALLOC_FL_KEEP_SIZE,static_cast<off_t>(offset),static_cast<off_t>(options.preallocate)) != 0) {
+            // 空间不足时尽早失败,而不是写到一半 & fail early on no space instead of halfway through writing
+            if(errno == ENOSPC) {
+                MOLE_ERROR(io_file_writer_channel,strerror(errno),{ MOLE_VAR(path),MOLE_VAR(options.preallocate) });
+                close(fd);
+                fd = -1;
+                return false;
+            }
+            MOLE_WARN(io_file_writer_channel,strerror(errno),{ MOLE_VAR(path) });
+        }
+        for(size_t i = 0; i < options.buffer_count; i++) {
+            void* buffer = nullptr;
+            if(posix_memalign(&buffer,direct_alignment,options.buffer_size) != 0) {
+                MOLE_ERROR(io_file_writer_channel,"allocate buffer failed",{ MOLE_VAR(options.buffer_size) });
+                release_();
+                close(fd);
+                fd = -1;
+                return false;
+            }
+            buffers.push_back(static_cast<char*>(buffer));
+        }
+#elif _WIN32
+        fd = fopen(path.c_str(),options.is_append ? "ab" : "wb");
+        if(!fd) {
+            MOLE_ERROR(io_file_writer_channel,strerror(errno),{ MOLE_VAR(path) });
+            return false;
+        }
+        _fseeki64(fd,0,SEEK_END);
+        offset = static_cast<uint64_t>(_ftelli64(fd));
+        for(size_t i = 0; i < options.buffer_count; i++) {
+            buffers.push_back(static_cast<char*>(_aligned_malloc(options.buffer_size,direct_alignment)));
+        }
+#endif
+        free_buffers.assign(buffers.begin() + 1,buffers.end());
+        current = buffers.front();
+        is_stop = false;
+        is_open = true;
+        thread = std::thread(&FileWriter::run_,this);
+        return true;
+    }
+
+    bool FileWriter::Write(const char *data, size_t size) {
+        if(!is_open || error.load(std::memory_order_relaxed) != 0) return false;
+        while(size > 0) {
+            size_t copy_size = std::min(size,options.buffer_size - fill);
+            memcpy(current + fill,data,copy_size);
+            fill += copy_size;
+            data += copy_size;
+            size -= copy_size;
+            if(fill == options.buffer_size && !submit_(true)) return false;
+        }
+        return true;
+    }
+
+    bool FileWriter::Write(const std::string &data) {
+        return Write(data.data(),data.size());
+    }
+
+    bool FileWriter::submit_(bool is_recycle) {
+        Job job{current,offset,fill,is_recycle};
+        if(is_direct) job.length = alignUp(fill);
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            jobs.push_back(job);
+        }
+        job_condition.notify_one();
+        if(!is_recycle) return true;
+        offset += fill;
+        fill = 0;
+        return acquire_();
+    }
+
+    bool FileWriter::acquire_() {
+        std::unique_lock<std::mutex> lock(mutex);
+        free_condition.wait(lock,[this] { return !free_buffers.empty() || error.load(std::memory_order_relaxed) != 0; });
+        if(free_buffers.empty()) return false;
+        current = free_buffers.front();
+        free_buffers.pop_front();
+        return true;
+    }
+
+    bool FileWriter::wait_() {
+        std::unique_lock<std::mutex> lock(mutex);
+        free_condition.wait(lock,[this] { return (jobs.empty() && in_flight == 0) || error.load(std::memory_order_relaxed) != 0; });
+        return error.load(std::memory_order_relaxed) == 0;
+    }
+
+    bool FileWriter::Flush() {
+        if(!is_open) return false;
+        if(error.load(std::memory_order_relaxed) != 0) return false;
+        if(fill > 0) {
+            if(is_direct) {
+                // 未满的缓冲区补齐对齐后写出,但保留在当前缓冲区中,后续写入会覆盖该块 & partial buffer is written padded but kept current,later writes rewrite that block
+                submit_(false);
+            }else if(!submit_(true)) {
+                return false;
+            }
+        }
+        return wait_();
+    }
+
+    bool FileWriter::Close() {
+        if(!is_open) return true;
+        bool ret = Flush();
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            is_stop = true;
+        }
+        job_condition.notify_one();
+        thread.join();
+#ifdef __linux__
+        // O_DIRECT的补齐部分需截掉 & cut off O_DIRECT padding
+        struct stat st{};
+        if(fstat(fd,&st) == 0 && static_cast<uint64_t>(st.st_size) > Size() && ftruncate(fd,static_cast<off_t>(Size())) != 0) {
+            MOLE_ERROR(io_file_writer_channel,strerror(errno),{ MOLE_VAR(path) });
+            ret = false;
+        }
+        if(ret && options.is_sync_on_close && fdatasync(fd) != 0) {
+            MOLE_ERROR(io_file_writer_channel,strerror(errno),{ MOLE_VAR(path) });
+            ret = false;
+        }
+        if(close(fd) != 0) ret = false;
+        fd = -1;
+#elif _WIN32
+        if(fclose(fd) != 0) ret = false;
+        fd = nullptr;
+#endif
+        release_();
+        is_open = false;
+        return ret;
+    }
+
+    void FileWriter::release_() {
+        for(auto buffer : buffers) {
+#ifdef __linux__
+            free(buffer);
+#elif _WIN32
+            _aligned_free(buffer);
+#endif
+        }
+        buffers.clear();
+        free_buffers.clear();
+        jobs.clear();
+        current = nullptr;
+    }
+
+    void FileWriter::run_() {
+        while(true) {
+            Job job{};
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                job_condition.wait(lock,[this] { return is_stop || !jobs.empty(); });
+                if(jobs.empty()) return;
+                job = jobs.front();
+                jobs.pop_front();
+                in_flight++;
+            }
+            size_t written = 0;
+            int err = 0;
+            while(written < job.length && err == 0) {
+#ifdef __linux__
+                ssize_t ret = pwrite(fd,job.buffer + written,job.length - written,static_cast<off_t>(job.offset + written));
+                if(ret < 0) {
+                    if(errno != EINTR) err = errno;
+                    continue;
+                }
+#elif _WIN32
+                _fseeki64(fd,static_cast<long long>(job.offset + written),SEEK_SET);
+                size_t ret = fwrite(job.buffer + written,1,job.length - written,fd);
+                if(ret == 0) {
+                    err = errno ? errno : EIO;
+                    continue;
+                }
+#endif
+                written += ret;
+            }
+            if(err != 0) {
+                MOLE_ERROR(io_file_writer_channel,strerror(err),{ MOLE_VAR(path) });
+                error.store(err,std::memory_order_relaxed);
+            }
+            {
+                std::lock_guard<std::mutex> guard(mutex);
+                in_flight--;
+                if(job.is_recycle) free_buffers.push_back(job.buffer);
+            }
+            free_condition.notify_all();
+        }
+    }
+
+} // hzd
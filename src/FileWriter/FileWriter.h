@@ -0,0 +1,135 @@
+/**
+  ******************************************************************************
+  * @file           : FileWriter.h
+  * @author         : huzhida
+  * @brief          : 双缓冲后台落盘的文件写入器
+  * @date           : 2026/10/18
+  ******************************************************************************
+  */
+
+#ifndef IO_UTILS_FILEWRITER_H
+#define IO_UTILS_FILEWRITER_H
+
+#include <atomic>
+#ifdef _WIN32
+#include <cstdio>
+#endif
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace hzd {
+
+    // 文件写入器配置
+    // file writer options
+    struct FileWriterOptions {
+        // 单个缓冲区大小,向上对齐到4096 & size of each buffer,rounded up to 4096
+        size_t          buffer_size{4 * 1024 * 1024};
+        // 缓冲区个数,至少为2 & buffer count,at least 2
+        size_t          buffer_count{2};
+        // 是否使用O_DIRECT绕过页缓存,不支持时退回普通写 & whether bypass page cache with O_DIRECT,falls back to buffered if unsupported
+        bool            is_direct{false};
+        // 预分配字节数(fallocate,不改变文件大小) & bytes to preallocate (fallocate,file size unchanged)
+        uint64_t        preallocate{0};
+        // 是否追加到已有内容之后,否则截断 & whether append after existing content,otherwise truncate
+        bool            is_append{false};
+        // 关闭时是否fdatasync & whether fdatasync on close
+        bool            is_sync_on_close{false};
+    };
+
+    // 调用者填充一个缓冲区的同时,后台线程将已满的缓冲区写入磁盘
+    // while the caller fills one buffer,a background thread writes full buffers to disk
+    class FileWriter {
+    public:
+        FileWriter() = default;
+        FileWriter(const FileWriter&) = delete;
+        FileWriter& operator=(const FileWriter&) = delete;
+        /**
+         * 析构函数,自动关闭 & destructor,closes automatically
+         */
+        ~FileWriter();
+        /**
+         * 打开文件 & open file
+         * @param path 文件路径 & file path
+         * @param options 配置 & options
+         * @return true表示成功,false表示失败 & true for success,false for failed
+         */
+        bool Open(const std::string& path,const FileWriterOptions& options = FileWriterOptions());
+        /**
+         * 写入数据,缓冲区满时交给后台线程 & write data,full buffers are handed to the background thread
+         * @param data 数据 & data
+         * @param size 数据大小 & data size
+         * @return true表示成功,false表示失败(包括之前的后台写入失败) & true for success,false for failed (including earlier background failure)
+         */
+        bool Write(const char* data,size_t size);
+        bool Write(const std::string& data);
+        /**
+         * 将已写入的数据全部落盘后返回(不fsync) & return after all written data reaches the file (no fsync)
+         * @return true表示成功,false表示失败 & true for success,false for failed
+         */
+        bool Flush();
+        /**
+         * 刷新并关闭文件 & flush and close file
+         * @return true表示成功,false表示失败 & true for success,false for failed
+         */
+        bool Close();
+        /**
+         * 已写入的逻辑字节数 & logical bytes written
+         */
+        inline uint64_t Size() const { return offset + fill; }
+        inline bool IsOpen() const { return is_open; }
+        /**
+         * 是否实际使用了O_DIRECT & whether O_DIRECT is actually in use
+         */
+        inline bool IsDirect() const { return is_direct; }
+    private:
+        struct Job {
+            char*       buffer;
+            uint64_t    offset;
+            size_t      length;
+            // 写完后是否归还到空闲队列 & whether return to free queue after write
+            bool        is_recycle;
+        };
+
+        void run_();
+        bool submit_(bool is_recycle);
+        bool acquire_();
+        bool wait_();
+        void release_();
+
+        FileWriterOptions               options;
+        std::string                     path;
+        bool                            is_open{false};
+        bool                            is_direct{false};
+        std::vector<char*>              buffers;
+        std::deque<char*>               free_buffers;
+        std::deque<Job>                 jobs;
+        std::mutex                      mutex;
+        std::condition_variable         job_condition;
+        std::condition_variable         free_condition;
+        std::thread                     thread;
+        // 正在写的任务数 & jobs being written
+        size_t                          in_flight{0};
+        bool                            is_stop{false};
+        // 后台写入失败时的errno & errno of background write failure
+        std::atomic<int>                error{0};
+        // 当前缓冲区 & current buffer
+        char*                           current{nullptr};
+        // 当前缓冲区在文件中的偏移 & file offset of current buffer
+        uint64_t                        offset{0};
+        // 当前缓冲区已填充字节数 & filled bytes of current buffer
+        size_t                          fill{0};
+#ifdef __linux__
+        int                             fd{-1};
+#elif _WIN32
+        FILE*                           fd{nullptr};
+#endif
+    };
+
+} // hzd
+
+#endif //IO_UTILS_FILEWRITER_H
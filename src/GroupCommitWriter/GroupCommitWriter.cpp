@@ -0,0 +1,160 @@
+/**
+  ******************************************************************************
+  * @file           : GroupCommitWriter.cpp
+  * @author         : huzhida
+  * @brief          : None
+  * @date           : 2026/10/18
+  ******************************************************************************
+  */
+#ifdef __linux__
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+#include <Mole.h>
+#include "GroupCommitWriter.h"
+#include "../FileSystem/FileSystem.h"
+#include <algorithm>
+#include <map>
+
+namespace hzd {
+
+    const std::string io_group_commit_channel = "io.GroupCommitWriter";
+
+    GroupCommitWriter::GroupCommitWriter(const GroupCommitOptions &options_) : options(options_) {
+        options.max_batch = std::max<size_t>(options.max_batch,1);
+        thread = std::thread(&GroupCommitWriter::run_,this);
+    }
+
+    GroupCommitWriter::~GroupCommitWriter() {
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            is_stop = true;
+        }
+        condition.notify_one();
+        thread.join();
+    }
+
+    std::future<bool> GroupCommitWriter::Write(const std::string &path, std::string data) {
+        Item item;
+        item.path = path;
+        item.data = std::move(data);
+        auto future = item.promise.get_future();
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            pending.push_back(std::move(item));
+        }
+        condition.notify_one();
+        return future;
+    }
+
+    void GroupCommitWriter::Flush() {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle_condition.wait(lock,[this] { return pending.empty() && in_progress == 0; });
+    }
+
+    void GroupCommitWriter::run_() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while(true) {
+            condition.wait(lock,[this] { return is_stop || !pending.empty(); });
+            if(pending.empty()) return;
+            // 上一批落盘期间到达的写入自然聚成下一批,未满时再稍等片刻 & writes arriving during the previous sync form the next batch,wait briefly if not full
+            if(pending.size() < options.max_batch && !is_stop && options.max_delay_us > 0) {
+                condition.wait_for(lock,std::chrono::microseconds(options.max_delay_us),[this] { return is_stop || pending.size() >= options.max_batch; });
+            }
+            std::vector<Item> batch;
+            size_t count = std::min(pending.size(),options.max_batch);
+            batch.reserve(count);
+            for(size_t i = 0; i < count; i++) {
+                batch.push_back(std::move(pending.front()));
+                pending.pop_front();
+            }
+            in_progress = count;
+            lock.unlock();
+            commit_(batch);
+            batches.fetch_add(1,std::memory_order_relaxed);
+            lock.lock();
+            in_progress = 0;
+            idle_condition.notify_all();
+        }
+    }
+
+    void GroupCommitWriter::commit_(std::vector<Item> &batch) {
+#ifdef __linux__
+        // 1. 写全部临时文件,每个文件系统保留一个fd用于syncfs & write all temp files,keep one fd per filesystem for syncfs
+        std::map<dev_t,int> device_fds;
+        std::vector<dev_t> item_devices(batch.size(),static_cast<dev_t>(-1));
+        for(size_t i = 0; i < batch.size(); i++) {
+            Item& item = batch[i];
+            int fd = filesystem::open_temp(item.path,item.temp);
+            if(fd < 0) {
+                item.temp.clear();
+                item.is_ok = false;
+                continue;
+            }
+            size_t written = 0;
+            while(written < item.data.size() && item.is_ok) {
+                ssize_t ret = write(fd,item.data.data() + written,item.data.size() - written);
+                if(ret < 0) {
+                    if(errno == EINTR) continue;
+                    MOLE_ERROR(io_group_commit_channel,strerror(errno),{ MOLE_VAR(item.path) });
+                    item.is_ok = false;
+                    break;
+                }
+                written += static_cast<size_t>(ret);
+            }
+            if(item.is_ok && !options.is_syncfs && fdatasync(fd) != 0) {
+                MOLE_ERROR(io_group_commit_channel,strerror(errno),{ MOLE_VAR(item.path) });
+                item.is_ok = false;
+            }
+            struct stat st{};
+            if(item.is_ok && options.is_syncfs) {
+                if(fstat(fd,&st) == 0) {
+                    item_devices[i] = st.st_dev;
+                    if(device_fds.emplace(st.st_dev,fd).second) continue;
+                }else if(fdatasync(fd) != 0) {
+                    MOLE_ERROR(io_group_commit_channel,strerror(errno),{ MOLE_VAR(item.path) });
+                    item.is_ok = false;
+                }
+            }
+            close(fd);
+        }
+        // 2. 每个文件系统一次syncfs,覆盖本批所有临时文件的数据 & one syncfs per filesystem covers the data of every temp file in the batch
+        for(auto& device_fd : device_fds) {
+            if(syncfs(device_fd.second) != 0) {
+                MOLE_ERROR(io_group_commit_channel,strerror(errno));
+                for(size_t i = 0; i < batch.size(); i++) {
+                    if(item_devices[i] == device_fd.first) batch[i].is_ok = false;
+                }
+            }
+            close(device_fd.second);
+        }
+        // 3. 数据落盘后rename,每个目录只fsync一次 & rename after data is durable,fsync each dir only once
+        std::map<std::string,std::vector<size_t>> dirs;
+        for(size_t i = 0; i < batch.size(); i++) {
+            Item& item = batch[i];
+            if(!item.is_ok) {
+                if(!item.temp.empty()) unlink(item.temp.c_str());
+                continue;
+            }
+            if(::rename(item.temp.c_str(),item.path.c_str()) != 0) {
+                MOLE_ERROR(io_group_commit_channel,strerror(errno),{ MOLE_VAR(item.path) });
+                unlink(item.temp.c_str());
+                item.is_ok = false;
+                continue;
+            }
+            dirs[filesystem::parent_dir(item.path)].push_back(i);
+        }
+        for(auto& dir : dirs) {
+            if(filesystem::sync_dir(dir.first)) continue;
+            for(auto index : dir.second) batch[index].is_ok = false;
+        }
+#elif _WIN32
+        for(auto& item : batch) item.is_ok = filesystem::atomic_write(item.path,item.data);
+#endif
+        for(auto& item : batch) item.promise.set_value(item.is_ok);
+    }
+
+} // hzd
@@ -0,0 +1,90 @@
+/**
+  ******************************************************************************
+  * @file           : GroupCommitWriter.h
+  * @author         : huzhida
+  * @brief          : 组提交的原子持久写入
+  * @date           : 2026/10/18
+  ******************************************************************************
+  */
+
+#ifndef IO_UTILS_GROUPCOMMITWRITER_H
+#define IO_UTILS_GROUPCOMMITWRITER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace hzd {
+
+    // 组提交配置
+    // group commit options
+    struct GroupCommitOptions {
+        // 每批最多提交的文件数 & max files committed per batch
+        size_t          max_batch{256};
+        // 批次未满时等待更多写入的时间(us) & time to wait for more writes when batch isn't full (us)
+        uint32_t        max_delay_us{1000};
+        // 每个文件系统一次syncfs代替逐文件fdatasync,默认关闭 & one syncfs per filesystem instead of per-file fdatasync,off by default
+        // syncfs会刷新整个文件系统的脏页,包括其他进程的数据,批次延迟因此没有上界 & syncfs flushes every dirty page of the filesystem,other processes' data included,so batch latency is unbounded
+        // Linux 5.8之前syncfs不报告回写错误,未落盘的数据也可能返回成功 & before Linux 5.8 syncfs doesn't report writeback errors,data never made durable may still report success
+        bool            is_syncfs{false};
+    };
+
+    // 每批先写完全部临时文件并落盘(逐文件fdatasync,或开启时每个文件系统一次syncfs),再rename并对每个目录fsync一次
+    // each batch writes and syncs all temp files (per-file fdatasync,or one syncfs per filesystem when enabled),then renames and fsyncs each dir once
+    class GroupCommitWriter {
+    public:
+        explicit GroupCommitWriter(const GroupCommitOptions& options = GroupCommitOptions());
+        GroupCommitWriter(const GroupCommitWriter&) = delete;
+        GroupCommitWriter& operator=(const GroupCommitWriter&) = delete;
+        /**
+         * 析构函数,提交剩余写入 & destructor,commits remaining writes
+         */
+        ~GroupCommitWriter();
+        /**
+         * 提交一次原子写入,语义同filesystem::atomic_write & queue an atomic write,same semantics as filesystem::atomic_write
+         * @param path 文件路径 & file path
+         * @param data 数据 & data
+         * @return 持久化完成后为true,失败为false & true once durable,false on failure
+         */
+        std::future<bool> Write(const std::string& path,std::string data);
+        /**
+         * 等待已提交的写入全部完成 & wait until all queued writes finish
+         */
+        void Flush();
+        /**
+         * 已完成的批次数 & batches committed
+         */
+        inline uint64_t Batches() const { return batches.load(std::memory_order_relaxed); }
+    private:
+        struct Item {
+            std::string             path;
+            std::string             data;
+            std::promise<bool>      promise;
+            std::string             temp;
+            bool                    is_ok{true};
+        };
+
+        void run_();
+        void commit_(std::vector<Item>& batch);
+
+        GroupCommitOptions          options;
+        std::deque<Item>            pending;
+        // 正在提交的文件数 & files being committed
+        size_t                      in_progress{0};
+        bool                        is_stop{false};
+        std::mutex                  mutex;
+        std::condition_variable     condition;
+        std::condition_variable     idle_condition;
+        std::atomic<uint64_t>       batches{0};
+        std::thread                 thread;
+    };
+
+} // hzd
+
+#endif //IO_UTILS_GROUPCOMMITWRITER_H
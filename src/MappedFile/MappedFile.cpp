@@ -0,0 +1,304 @@
+/**
+  ******************************************************************************
+  * @file           : MappedFile.cpp
+  * @author         : huzhida
+  * @brief          : None
+  * @date           : 2026/10/18
+  ******************************************************************************
+  */
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#elif _WIN32
+#define _CRT_SECURE_NO_WARNINGS
+#include <windows.h>
+#endif
+#include <Mole.h>
+#include "MappedFile.h"
+#include <algorithm>
+#include <utility>
+
+#ifdef __linux__
+// 旧内核头文件缺少的定义,内核不支持时返回EINVAL & definitions missing in old headers,kernel returns EINVAL if unsupported
+#ifndef MADV_POPULATE_READ
+#define MADV_POPULATE_READ 22
+#endif
+#ifndef MADV_POPULATE_WRITE
+#define MADV_POPULATE_WRITE 23
+#endif
+#endif
+
+namespace hzd {
+
+    const std::string io_mapped_file_channel = "io.MappedFile";
+
+    MappedView MappedView::Slice(size_t offset, size_t length) const {
+        MappedView view;
+        if(offset >= size) return view;
+        view.data = data + offset;
+        view.size = std::min(length,size - offset);
+        return view;
+    }
+
+    MappedFile::MappedFile(MappedFile &&other) noexcept {
+        *this = std::move(other);
+    }
+
+    MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+        if(this == &other) return *this;
+        Close();
+        data = other.data;
+        size = other.size;
+        mode = other.mode;
+        options = other.options;
+        is_open = other.is_open;
+#ifdef __linux__
+        fd = other.fd;
+        other.fd = -1;
+#elif _WIN32
+        file = other.file;
+        mapping = other.mapping;
+        other.file = nullptr;
+        other.mapping = nullptr;
+#endif
+        other.data = nullptr;
+        other.size = 0;
+        other.is_open = false;
+        return *this;
+    }
+
+    MappedFile::~MappedFile() {
+        Close();
+    }
+
+    bool MappedFile::Open(const std::string &path, MapMode mode_, const MapOptions &options_) {
+        Close();
+        mode = mode_;
+        options = options_;
+#ifdef __linux__
+        int flags = mode == MapMode::READ_WRITE ? O_RDWR : O_RDONLY;
+        if(mode == MapMode::READ_WRITE && options.is_create) flags |= O_CREAT;
+        fd = open(path.c_str(),flags | O_CLOEXEC,0644);
+        if(fd < 0) {
+            MOLE_ERROR(io_mapped_file_channel,strerror(errno),{ MOLE_VAR(path) });
+            return false;
+        }
+        struct stat st{};
+        if(fstat(fd,&st) != 0) {
+            MOLE_ERROR(io_mapped_file_channel,strerror(errno),{ MOLE_VAR(path) });
+            close(fd);
+            fd = -1;
+            return false;
+        }
+        size = static_cast<size_t>(st.st_size);
+        if(mode == MapMode::READ_WRITE && options.size != 0 && options.size != size) {
+            if(ftruncate(fd,static_cast<off_t>(options.size)) != 0) {
+                MOLE_ERROR(io_mapped_file_channel,strerror(errno),{ MOLE_VAR(path) });
+                close(fd);
+                fd = -1;
+                return false;
+            }
+            size = options.size;
+        }
+#elif _WIN32
+        DWORD access = mode == MapMode::READ_WRITE ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ;
+        DWORD disposition = mode == MapMode::READ_WRITE && options.is_create ? OPEN_ALWAYS : OPEN_EXISTING;
+        HANDLE handle = CreateFileA(path.c_str(),access,FILE_SHARE_READ | FILE_SHARE_WRITE,nullptr,disposition,FILE_ATTRIBUTE_NORMAL,nullptr);
+        if(handle == INVALID_HANDLE_VALUE) {
+            MOLE_ERROR(io_mapped_file_channel,"can't open file",{ MOLE_VAR(path) });
+            return false;
+        }
+        file = handle;
+        LARGE_INTEGER file_size;
+        GetFileSizeEx(handle,&file_size);
+        size = static_cast<size_t>(file_size.QuadPart);
+        if(mode == MapMode::READ_WRITE && options.size != 0 && options.size != size) {
+            file_size.QuadPart = static_cast<LONGLONG>(options.size);
+            SetFilePointerEx(handle,file_size,nullptr,FILE_BEGIN);
+            SetEndOfFile(handle);
+            size = options.size;
+        }
+#endif
+        is_open = true;
+        if(!map_()) {
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+    bool MappedFile::map_() {
+        // 空文件无法映射,以空视图表示 & empty file can't be mapped,represented as empty view
+        if(size == 0) return true;
+#ifdef __linux__
+        int prot = mode == MapMode::READ_WRITE ? (PROT_READ | PROT_WRITE) : PROT_READ;
+        int flags = MAP_SHARED | (options.is_populate ? MAP_POPULATE : 0);
+        void* address = mmap(nullptr,size,prot,flags,fd,0);
+        if(address == MAP_FAILED) {
+            MOLE_ERROR(io_mapped_file_channel,strerror(errno),{ MOLE_VAR(size) });
+            return false;
+        }
+        data = static_cast<char*>(address);
+        // 文件页的透明大页依赖内核配置,失败仅为提示无效 & file THP depends on kernel config,failure only means the hint is ignored
+        if(options.is_huge_page) madvise(data,size,MADV_HUGEPAGE);
+        return true;
+#elif _WIN32
+        DWORD protect = mode == MapMode::READ_WRITE ? PAGE_READWRITE : PAGE_READONLY;
+        mapping = CreateFileMappingA(static_cast<HANDLE>(file),nullptr,protect,0,0,nullptr);
+        if(!mapping) {
+            MOLE_ERROR(io_mapped_file_channel,"CreateFileMapping failed",{ MOLE_VAR(size) });
+            return false;
+        }
+        DWORD access = mode == MapMode::READ_WRITE ? FILE_MAP_WRITE : FILE_MAP_READ;
+        data = static_cast<char*>(MapViewOfFile(static_cast<HANDLE>(mapping),access,0,0,size));
+        if(!data) {
+            MOLE_ERROR(io_mapped_file_channel,"MapViewOfFile failed",{ MOLE_VAR(size) });
+            return false;
+        }
+        if(options.is_populate) Prefault();
+        return true;
+#endif
+    }
+
+    void MappedFile::unmap_() {
+#ifdef __linux__
+        if(data) munmap(data,size);
+#elif _WIN32
+        if(data) UnmapViewOfFile(data);
+        if(mapping) CloseHandle(static_cast<HANDLE>(mapping));
+        mapping = nullptr;
+#endif
+        data = nullptr;
+    }
+
+    void MappedFile::Close() {
+        unmap_();
+#ifdef __linux__
+        if(fd >= 0) close(fd);
+        fd = -1;
+#elif _WIN32
+        if(file) CloseHandle(static_cast<HANDLE>(file));
+        file = nullptr;
+#endif
+        size = 0;
+        is_open = false;
+    }
+
+    bool MappedFile::Advise(MapAdvice advice, size_t offset, size_t length) {
+        if(!data || offset >= size) return data == nullptr && is_open;
+        if(length == 0 || length > size - offset) length = size - offset;
+#ifdef __linux__
+        // madvise要求起始地址页对齐 & madvise requires page aligned start
+        const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        size_t aligned = offset & ~(page_size - 1);
+        length += offset - aligned;
+        int value = MADV_NORMAL;
+        switch(advice) {
+            case MapAdvice::NORMAL: value = MADV_NORMAL; break;
+            case MapAdvice::SEQUENTIAL: value = MADV_SEQUENTIAL; break;
+            case MapAdvice::RANDOM: value = MADV_RANDOM; break;
+            case MapAdvice::WILLNEED: value = MADV_WILLNEED; break;
+            case MapAdvice::DONTNEED: value = MADV_DONTNEED; break;
+        }
+        if(madvise(data + aligned,length,value) != 0) {
+            MOLE_ERROR(io_mapped_file_channel,strerror(errno),{ MOLE_VAR(offset),MOLE_VAR(length) });
+            return false;
+        }
+        return true;
+#elif _WIN32
+        if(advice != MapAdvice::WILLNEED) return true;
+        WIN32_MEMORY_RANGE_ENTRY range;
+        range.VirtualAddress = data + offset;
+        range.NumberOfBytes = length;
+        return PrefetchVirtualMemory(GetCurrentProcess(),1,&range,0) != 0;
+#endif
+    }
+
+    bool MappedFile::Prefault(size_t offset, size_t length) {
+        if(!data || offset >= size) return data == nullptr && is_open;
+        if(length == 0 || length > size - offset) length = size - offset;
+#ifdef __linux__
+        const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        size_t aligned = offset & ~(page_size - 1);
+        int value = mode == MapMode::READ_WRITE ? MADV_POPULATE_WRITE : MADV_POPULATE_READ;
+        if(madvise(data + aligned,length + offset - aligned,value) == 0) return true;
+        if(errno != EINVAL) {
+            MOLE_ERROR(io_mapped_file_channel,strerror(errno),{ MOLE_VAR(offset),MOLE_VAR(length) });
+            return false;
+        }
+#else
+        const size_t page_size = 4096;
+        size_t aligned = offset & ~(page_size - 1);
+#endif
+        // 内核不支持MADV_POPULATE时逐页读触发缺页 & touch each page when kernel lacks MADV_POPULATE
+        volatile char sink = 0;
+        for(size_t i = aligned; i < offset + length; i += page_size) sink ^= data[i];
+        (void)sink;
+        return true;
+    }
+
+    bool MappedFile::Resize(size_t new_size) {
+        if(!is_open || mode != MapMode::READ_WRITE) {
+            MOLE_ERROR(io_mapped_file_channel,"file not opened in read-write mode");
+            return false;
+        }
+        if(new_size == size) return true;
+#ifdef __linux__
+        if(ftruncate(fd,static_cast<off_t>(new_size)) != 0) {
+            MOLE_ERROR(io_mapped_file_channel,strerror(errno),{ MOLE_VAR(new_size) });
+            return false;
+        }
+        if(data && new_size > 0) {
+            void* address = mremap(data,size,new_size,MREMAP_MAYMOVE);
+            if(address == MAP_FAILED) {
+                MOLE_ERROR(io_mapped_file_channel,strerror(errno),{ MOLE_VAR(new_size) });
+                return false;
+            }
+            data = static_cast<char*>(address);
+            size = new_size;
+            if(options.is_huge_page) madvise(data,size,MADV_HUGEPAGE);
+            return true;
+        }
+        unmap_();
+        size = new_size;
+        return map_();
+#elif _WIN32
+        unmap_();
+        LARGE_INTEGER file_size;
+        file_size.QuadPart = static_cast<LONGLONG>(new_size);
+        if(!SetFilePointerEx(static_cast<HANDLE>(file),file_size,nullptr,FILE_BEGIN) || !SetEndOfFile(static_cast<HANDLE>(file))) {
+            MOLE_ERROR(io_mapped_file_channel,"SetEndOfFile failed",{ MOLE_VAR(new_size) });
+            map_();
+            return false;
+        }
+        size = new_size;
+        return map_();
+#endif
+    }
+
+    bool MappedFile::Sync(bool is_async) {
+        if(!data) return is_open;
+#ifdef __linux__
+        if(msync(data,size,is_async ? MS_ASYNC : MS_SYNC) != 0) {
+            MOLE_ERROR(io_mapped_file_channel,strerror(errno));
+            return false;
+        }
+        return true;
+#elif _WIN32
+        if(!FlushViewOfFile(data,size)) return false;
+        return is_async || FlushFileBuffers(static_cast<HANDLE>(file));
+#endif
+    }
+
+    MappedView MappedFile::View(size_t offset, size_t length) const {
+        MappedView view;
+        view.data = data;
+        view.size = size;
+        return view.Slice(offset,length);
+    }
+
+} // hzd
@@ -0,0 +1,147 @@
+/**
+  ******************************************************************************
+  * @file           : MappedFile.h
+  * @author         : huzhida
+  * @brief          : 内存映射文件
+  * @date           : 2026/10/18
+  ******************************************************************************
+  */
+
+#ifndef IO_UTILS_MAPPEDFILE_H
+#define IO_UTILS_MAPPEDFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace hzd {
+
+    // 映射模式
+    // map mode
+    enum class MapMode {
+        READ_ONLY,
+        READ_WRITE
+    };
+
+    // 访问模式提示
+    // access pattern advice
+    enum class MapAdvice {
+        NORMAL,
+        SEQUENTIAL,
+        RANDOM,
+        WILLNEED,
+        DONTNEED
+    };
+
+    // 映射配置
+    // map options
+    struct MapOptions {
+        // 映射时预读全部页面(MAP_POPULATE) & populate all pages on map (MAP_POPULATE)
+        bool            is_populate{false};
+        // 透明大页提示(MADV_HUGEPAGE) & transparent huge page hint (MADV_HUGEPAGE)
+        bool            is_huge_page{false};
+        // 读写模式下文件不存在时创建 & create file if not exist in read-write mode
+        bool            is_create{false};
+        // 读写模式下的初始大小,0表示保持文件大小 & initial size in read-write mode,0 for keeping file size
+        size_t          size{0};
+    };
+
+    // 映射区间视图,不拥有内存
+    // view of mapped range,doesn't own memory
+    struct MappedView {
+        const char*     data{nullptr};
+        size_t          size{0};
+
+        /**
+         * 子视图,越界部分被截断 & sub view,clamped to bounds
+         * @param offset 偏移 & offset
+         * @param length 长度 & length
+         */
+        MappedView Slice(size_t offset,size_t length = SIZE_MAX) const;
+        inline std::string ToString() const { return std::string(data,size); }
+    };
+
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+        ~MappedFile();
+        /**
+         * 打开并映射文件 & open and map file
+         * @param path 文件路径 & file path
+         * @param mode 映射模式 & map mode
+         * @param options 映射配置 & map options
+         * @return true表示成功,false表示失败 & true for success,false for failed
+         */
+        bool Open(const std::string& path,MapMode mode = MapMode::READ_ONLY,const MapOptions& options = MapOptions());
+        /**
+         * 解除映射并关闭文件 & unmap and close file
+         */
+        void Close();
+        /**
+         * 设置访问模式提示 & set access pattern advice
+         * @param advice 提示 & advice
+         * @param offset 偏移 & offset
+         * @param length 长度,0表示到末尾 & length,0 for to the end
+         * @return true表示成功,false表示失败 & true for success,false for failed
+         */
+        bool Advise(MapAdvice advice,size_t offset = 0,size_t length = 0);
+        /**
+         * 预先触发缺页,避免后续访问时阻塞 & prefault pages so later access doesn't block
+         * @param offset 偏移 & offset
+         * @param length 长度,0表示到末尾 & length,0 for to the end
+         * @return true表示成功,false表示失败 & true for success,false for failed
+         */
+        bool Prefault(size_t offset = 0,size_t length = 0);
+        /**
+         * 调整文件与映射大小,仅读写模式 & resize file and mapping,read-write mode only
+         * @brief 映射地址可能改变,之前的视图失效 & mapping address may move,previous views are invalidated
+         * @param size 新大小 & new size
+         * @return true表示成功,false表示失败 & true for success,false for failed
+         */
+        bool Resize(size_t size);
+        /**
+         * 将修改写回文件 & flush changes to file
+         * @param is_async 是否异步 & whether async
+         * @return true表示成功,false表示失败 & true for success,false for failed
+         */
+        bool Sync(bool is_async = false);
+        /**
+         * 区间视图 & range view
+         * @param offset 偏移 & offset
+         * @param length 长度 & length
+         */
+        MappedView View(size_t offset = 0,size_t length = SIZE_MAX) const;
+
+        inline const char* Data() const { return data; }
+        inline char* MutableData() { return mode == MapMode::READ_WRITE ? data : nullptr; }
+        inline size_t Size() const { return size; }
+        inline bool IsOpen() const { return is_open; }
+        inline MapMode Mode() const { return mode; }
+#ifdef __linux__
+        inline int Fd() const { return fd; }
+#endif
+    private:
+        bool map_();
+        void unmap_();
+
+        char*           data{nullptr};
+        size_t          size{0};
+        MapMode         mode{MapMode::READ_ONLY};
+        MapOptions      options;
+        bool            is_open{false};
+#ifdef __linux__
+        int             fd{-1};
+#elif _WIN32
+        // 避免在头文件中引入windows.h & avoid including windows.h in header
+        void*           file{nullptr};
+        void*           mapping{nullptr};
+#endif
+    };
+
+} // hzd
+
+#endif //IO_UTILS_MAPPEDFILE_H
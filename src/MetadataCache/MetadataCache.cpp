@@ -0,0 +1,151 @@
+/**
+  ******************************************************************************
+  * @file           : MetadataCache.cpp
+  * @author         : huzhida
+  * @brief          : None
+  * @date           : 2026/10/18
+  ******************************************************************************
+  */
+#ifdef __linux__
+#include <poll.h>
+#endif
+#include <sys/stat.h>
+#include "MetadataCache.h"
+#include <algorithm>
+#include <functional>
+
+namespace hzd {
+
+    static Metadata statPath(const std::string& path) {
+        Metadata metadata;
+        struct stat st{};
+        if(stat(path.c_str(),&st) != 0) return metadata;
+        metadata.is_exist = true;
+        metadata.is_file = (st.st_mode & S_IFMT) == S_IFREG;
+        metadata.is_directory = (st.st_mode & S_IFMT) == S_IFDIR;
+        metadata.size = static_cast<long long>(st.st_size);
+#ifdef __linux__
+        metadata.mtime_ns = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#elif _WIN32
+        metadata.mtime_ns = static_cast<int64_t>(st.st_mtime) * 1000000000;
+#endif
+        return metadata;
+    }
+
+    MetadataCache::MetadataCache(const MetadataCacheOptions &options_) : options(options_) {
+        options.shards = std::max<size_t>(options.shards,1);
+        shard_capacity = std::max<size_t>(options.capacity / options.shards,1);
+        for(size_t i = 0; i < options.shards; i++) shards.emplace_back(new Shard);
+    }
+
+    MetadataCache::~MetadataCache() {
+        is_stop = true;
+        if(watch_thread.joinable()) watch_thread.join();
+    }
+
+    MetadataCache::Shard &MetadataCache::shard_(const std::string &path) {
+        return *shards[std::hash<std::string>()(path) % shards.size()];
+    }
+
+    void MetadataCache::erase_(Shard &shard, std::unordered_map<std::string,Entry>::iterator it) {
+        shard.lru.erase(it->second.lru);
+        shard.entries.erase(it);
+    }
+
+    Metadata MetadataCache::Lookup(const std::string &path) {
+        Shard& shard = shard_(path);
+        auto now = Clock::now();
+        {
+            std::lock_guard<std::mutex> guard(shard.mutex);
+            auto it = shard.entries.find(path);
+            if(it != shard.entries.end() && now < it->second.expire) {
+                shard.lru.splice(shard.lru.begin(),shard.lru,it->second.lru);
+                hits.fetch_add(1,std::memory_order_relaxed);
+                return it->second.metadata;
+            }
+        }
+        misses.fetch_add(1,std::memory_order_relaxed);
+        // stat不持锁,同一路径的并发未命中可能各stat一次 & stat without lock,concurrent misses on one path may each stat once
+        Metadata metadata = statPath(path);
+        uint32_t ttl_ms = metadata.is_exist ? options.ttl_ms : options.negative_ttl_ms;
+        if(ttl_ms == 0) return metadata;
+        std::lock_guard<std::mutex> guard(shard.mutex);
+        auto it = shard.entries.find(path);
+        if(it != shard.entries.end()) erase_(shard,it);
+        while(shard.entries.size() >= shard_capacity) erase_(shard,shard.entries.find(shard.lru.back()));
+        shard.lru.push_front(path);
+        shard.entries.emplace(path,Entry{metadata,now + std::chrono::milliseconds(ttl_ms),shard.lru.begin()});
+        return metadata;
+    }
+
+    void MetadataCache::Invalidate(const std::string &path) {
+        Shard& shard = shard_(path);
+        std::lock_guard<std::mutex> guard(shard.mutex);
+        auto it = shard.entries.find(path);
+        if(it != shard.entries.end()) erase_(shard,it);
+    }
+
+    void MetadataCache::InvalidatePrefix(const std::string &path) {
+        std::string prefix = path;
+        if(prefix.empty() || prefix.back() != '/') prefix += '/';
+        for(auto& shard : shards) {
+            std::lock_guard<std::mutex> guard(shard->mutex);
+            for(auto it = shard->entries.begin(); it != shard->entries.end();) {
+                auto next = std::next(it);
+                if(it->first == path || it->first.compare(0,prefix.size(),prefix) == 0) erase_(*shard,it);
+                it = next;
+            }
+        }
+    }
+
+    void MetadataCache::Clear() {
+        for(auto& shard : shards) {
+            std::lock_guard<std::mutex> guard(shard->mutex);
+            shard->entries.clear();
+            shard->lru.clear();
+        }
+    }
+
+    size_t MetadataCache::Count() const {
+        size_t size = 0;
+        for(const auto& shard : shards) {
+            std::lock_guard<std::mutex> guard(shard->mutex);
+            size += shard->entries.size();
+        }
+        return size;
+    }
+
+    bool MetadataCache::Watch(const std::string &path) {
+        std::lock_guard<std::mutex> guard(watch_mutex);
+        if(watcher.Fd() < 0) {
+            bool ret = watcher.Open([this](const WatchEvent& event) {
+                if(event.mask & WATCH_OVERFLOW) {
+                    Clear();
+                }else if(event.is_dir && (event.mask & (WATCH_DELETE | WATCH_MOVE))) {
+                    InvalidatePrefix(event.path);
+                }else {
+                    Invalidate(event.path);
+                }
+            });
+            if(!ret) return false;
+        }
+        if(!watcher.Add(path)) return false;
+        // 监视建立前缓存的条目可能已过时 & entries cached before the watch existed may be stale
+        InvalidatePrefix(path);
+        if(!watch_thread.joinable()) watch_thread = std::thread(&MetadataCache::runWatch_,this);
+        return true;
+    }
+
+    void MetadataCache::runWatch_() {
+#ifdef __linux__
+        // 短超时以便及时响应析构 & short timeout to notice destruction promptly
+        struct pollfd poll_fd{watcher.Fd(),POLLIN,0};
+        while(!is_stop.load(std::memory_order_relaxed)) {
+            if(poll(&poll_fd,1,100) <= 0) continue;
+            std::lock_guard<std::mutex> guard(watch_mutex);
+            watcher.Dispatch();
+        }
+#endif
+    }
+
+} // hzd
@@ -0,0 +1,126 @@
+/**
+  ******************************************************************************
+  * @file           : MetadataCache.h
+  * @author         : huzhida
+  * @brief          : 文件元数据缓存
+  * @date           : 2026/10/18
+  ******************************************************************************
+  */
+
+#ifndef IO_UTILS_METADATACACHE_H
+#define IO_UTILS_METADATACACHE_H
+
+#include "../FileWatcher/FileWatcher.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace hzd {
+
+    // 元数据缓存配置
+    // metadata cache options
+    struct MetadataCacheOptions {
+        // 最多缓存的路径数 & max cached paths
+        size_t          capacity{16384};
+        // 分片数,降低锁竞争 & shard count,reduces lock contention
+        size_t          shards{16};
+        // 存在路径的有效期(ms) & ttl of existing paths (ms)
+        uint32_t        ttl_ms{1000};
+        // 不存在路径的有效期(ms),0表示不缓存 & ttl of missing paths (ms),0 for not cached
+        uint32_t        negative_ttl_ms{1000};
+    };
+
+    // 缓存的元数据,跟随符号链接,与filesystem::exists等语义一致
+    // cached metadata,follows symlinks,same semantics as filesystem::exists etc.
+    struct Metadata {
+        bool            is_exist{false};
+        bool            is_file{false};
+        bool            is_directory{false};
+        // 文件大小,不存在时为-1 & file size,-1 if not exist
+        long long       size{-1};
+        // 修改时间(ns) & modify time (ns)
+        int64_t         mtime_ns{0};
+    };
+
+    // 位于filesystem::exists/is_file/is_directory/fsize之前的有界并发缓存
+    // bounded concurrent cache in front of filesystem::exists/is_file/is_directory/fsize
+    class MetadataCache {
+    public:
+        explicit MetadataCache(const MetadataCacheOptions& options = MetadataCacheOptions());
+        MetadataCache(const MetadataCache&) = delete;
+        MetadataCache& operator=(const MetadataCache&) = delete;
+        ~MetadataCache();
+        /**
+         * 查询元数据,未命中或过期时stat一次 & look up metadata,stat once on miss or expiry
+         * @param path 路径 & path
+         */
+        Metadata Lookup(const std::string& path);
+        inline bool Exists(const std::string& path) { return Lookup(path).is_exist; }
+        inline bool IsFile(const std::string& path) { return Lookup(path).is_file; }
+        inline bool IsDirectory(const std::string& path) { return Lookup(path).is_directory; }
+        inline long long Size(const std::string& path) { return Lookup(path).size; }
+        /**
+         * 使单个路径失效 & invalidate one path
+         */
+        void Invalidate(const std::string& path);
+        /**
+         * 使路径及其下所有路径失效 & invalidate path and everything under it
+         */
+        void InvalidatePrefix(const std::string& path);
+        /**
+         * 清空缓存 & clear cache
+         */
+        void Clear();
+        /**
+         * 通过inotify监视目录,变化时立即失效,由后台线程驱动 & watch dir via inotify and invalidate on change,driven by a background thread
+         * @brief 路径需与查询时使用的前缀一致 & path must use the same prefix as lookups
+         * @param path 目录路径 & dir path
+         * @return true表示成功,false表示失败 & true for success,false for failed
+         */
+        bool Watch(const std::string& path);
+        inline uint64_t Hits() const { return hits.load(std::memory_order_relaxed); }
+        inline uint64_t Misses() const { return misses.load(std::memory_order_relaxed); }
+        /**
+         * 当前缓存的路径数 & number of cached paths
+         */
+        size_t Count() const;
+    private:
+        using Clock = std::chrono::steady_clock;
+        struct Entry {
+            Metadata                            metadata;
+            Clock::time_point                   expire;
+            std::list<std::string>::iterator    lru;
+        };
+        struct Shard {
+            mutable std::mutex                          mutex;
+            std::unordered_map<std::string,Entry>       entries;
+            // 最近使用的在前 & most recently used first
+            std::list<std::string>                      lru;
+        };
+
+        Shard& shard_(const std::string& path);
+        void erase_(Shard& shard,std::unordered_map<std::string,Entry>::iterator it);
+        void runWatch_();
+
+        MetadataCacheOptions                    options;
+        size_t                                  shard_capacity{0};
+        std::vector<std::unique_ptr<Shard>>     shards;
+        std::atomic<uint64_t>                   hits{0};
+        std::atomic<uint64_t>                   misses{0};
+        // inotify失效 & inotify invalidation
+        FileWatcher                             watcher;
+        std::mutex                              watch_mutex;
+        std::thread                             watch_thread;
+        std::atomic<bool>                       is_stop{false};
+    };
+
+} // hzd
+
+#endif //IO_UTILS_METADATACACHE_H
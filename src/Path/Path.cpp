@@ -0,0 +1,270 @@
+/**
+  ******************************************************************************
+  * @file           : Path.cpp
+  * @author         : huzhida
+  * @brief          : None
+  * @date           : 2026/10/18
+  ******************************************************************************
+  */
+#ifdef __linux__
+#include <unistd.h>
+#include <cerrno>
+#include <cstdlib>
+#elif _WIN32
+#include <direct.h>
+#include <cstdlib>
+#endif
+#include <Mole.h>
+#include "Path.h"
+#include <algorithm>
+
+namespace hzd {
+
+    const std::string io_path_channel = "io.Path";
+
+    Path::Path(const char *path) : Path(path,strlen(path)) {}
+
+    Path::Path(const char *path, size_t size) {
+        local[0] = '\0';
+        Assign(path,size);
+    }
+
+    Path::Path(const std::string &path) : Path(path.data(),path.size()) {}
+
+    Path::Path(const Path &other) : Path(other.CStr(),other.length) {}
+
+    Path::Path(Path &&other) noexcept {
+        local[0] = '\0';
+        *this = std::move(other);
+    }
+
+    Path &Path::operator=(const Path &other) {
+        if(this != &other) Assign(other.CStr(),other.length);
+        return *this;
+    }
+
+    Path &Path::operator=(Path &&other) noexcept {
+        if(this == &other) return *this;
+        if(other.heap) {
+            // 接管堆内存 & take over heap memory
+            delete[] heap;
+            heap = other.heap;
+            length = other.length;
+            capacity = other.capacity;
+            other.heap = nullptr;
+            other.capacity = inline_capacity;
+        }else {
+            Assign(other.local,other.length);
+        }
+        other.length = 0;
+        other.local[0] = '\0';
+        return *this;
+    }
+
+    Path::~Path() {
+        delete[] heap;
+    }
+
+    void Path::Clear() {
+        length = 0;
+        data_()[0] = '\0';
+    }
+
+    void Path::Reserve(size_t capacity_) {
+        if(capacity_ <= capacity) return;
+        capacity_ = std::max(capacity_,capacity * 2);
+        char* buffer = new char[capacity_ + 1];
+        memcpy(buffer,CStr(),length + 1);
+        delete[] heap;
+        heap = buffer;
+        capacity = capacity_;
+    }
+
+    void Path::Assign(const char *path, size_t size) {
+        Reserve(size);
+        // path可能指向自身 & path may point into self
+        memmove(data_(),path,size);
+        length = size;
+        data_()[length] = '\0';
+    }
+
+    Path &Path::Append(const char *name, size_t size) {
+        while(size > 0 && *name == '/') {
+            name++;
+            size--;
+        }
+        if(size == 0) return *this;
+        // name可能指向自身(如p.Append(p.Filename())),扩容会释放旧缓冲区,先记下偏移 & name may point into self (e.g. p.Append(p.Filename())),growing frees the old buffer,so remember the offset first
+        const char* old_buffer = CStr();
+        bool is_self = name >= old_buffer && name <= old_buffer + length;
+        size_t self_offset = is_self ? static_cast<size_t>(name - old_buffer) : 0;
+        bool is_separator = length > 0 && data_()[length - 1] != '/';
+        Reserve(length + size + (is_separator ? 1 : 0));
+        char* buffer = data_();
+        if(is_self) name = buffer + self_offset;
+        if(is_separator) buffer[length++] = '/';
+        memmove(buffer + length,name,size);
+        length += size;
+        buffer[length] = '\0';
+        return *this;
+    }
+
+    void Path::PopBack() {
+        const char* buffer = CStr();
+        size_t pos = length;
+        while(pos > 0 && buffer[pos - 1] != '/') pos--;
+        // 保留根目录的'/' & keep '/' of root
+        length = pos > 1 ? pos - 1 : pos;
+        data_()[length] = '\0';
+    }
+
+    Path &Path::Normalize() {
+        char* buffer = data_();
+        size_t write = 0;
+        for(size_t read = 0; read < length; read++) {
+            char ch = buffer[read] == '\\' ? '/' : buffer[read];
+            if(ch == '/' && write > 0 && buffer[write - 1] == '/') continue;
+            buffer[write++] = ch;
+        }
+        while(write > 1 && buffer[write - 1] == '/') write--;
+        length = write;
+        buffer[length] = '\0';
+        return *this;
+    }
+
+    PathView Path::Filename() const {
+        const char* buffer = CStr();
+        size_t pos = length;
+        while(pos > 0 && buffer[pos - 1] != '/') pos--;
+        return PathView(buffer + pos,length - pos);
+    }
+
+    PathView Path::Parent() const {
+        const char* buffer = CStr();
+        size_t pos = length;
+        while(pos > 0 && buffer[pos - 1] != '/') pos--;
+        if(pos == 0) return PathView(".",1);
+        if(pos == 1) return PathView(buffer,1);
+        return PathView(buffer,pos - 1);
+    }
+
+    PathView Path::Extension() const {
+        PathView name = Filename();
+        for(size_t pos = name.size; pos > 1; pos--) {
+            if(name.data[pos - 1] == '.') return PathView(name.data + pos - 1,name.size - pos + 1);
+        }
+        return PathView(name.data + name.size,0);
+    }
+
+    bool Path::Current(Path &path) {
+#ifdef __linux__
+        // getcwd(nullptr,0)按实际长度分配 & getcwd(nullptr,0) allocates the exact length
+        char* cwd = getcwd(nullptr,0);
+#elif _WIN32
+        char* cwd = _getcwd(nullptr,0);
+#endif
+        if(!cwd) {
+            MOLE_ERROR(io_path_channel,strerror(errno));
+            return false;
+        }
+        path.Assign(cwd,strlen(cwd));
+        free(cwd);
+        return true;
+    }
+
+    Path operator/(const Path &path, const char *name) {
+        Path ret(path);
+        ret /= name;
+        return ret;
+    }
+
+    Path operator/(const Path &path, const std::string &name) {
+        Path ret(path);
+        ret /= name;
+        return ret;
+    }
+
+    static uint64_t hashName(uint32_t parent,const char* name,size_t size) {
+        // FNV-1a,以父节点id为种子 & FNV-1a seeded with parent id
+        uint64_t hash = 14695981039346656037ULL ^ parent;
+        for(size_t i = 0; i < size; i++) {
+            hash ^= static_cast<unsigned char>(name[i]);
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    PathInterner::PathInterner(const std::string &root) {
+        nodes.push_back(Node{root_id,static_cast<uint32_t>(root.size()),store_(root.data(),root.size())});
+    }
+
+    const char *PathInterner::store_(const char *name, size_t size) {
+        name_bytes += size;
+        if(size > block_size / 4) {
+            // 长名字单独分配,插在当前块之前以免浪费当前块剩余空间 & long names get their own allocation,inserted before the current block so its free space isn't wasted
+            std::unique_ptr<char[]> block(new char[size]);
+            memcpy(block.get(),name,size);
+            const char* dest = block.get();
+            blocks.insert(blocks.empty() ? blocks.end() : blocks.end() - 1,std::move(block));
+            return dest;
+        }
+        if(block_used + size > block_size) {
+            blocks.emplace_back(new char[block_size]);
+            block_used = 0;
+        }
+        char* dest = blocks.back().get() + block_used;
+        if(size > 0) memcpy(dest,name,size);
+        block_used += size;
+        return dest;
+    }
+
+    uint32_t PathInterner::Intern(uint32_t parent, const char *name, size_t size) {
+        uint64_t hash = hashName(parent,name,size);
+        std::lock_guard<std::mutex> guard(mutex);
+        auto range = index.equal_range(hash);
+        for(auto it = range.first; it != range.second; ++it) {
+            const Node& node = nodes[it->second];
+            if(node.parent == parent && node.size == size && memcmp(node.name,name,size) == 0) return it->second;
+        }
+        auto id = static_cast<uint32_t>(nodes.size());
+        nodes.push_back(Node{parent,static_cast<uint32_t>(size),store_(name,size)});
+        index.emplace(hash,id);
+        return id;
+    }
+
+    void PathInterner::Resolve(uint32_t id, Path &path) const {
+        path.Clear();
+        thread_local std::vector<uint32_t> chain;
+        chain.clear();
+        std::lock_guard<std::mutex> guard(mutex);
+        if(id >= nodes.size()) {
+            MOLE_ERROR(io_path_channel,"invalid path id",{ MOLE_VAR(id) });
+            return;
+        }
+        for(; id != root_id; id = nodes[id].parent) chain.push_back(id);
+        path.Assign(nodes[root_id].name,nodes[root_id].size);
+        for(auto it = chain.rbegin(); it != chain.rend(); ++it) path.Append(nodes[*it].name,nodes[*it].size);
+    }
+
+    PathView PathInterner::Name(uint32_t id) const {
+        std::lock_guard<std::mutex> guard(mutex);
+        if(id >= nodes.size()) return PathView();
+        return PathView(nodes[id].name,nodes[id].size);
+    }
+
+    uint32_t PathInterner::Parent(uint32_t id) const {
+        std::lock_guard<std::mutex> guard(mutex);
+        return id < nodes.size() ? nodes[id].parent : root_id;
+    }
+
+    size_t PathInterner::Count() const {
+        std::lock_guard<std::mutex> guard(mutex);
+        return nodes.size();
+    }
+
+    size_t PathInterner::NameBytes() const {
+        std::lock_guard<std::mutex> guard(mutex);
+        return name_bytes;
+    }
+
+} // hzd
@@ -0,0 +1,193 @@
+/**
+  ******************************************************************************
+  * @file           : Path.h
+  * @author         : huzhida
+  * @brief          : 小缓冲路径与目录前缀驻留
+  * @date           : 2026/10/18
+  ******************************************************************************
+  */
+
+#ifndef IO_UTILS_PATH_H
+#define IO_UTILS_PATH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace hzd {
+
+    // 路径片段视图,不持有内存,所指路径修改后失效
+    // path piece view,owns no memory,invalidated when the viewed path changes
+    struct PathView {
+        const char*     data{""};
+        size_t          size{0};
+
+        PathView() = default;
+        PathView(const char* data_,size_t size_) : data(data_),size(size_) {}
+        inline bool Empty() const { return size == 0; }
+        inline std::string String() const { return std::string(data,size); }
+        inline bool operator==(const PathView& other) const { return size == other.size && memcmp(data,other.data,size) == 0; }
+        inline bool operator!=(const PathView& other) const { return !(*this == other); }
+        inline bool operator==(const char* other) const { return *this == PathView(other,strlen(other)); }
+        inline bool operator!=(const char* other) const { return !(*this == other); }
+    };
+
+    // 路径,短路径存放于对象内部不分配堆内存,分隔符统一为'/'
+    // path,short paths live inside the object without heap allocation,separator is always '/'
+    class Path {
+    public:
+        // 内联容量,覆盖绝大多数路径 & inline capacity,covers most paths
+        static const size_t inline_capacity = 119;
+
+        Path() { local[0] = '\0'; }
+        Path(const char* path);
+        Path(const char* path,size_t size);
+        Path(const std::string& path);
+        Path(const Path& other);
+        Path(Path&& other) noexcept;
+        Path& operator=(const Path& other);
+        Path& operator=(Path&& other) noexcept;
+        ~Path();
+
+        inline const char* CStr() const { return heap ? heap : local; }
+        inline size_t Size() const { return length; }
+        inline bool Empty() const { return length == 0; }
+        inline bool IsHeap() const { return heap != nullptr; }
+        inline PathView View() const { return PathView(CStr(),length); }
+        inline std::string String() const { return std::string(CStr(),length); }
+        inline bool operator==(const Path& other) const { return View() == other.View(); }
+        inline bool operator!=(const Path& other) const { return View() != other.View(); }
+
+        /**
+         * 清空,保留已分配的容量 & clear,keeping allocated capacity
+         */
+        void Clear();
+        /**
+         * 替换内容 & replace content
+         * @param path 路径 & path
+         * @param size 路径长度 & path length
+         */
+        void Assign(const char* path,size_t size);
+        /**
+         * 以'/'拼接一级,不重复分隔符 & join one level with '/',without doubling separators
+         * @param name 名字 & name
+         * @param size 名字长度 & name length
+         * @return 自身 & self
+         */
+        Path& Append(const char* name,size_t size);
+        inline Path& Append(const PathView& name) { return Append(name.data,name.size); }
+        inline Path& operator/=(const char* name) { return Append(name,strlen(name)); }
+        inline Path& operator/=(const std::string& name) { return Append(name.data(),name.size()); }
+        inline Path& operator/=(const PathView& name) { return Append(name.data,name.size); }
+        /**
+         * 去掉最后一级,与Append配对用于深度优先遍历时复用同一对象 & drop last level,paired with Append to reuse one object in depth-first walks
+         */
+        void PopBack();
+        /**
+         * 原地规范化:'\\'转为'/',合并连续分隔符,去掉末尾分隔符 & normalize in place: '\\' to '/',merge repeated separators,strip trailing separator
+         * @return 自身 & self
+         */
+        Path& Normalize();
+        /**
+         * 最后一级的名字 & name of last level
+         */
+        PathView Filename() const;
+        /**
+         * 所在目录,无目录部分时为"." & parent dir,"." when path has no dir part
+         */
+        PathView Parent() const;
+        /**
+         * 扩展名,含'.',无扩展名或以'.'开头的名字为空 & extension including '.',empty for no extension or names starting with '.'
+         */
+        PathView Extension() const;
+        /**
+         * 预留容量 & reserve capacity
+         * @param capacity 容量 & capacity
+         */
+        void Reserve(size_t capacity);
+
+        /**
+         * 当前工作目录,不受固定缓冲区长度限制 & current working dir,not limited by a fixed buffer
+         * @param path 当前工作目录 & current working dir
+         * @return true表示成功,false表示失败 & true for success,false for failed
+         */
+        static bool Current(Path& path);
+    private:
+        inline char* data_() { return heap ? heap : local; }
+
+        char*       heap{nullptr};
+        size_t      length{0};
+        size_t      capacity{inline_capacity};
+        char        local[inline_capacity + 1];
+    };
+
+    Path operator/(const Path& path,const char* name);
+    Path operator/(const Path& path,const std::string& name);
+
+    // 目录前缀驻留表,每个目录只保存(父目录id,名字),树遍历中深层路径不再重复存储前缀,线程安全
+    // dir prefix interning table,each dir stores only (parent id,name),so deep paths in tree walks don't repeat prefixes,thread safe
+    class PathInterner {
+    public:
+        // 根节点id,对应构造时给出的根路径 & root node id,maps to root path given at construction
+        static const uint32_t root_id = 0;
+
+        explicit PathInterner(const std::string& root = std::string());
+        PathInterner(const PathInterner&) = delete;
+        PathInterner& operator=(const PathInterner&) = delete;
+        /**
+         * 驻留parent下的名字,已存在时返回原id & intern name under parent,returns existing id when present
+         * @param parent 父节点id & parent node id
+         * @param name 名字 & name
+         * @param size 名字长度 & name length
+         * @return 节点id & node id
+         */
+        uint32_t Intern(uint32_t parent,const char* name,size_t size);
+        inline uint32_t Intern(uint32_t parent,const std::string& name) { return Intern(parent,name.data(),name.size()); }
+        /**
+         * 还原完整路径,复用path的容量 & rebuild full path,reusing capacity of path
+         * @param id 节点id & node id
+         * @param path 完整路径 & full path
+         */
+        void Resolve(uint32_t id,Path& path) const;
+        /**
+         * 节点名字,驻留表存在期间有效 & node name,valid while the interner lives
+         */
+        PathView Name(uint32_t id) const;
+        /**
+         * 父节点id,根节点返回自身 & parent node id,root returns itself
+         */
+        uint32_t Parent(uint32_t id) const;
+        /**
+         * 节点数,含根节点 & node count,including root
+         */
+        size_t Count() const;
+        /**
+         * 名字占用的字节数 & bytes used by names
+         */
+        size_t NameBytes() const;
+    private:
+        struct Node {
+            uint32_t        parent;
+            uint32_t        size;
+            const char*     name;
+        };
+        // 名字存放于只追加的内存块中,地址稳定 & names live in append-only blocks with stable addresses
+        const char* store_(const char* name,size_t size);
+
+        static const size_t                         block_size = 64 * 1024;
+        mutable std::mutex                          mutex;
+        std::vector<Node>                           nodes;
+        std::unordered_multimap<uint64_t,uint32_t>  index;
+        std::vector<std::unique_ptr<char[]>>        blocks;
+        size_t                                      block_used{block_size};
+        size_t                                      name_bytes{0};
+    };
+
+} // hzd
+
+#endif //IO_UTILS_PATH_H
@@ -0,0 +1,148 @@
+/**
+  ******************************************************************************
+  * @file           : Endpoint.cpp
+  * @author         : huzhida
+  * @brief          : None
+  * @date           : 2026/10/18
+  ******************************************************************************
+  */
+#ifdef __linux__
+#include <sys/un.h>
+#include <cstring>
+#elif _WIN32
+#define _CRT_SECURE_NO_WARNINGS
+#include <WS2tcpip.h>
+#endif
+#include <Mole.h>
+#include "Endpoint.h"
+#include <cstddef>
+
+namespace hzd {
+
+    const std::string io_endpoint_channel = "io.Endpoint";
+
+    Endpoint::Endpoint(const sockaddr_in &addr) {
+        memcpy(&storage,&addr,sizeof(addr));
+        size = sizeof(addr);
+    }
+
+    Endpoint::Endpoint(const sockaddr_in6 &addr) {
+        memcpy(&storage,&addr,sizeof(addr));
+        size = sizeof(addr);
+    }
+
+    Endpoint::Endpoint(const sockaddr *addr, socklen_t size_) {
+        if(!addr || size_ <= 0 || static_cast<size_t>(size_) > sizeof(storage)) return;
+        memcpy(&storage,addr,size_);
+        size = size_;
+    }
+
+    bool Endpoint::Parse(const std::string &ip, unsigned short port, Endpoint &endpoint) {
+        sockaddr_in addr4{};
+        if(inet_pton(AF_INET,ip.c_str(),&addr4.sin_addr) == 1) {
+            addr4.sin_family = AF_INET;
+            addr4.sin_port = htons(port);
+            endpoint = Endpoint(addr4);
+            return true;
+        }
+        sockaddr_in6 addr6{};
+        if(inet_pton(AF_INET6,ip.c_str(),&addr6.sin6_addr) == 1) {
+            addr6.sin6_family = AF_INET6;
+            addr6.sin6_port = htons(port);
+            endpoint = Endpoint(addr6);
+            return true;
+        }
+        MOLE_ERROR(io_endpoint_channel,"invalid ip address",{ MOLE_VAR(ip) });
+        return false;
+    }
+
+    Endpoint Endpoint::Of(const std::string &ip, unsigned short port) {
+        Endpoint endpoint;
+        Parse(ip,port,endpoint);
+        return endpoint;
+    }
+
+    Endpoint Endpoint::Unix(const std::string &path) {
+        Endpoint endpoint;
+#ifdef __linux__
+        sockaddr_un addr{};
+        if(path.empty() || path.size() >= sizeof(addr.sun_path)) {
+            MOLE_ERROR(io_endpoint_channel,"invalid unix socket path",{ MOLE_VAR(path) });
+            return endpoint;
+        }
+        addr.sun_family = AF_UNIX;
+        memcpy(addr.sun_path,path.data(),path.size());
+        socklen_t size = static_cast<socklen_t>(offsetof(sockaddr_un,sun_path) + path.size());
+        if(path[0] == '@') {
+            // 抽象命名空间以'\0'开头且不以'\0'结尾 & abstract namespace starts with '\0' and is not terminated
+            addr.sun_path[0] = '\0';
+        }else {
+            size += 1;
+        }
+        endpoint = Endpoint((const sockaddr*)&addr,size);
+#elif _WIN32
+        MOLE_ERROR(io_endpoint_channel,"unix socket not supported on this platform");
+#endif
+        return endpoint;
+    }
+
+    bool Endpoint::IsUnix() const {
+#ifdef __linux__
+        return Family() == AF_UNIX;
+#elif _WIN32
+        return false;
+#endif
+    }
+
+    unsigned short Endpoint::Port() const {
+        if(IsV4()) return ntohs(reinterpret_cast<const sockaddr_in*>(&storage)->sin_port);
+        if(IsV6()) return ntohs(reinterpret_cast<const sockaddr_in6*>(&storage)->sin6_port);
+        return 0;
+    }
+
+    std::string Endpoint::Ip() const {
+        char buffer[INET6_ADDRSTRLEN] = {0};
+        if(IsV4()) {
+            inet_ntop(AF_INET,(void*)&reinterpret_cast<const sockaddr_in*>(&storage)->sin_addr,buffer,sizeof(buffer));
+            return buffer;
+        }
+        if(IsV6()) {
+            inet_ntop(AF_INET6,(void*)&reinterpret_cast<const sockaddr_in6*>(&storage)->sin6_addr,buffer,sizeof(buffer));
+            return buffer;
+        }
+#ifdef __linux__
+        if(IsUnix()) {
+            auto addr = reinterpret_cast<const sockaddr_un*>(&storage);
+            size_t length = size > offsetof(sockaddr_un,sun_path) ? size - offsetof(sockaddr_un,sun_path) : 0;
+            if(length == 0) return "";
+            if(addr->sun_path[0] == '\0') return "@" + std::string(addr->sun_path + 1,length - 1);
+            return std::string(addr->sun_path,strnlen(addr->sun_path,length));
+        }
+#endif
+        return "";
+    }
+
+    std::string Endpoint::ToString() const {
+        if(IsV4()) return Ip() + ":" + std::to_string(Port());
+        if(IsV6()) return "[" + Ip() + "]:" + std::to_string(Port());
+        if(IsUnix()) return "unix:" + Ip();
+        return "";
+    }
+
+    Endpoint Endpoint::ToV4Mapped() const {
+        if(!IsV4()) return *this;
+        auto addr4 = reinterpret_cast<const sockaddr_in*>(&storage);
+        sockaddr_in6 addr6{};
+        addr6.sin6_family = AF_INET6;
+        addr6.sin6_port = addr4->sin_port;
+        auto bytes = reinterpret_cast<unsigned char*>(&addr6.sin6_addr);
+        bytes[10] = 0xff;
+        bytes[11] = 0xff;
+        memcpy(bytes + 12,&addr4->sin_addr,4);
+        return Endpoint(addr6);
+    }
+
+    bool Endpoint::operator==(const Endpoint &other) const {
+        return size == other.size && memcmp(&storage,&other.storage,size) == 0;
+    }
+} // hzd
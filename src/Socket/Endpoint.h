@@ -0,0 +1,101 @@
+/**
+  ******************************************************************************
+  * @file           : Endpoint.h
+  * @author         : huzhida
+  * @brief          : 预解析的套接字地址(IPv4/IPv6/Unix)
+  * @date           : 2026/10/18
+  ******************************************************************************
+  */
+
+#ifndef IO_UTILS_ENDPOINT_H
+#define IO_UTILS_ENDPOINT_H
+
+#include <string>
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#elif _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#endif
+
+namespace hzd {
+    // 预解析的套接字地址,一次解析后可在热路径上反复使用
+    // pre-resolved socket address,parse once and reuse on hot paths
+    class Endpoint {
+    public:
+        Endpoint() = default;
+        /**
+         * 从IPv4地址构造 & construct from IPv4 address
+         */
+        Endpoint(const sockaddr_in& addr);
+        /**
+         * 从IPv6地址构造 & construct from IPv6 address
+         */
+        Endpoint(const sockaddr_in6& addr);
+        /**
+         * 从任意地址构造 & construct from any address
+         * @param addr 地址 & address
+         * @param size 地址长度 & address size
+         */
+        Endpoint(const sockaddr* addr,socklen_t size);
+        /**
+         * 解析IP和端口,支持IPv4与IPv6 & parse ip and port,IPv4 and IPv6 supported
+         * @param ip 点分十进制或IPv6文本 & dotted decimal or IPv6 text
+         * @param port 端口 & port
+         * @param endpoint 解析结果 & parse result
+         * @return true表示成功,false表示失败 & true for success,false for failed
+         */
+        static bool Parse(const std::string& ip,unsigned short port,Endpoint& endpoint);
+        /**
+         * 解析IP和端口,失败时返回无效地址 & parse ip and port,invalid endpoint returned on failure
+         */
+        static Endpoint Of(const std::string& ip,unsigned short port);
+        /**
+         * Unix域套接字地址,以'@'开头表示抽象命名空间 & unix domain address,leading '@' for abstract namespace
+         * @param path 套接字路径 & socket path
+         */
+        static Endpoint Unix(const std::string& path);
+
+        inline int Family() const { return storage.ss_family; }
+        inline bool Valid() const { return size != 0; }
+        inline bool IsV4() const { return Family() == AF_INET; }
+        inline bool IsV6() const { return Family() == AF_INET6; }
+        bool IsUnix() const;
+        inline const sockaddr* Addr() const { return reinterpret_cast<const sockaddr*>(&storage); }
+        inline socklen_t Size() const { return size; }
+        /**
+         * 供recvfrom/accept写入的地址 & address for recvfrom/accept to fill
+         */
+        inline sockaddr* MutableAddr() { return reinterpret_cast<sockaddr*>(&storage); }
+        /**
+         * 供recvfrom/accept写入的长度,调用时重置为最大容量 & size for recvfrom/accept to fill,reset to capacity on call
+         */
+        inline socklen_t* MutableSize() { size = sizeof(storage); return &size; }
+        /**
+         * @return 端口,Unix地址为0 & port,0 for unix address
+         */
+        unsigned short Port() const;
+        /**
+         * @return IP文本或Unix路径 & ip text or unix path
+         */
+        std::string Ip() const;
+        /**
+         * @return ip:port / [ip]:port / unix:path
+         */
+        std::string ToString() const;
+        /**
+         * 转为IPv4映射的IPv6地址,用于双栈套接字 & convert to IPv4-mapped IPv6 address,for dual-stack sockets
+         */
+        Endpoint ToV4Mapped() const;
+
+        bool operator==(const Endpoint& other) const;
+        inline bool operator!=(const Endpoint& other) const { return !(*this == other); }
+    private:
+        sockaddr_storage    storage{};
+        socklen_t           size{0};
+    };
+} // hzd
+
+#endif //IO_UTILS_ENDPOINT_H
@@ -11,6 +11,13 @@
 #include <cstring>
 #include <sys/sendfile.h>
 #include <sys/stat.h>
+#include <sys/ioctl.h>
+#include <poll.h>
+#include <sched.h>
+#include <netinet/tcp.h>
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+#include <linux/sockios.h>
 #elif _WIN32
 #define _CRT_SECURE_NO_WARNINGS
 #define _WINSOCK_DEPRECATED_NO_WARNINGS
@@ -18,12 +25,28 @@
 #endif
 #include <Mole.h>
 #include "Socket.h"
+#include "../FileSystem/FileSystem.h"
+#include "../FileWriter/FileWriter.h"
+#include "../Checksum/Checksum.h"
 #include <fstream>
+#include <chrono>
+#include <algorithm>
+#include <thread>
 
 
 namespace hzd {
     
     const std::string io_socket_channel = "io.Socket";
+
+#ifdef IO_UTILS_SOCKET_METRICS
+#define IO_METRICS_BEGIN() uint64_t metrics_begin_ = SocketMetrics::Now()
+#define IO_METRICS_SEND(requested,ret) do { int err_ = errno; metrics.RecordSend(requested,ret,err_,SocketMetrics::Now() - metrics_begin_); errno = err_; } while(0)
+#define IO_METRICS_RECV(requested,ret) do { int err_ = errno; metrics.RecordRecv(requested,ret,err_,SocketMetrics::Now() - metrics_begin_); errno = err_; } while(0)
+#else
+#define IO_METRICS_BEGIN() do {} while(0)
+#define IO_METRICS_SEND(requested,ret) do {} while(0)
+#define IO_METRICS_RECV(requested,ret) do {} while(0)
+#endif
     
 #ifdef _WIN32
     std::string GetWASockError() noexcept {
@@ -38,6 +61,144 @@ namespace hzd {
     }
 #endif
 
+    static uint64_t steadyNs() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // 稀疏文件传输头部魔数"HZDSPARS" & sparse transfer header magic "HZDSPARS"
+    static const uint64_t sparse_magic = 0x485A445350415253ULL;
+    // 单次传输允许的最大区段数 & max extents allowed in one transfer
+    static const uint64_t sparse_max_extents = 1 << 20;
+
+    static void encodeU64(uint64_t value,char* out) {
+        for(int i = 7; i >= 0; i--) {
+            out[i] = static_cast<char>(value & 0xff);
+            value >>= 8;
+        }
+    }
+
+    static uint64_t decodeU64(const char* in) {
+        uint64_t value = 0;
+        for(int i = 0; i < 8; i++) value = (value << 8) | static_cast<unsigned char>(in[i]);
+        return value;
+    }
+
+    // 等待socket可读或可写,非阻塞socket上代替忙等 & wait until socket is readable or writable,instead of spinning on non-blocking sockets
+    static bool waitSocket(SOCKET sock,short events) {
+        pollfd poll_fd{};
+        poll_fd.fd = sock;
+        poll_fd.events = events;
+        while(true) {
+#ifdef __linux__
+            int ret = poll(&poll_fd,1,-1);
+            if(ret < 0 && errno == EINTR) continue;
+#elif _WIN32
+            int ret = WSAPoll(&poll_fd,1,-1);
+#endif
+            if(ret < 0) {
+                MOLE_ERROR(io_socket_channel,strerror(errno));
+                return false;
+            }
+            return true;
+        }
+    }
+
+    // 阻塞发送全部数据,对端关闭时返回失败而不触发SIGPIPE & send all data blocking,fails instead of raising SIGPIPE when peer closed
+    static bool sendAll(SOCKET sock,const char* data,size_t size) {
+#ifdef __linux__
+        const int flag = MSG_NOSIGNAL;
+#elif _WIN32
+        const int flag = 0;
+#endif
+        size_t cursor = 0;
+        while(cursor < size) {
+            auto ret = ::send(sock,data + cursor,static_cast<int>(size - cursor),flag);
+            if(ret < 0) {
+                if(errno == EINTR) continue;
+                if(errno == EAGAIN || errno == EWOULDBLOCK) {
+                    if(!waitSocket(sock,POLLOUT)) return false;
+                    continue;
+                }
+                MOLE_ERROR(io_socket_channel,strerror(errno));
+                return false;
+            }
+            cursor += ret;
+        }
+        return true;
+    }
+
+    // 阻塞接收指定长度数据 & recv exact size blocking
+    static bool recvAll(SOCKET sock,char* data,size_t size) {
+        size_t cursor = 0;
+        while(cursor < size) {
+            auto ret = ::recv(sock,data + cursor,static_cast<int>(size - cursor),0);
+            if(ret < 0) {
+                if(errno == EINTR) continue;
+                if(errno == EAGAIN || errno == EWOULDBLOCK) {
+                    if(!waitSocket(sock,POLLIN)) return false;
+                    continue;
+                }
+                MOLE_ERROR(io_socket_channel,strerror(errno));
+                return false;
+            }
+            if(ret == 0) {
+                MOLE_ERROR(io_socket_channel,"connection closed by peer");
+                return false;
+            }
+            cursor += ret;
+        }
+        return true;
+    }
+
+#ifdef __linux__
+    // 接收前按最终大小预分配,得到连续区段,空间不足时在接收前失败,其他错误(如不支持)忽略 & preallocate final size before receiving for contiguous extents,fail before receiving when space runs out,other errors (e.g. unsupported) are ignored
+    static bool preallocateFile(int file_fd,size_t file_size) {
+        if(file_size == 0 || fallocate(file_fd,FALLOC_FL_KEEP_SIZE,0,static_cast<off_t>(file_size)) == 0) return true;
+        if(errno != ENOSPC) return true;
+        MOLE_ERROR(io_socket_channel,strerror(errno),{ MOLE_VAR(file_size) });
+        return false;
+    }
+#endif
+
+    static const bool is_single_core = std::thread::hardware_concurrency() == 1;
+
+    static inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
+    }
+
+#ifdef __linux__
+    static int64_t timespecToNs(const timespec& ts) {
+        return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+    }
+
+    static void parseTimestamps(msghdr& msg,MessageTimestamps& timestamps) {
+        for(cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg,cmsg)) {
+            if(cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPING) {
+                scm_timestamping tss{};
+                memcpy(&tss,CMSG_DATA(cmsg),sizeof(tss));
+                timestamps.software_ns = timespecToNs(tss.ts[0]);
+                timestamps.hardware_ns = timespecToNs(tss.ts[2]);
+            }else if((cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR) ||
+                     (cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR)) {
+                sock_extended_err err{};
+                memcpy(&err,CMSG_DATA(cmsg),sizeof(err));
+                if(err.ee_errno != ENOMSG || err.ee_origin != SO_EE_ORIGIN_TIMESTAMPING) continue;
+                timestamps.id = err.ee_data;
+                switch(err.ee_info) {
+                    case SCM_TSTAMP_SCHED: timestamps.type = TIMESTAMP_SCHED; break;
+                    case SCM_TSTAMP_ACK: timestamps.type = TIMESTAMP_ACK; break;
+                    default: timestamps.type = TIMESTAMP_SEND; break;
+                }
+            }
+        }
+    }
+#endif
+
     Socket::Socket(SocketType type_) {
 #ifdef _WIN32
         static bool is_startup = false;
@@ -86,18 +247,196 @@ namespace hzd {
         return Send(data.c_str(),data.size());
     }
 
-    void Socket::_init() {
-        sock = socket(AF_INET,type,0);
+    long Socket::recvMessageImpl_(std::string &data, size_t size, sockaddr *from, socklen_t *from_size, MessageTimestamps &timestamps) {
+#ifdef __linux__
+        data.resize(size);
+        iovec iov{&data[0],size};
+        char control[512];
+        msghdr msg{};
+        msg.msg_name = from;
+        msg.msg_namelen = from_size ? *from_size : 0;
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        IO_METRICS_BEGIN();
+        ssize_t had_recv_bytes = recvmsg(sock,&msg,0);
+        IO_METRICS_RECV(size,had_recv_bytes);
+        if(had_recv_bytes < 0) {
+            data.clear();
+            if(errno == EAGAIN || errno == EWOULDBLOCK) return -2;
+            MOLE_ERROR(io_socket_channel,strerror(errno));
+            return -1;
+        }
+        data.resize(had_recv_bytes);
+        if(from_size) *from_size = msg.msg_namelen;
+        timestamps = MessageTimestamps{};
+        parseTimestamps(msg,timestamps);
+        return had_recv_bytes;
+#elif _WIN32
+        MOLE_ERROR(io_socket_channel,"kernel timestamping not supported on this platform");
+        return -1;
+#endif
+    }
+
+    bool Socket::EnableTimestamping(bool is_tx, bool is_rx, bool is_hardware) {
+#ifdef __linux__
+        unsigned int flags = SOF_TIMESTAMPING_SOFTWARE;
+        if(is_hardware) flags |= SOF_TIMESTAMPING_RAW_HARDWARE;
+        if(is_rx) {
+            flags |= SOF_TIMESTAMPING_RX_SOFTWARE;
+            if(is_hardware) flags |= SOF_TIMESTAMPING_RX_HARDWARE;
+        }
+        if(is_tx) {
+            flags |= SOF_TIMESTAMPING_TX_SOFTWARE | SOF_TIMESTAMPING_TX_SCHED | SOF_TIMESTAMPING_OPT_ID | SOF_TIMESTAMPING_OPT_TSONLY;
+            if(type == SOCK_STREAM) flags |= SOF_TIMESTAMPING_TX_ACK;
+            if(is_hardware) flags |= SOF_TIMESTAMPING_TX_HARDWARE;
+        }
+        if(setsockopt(sock,SOL_SOCKET,SO_TIMESTAMPING,&flags,sizeof(flags)) < 0) {
+            MOLE_ERROR(io_socket_channel,strerror(errno));
+            return false;
+        }
+        return true;
+#elif _WIN32
+        MOLE_ERROR(io_socket_channel,"kernel timestamping not supported on this platform");
+        return false;
+#endif
+    }
+
+    bool Socket::ReadTxTimestamp(MessageTimestamps &timestamps) {
+#ifdef __linux__
+        char data[64];
+        iovec iov{data,sizeof(data)};
+        char control[512];
+        msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        if(recvmsg(sock,&msg,MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+            if(errno != EAGAIN && errno != EWOULDBLOCK) MOLE_ERROR(io_socket_channel,strerror(errno));
+            return false;
+        }
+        timestamps = MessageTimestamps{};
+        timestamps.type = TIMESTAMP_SEND;
+        parseTimestamps(msg,timestamps);
+        return true;
+#elif _WIN32
+        MOLE_ERROR(io_socket_channel,"kernel timestamping not supported on this platform");
+        return false;
+#endif
+    }
+
+    bool Socket::SetBusyPoll(bool is_enable, const BusyPollOptions &options) {
+#ifdef __linux__
+        if(!is_enable) {
+            busy_poll = false;
+            return true;
+        }
+        if(sock == BAD_SOCKET) {
+            MOLE_ERROR(io_socket_channel,"socket not created yet,call after Connect/Accept/Bind");
+            return false;
+        }
+        busy_poll = true;
+        busy_poll_options = options;
+        busy_poll_budget_ns = static_cast<uint64_t>(options.spin_us) * 1000;
+        busy_poll_wait_ns = 0;
+        int flags = fcntl(sock,F_GETFL);
+        busy_poll_blocking = flags < 0 || !(flags & O_NONBLOCK);
+        if(options.kernel_busy_poll_us > 0) {
+            int value = static_cast<int>(options.kernel_busy_poll_us);
+            // 超过net.core.busy_poll需要CAP_NET_ADMIN,失败时仅用户态自旋 & above net.core.busy_poll needs CAP_NET_ADMIN,fall back to user space spin only
+            if(setsockopt(sock,SOL_SOCKET,SO_BUSY_POLL,&value,sizeof(value)) < 0) {
+                MOLE_WARN(io_socket_channel,strerror(errno));
+            }
+        }
+        return true;
+#elif _WIN32
+        MOLE_ERROR(io_socket_channel,"busy poll not supported on this platform");
+        return false;
+#endif
+    }
+
+    long Socket::recvSome_(char *buffer, size_t size, sockaddr *from, socklen_t *from_size) {
+#ifdef __linux__
+        ssize_t had_recv_bytes;
+        if(!busy_poll) {
+            IO_METRICS_BEGIN();
+            had_recv_bytes = recvfrom(sock,buffer,size,0,from,from_size);
+            IO_METRICS_RECV(size,had_recv_bytes);
+            return had_recv_bytes;
+        }
+        uint64_t spin_start = steadyNs();
+        bool is_waited = false;
+        // 每次逻辑接收只记录一次,自旋中的EAGAIN不计入 & one sample per logical receive,EAGAIN while spinning is not counted
+        IO_METRICS_BEGIN();
+        while(true) {
+            had_recv_bytes = recvfrom(sock,buffer,size,MSG_DONTWAIT,from,from_size);
+            if(had_recv_bytes >= 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) break;
+            is_waited = true;
+            if(steadyNs() - spin_start < busy_poll_budget_ns) {
+                // 单核时让出CPU,否则自旋会饿死对端 & yield on single core,otherwise spinning starves the peer
+                if(is_single_core) sched_yield();
+                else cpuRelax();
+                continue;
+            }
+            if(!busy_poll_blocking) break;
+            pollfd poll_fd{sock,POLLIN,0};
+            if(poll(&poll_fd,1,-1) < 0 && errno != EINTR) break;
+        }
+        IO_METRICS_RECV(size,had_recv_bytes);
+        if(had_recv_bytes > 0) busyPollAdapt_(is_waited ? steadyNs() - spin_start : 0);
+        return had_recv_bytes;
+#elif _WIN32
+        IO_METRICS_BEGIN();
+        long had_recv_bytes = recvfrom(sock,buffer,static_cast<int>(size),0,from,from_size);
+        IO_METRICS_RECV(size,had_recv_bytes);
+        return had_recv_bytes;
+#endif
+    }
+
+    void Socket::busyPollAdapt_(uint64_t wait_ns) {
+        // 到达间隔中空等的部分决定了自旋能否命中 & the idle part of inter-arrival time decides whether spinning can hit
+        busy_poll_wait_ns = (busy_poll_wait_ns * 7 + wait_ns) / 8;
+        if(!busy_poll_options.is_adaptive) return;
+        uint64_t min_budget = static_cast<uint64_t>(busy_poll_options.min_spin_us) * 1000;
+        uint64_t max_budget = static_cast<uint64_t>(busy_poll_options.max_spin_us) * 1000;
+        // 空等远超最大预算时自旋只会浪费CPU & spinning only wastes cpu when idle wait exceeds max budget
+        uint64_t budget = busy_poll_wait_ns * 2;
+        busy_poll_budget_ns = budget > max_budget ? min_budget : std::max(budget,min_budget);
+    }
+
+    void Socket::_init(int family_) {
+        family = family_;
+        sock = socket(family,type,0);
+        if(family != AF_INET && family != AF_INET6) return;
         int reuse = 1;
         setsockopt(sock,SOL_SOCKET,SO_REUSEADDR,(const char*)&reuse,sizeof(reuse));
 #ifdef __linux__
         setsockopt(sock,SOL_SOCKET,SO_REUSEPORT,(const char*)&reuse,sizeof(reuse));
 #endif
+        if(family == AF_INET6) {
+            // 双栈,IPv4对端以映射地址出现 & dual-stack,IPv4 peers appear as mapped addresses
+            int v6_only = 0;
+            setsockopt(sock,IPPROTO_IPV6,IPV6_V6ONLY,(const char*)&v6_only,sizeof(v6_only));
+        }
+    }
+
+    bool Socket::ensureFamily_(int family_) {
+        if(sock != BAD_SOCKET && family == family_) return true;
+        if(self_addr.Valid()) {
+            MOLE_ERROR(io_socket_channel,"socket already bound to another address family",{ MOLE_VAR(family_) });
+            return false;
+        }
+        Close();
+        _init(family_);
+        return sock != BAD_SOCKET;
     }
 
-    TcpSocket::TcpSocket(SOCKET sock_, sockaddr_in dest_addr_) : Socket(SOCK_STREAM) {
+    TcpSocket::TcpSocket(SOCKET sock_, const Endpoint& dest_addr_) : Socket(SOCK_STREAM) {
         sock = sock_;
         dest_addr = dest_addr_;
+        family = dest_addr_.Family();
     }
 
     ssize_t TcpSocket::sendImpl_(const char *data) {
@@ -110,7 +449,10 @@ namespace hzd {
         #elif _WIN32
             int flag = 0;
         #endif
-            if((had_send_bytes = send(sock,data + send_cursor,static_cast<int>(need_send_bytes),flag)) <= 0) {
+            IO_METRICS_BEGIN();
+            had_send_bytes = send(sock,data + send_cursor,static_cast<int>(need_send_bytes),flag);
+            IO_METRICS_SEND(need_send_bytes,had_send_bytes);
+            if(had_send_bytes <= 0) {
                 if(errno == EAGAIN || errno == EWOULDBLOCK) {
                     is_new = false;
                     return 0;
@@ -137,7 +479,8 @@ namespace hzd {
         char buffer[4096] = {0};
         while(recv_cursor < recv_bytes_count) {
             memset(buffer,0,sizeof(buffer));
-            if((had_recv_bytes = recv(sock,buffer,sizeof(buffer),0)) <= 0) {
+            had_recv_bytes = recvSome_(buffer,sizeof(buffer),nullptr,nullptr);
+            if(had_recv_bytes <= 0) {
                 if(errno == EAGAIN || errno == EWOULDBLOCK) {
                     is_new = false;
                     return 0;
@@ -177,6 +520,37 @@ namespace hzd {
         return recvImpl_(data);
     }
 
+    long TcpSocket::Recv(Buffer &buffer, size_t size, BufferPool &pool) {
+        if(is_new) {
+            if(size <= 0) return -1;
+            if(!buffer || buffer.Capacity() < size || buffer.RefCount() > 1) buffer = pool.Acquire(size);
+            buffer.Resize(0);
+            recv_bytes_count = size;
+            recv_cursor = 0;
+            is_new = false;
+        }
+        long had_recv_bytes;
+        while(recv_cursor < recv_bytes_count) {
+            if((had_recv_bytes = recvSome_(buffer.Data() + recv_cursor,recv_bytes_count - recv_cursor,nullptr,nullptr)) <= 0) {
+                if(errno == EAGAIN || errno == EWOULDBLOCK) {
+                    is_new = false;
+                    return 0;
+                }
+#ifdef __linux__
+                MOLE_ERROR(io_socket_channel,strerror(errno));
+#elif _WIN32
+                MOLE_ERROR(io_socket_channel,GetWASockError());
+#endif
+                is_new = true;
+                return -1;
+            }
+            recv_cursor += had_recv_bytes;
+            buffer.Resize(recv_cursor);
+        }
+        is_new = true;
+        return static_cast<long>(recv_bytes_count);
+    }
+
     bool TcpSocket::SendFile(const std::string &file_path) {
 #ifdef __linux__
         if(is_new) {
@@ -251,6 +625,17 @@ namespace hzd {
             recv_bytes_count = file_size;
             is_new = false;
             fd = open(file_path.c_str(),O_CREAT | O_WRONLY,0755);
+            if(fd < 0) {
+                MOLE_ERROR(io_socket_channel,strerror(errno),{ MOLE_VAR(file_path) });
+                is_new = true;
+                return false;
+            }
+            if(!preallocateFile(fd,file_size)) {
+                close(fd);
+                fd = -1;
+                is_new = true;
+                return false;
+            }
         }
         ssize_t had_recv_bytes;
         size_t need_recv_bytes;
@@ -262,6 +647,8 @@ namespace hzd {
                 if(errno == EAGAIN || errno == EWOULDBLOCK){
                     continue;
                 }
+                // 截到已接收长度,释放KEEP_SIZE预分配的块 & truncate to received length,releasing blocks preallocated with KEEP_SIZE
+                ftruncate(fd,static_cast<off_t>(recv_cursor));
                 close(fd);
                 fd = -1;
                 return false;
@@ -306,9 +693,277 @@ namespace hzd {
 #endif
     }
 
+    bool TcpSocket::SendFile(const std::string &file_path, uint32_t &crc32c) {
+        MappedFile file;
+        if(!file.Open(file_path)) return false;
+        file.Advise(MapAdvice::SEQUENTIAL);
+        // 分段校验后立即发送,该段仍在缓存中 & hash a segment then send it while still cached
+        const size_t segment_size = 1024 * 1024;
+        crc32c = 0;
+        for(size_t offset = 0; offset < file.Size(); offset += segment_size) {
+            auto view = file.View(offset,segment_size);
+            crc32c = Crc32c::Compute(view.data,view.size,crc32c);
+            if(!SendFile(file,offset,view.size)) return false;
+        }
+        return true;
+    }
+
+    bool TcpSocket::RecvFile(const std::string &file_path, size_t file_size, uint32_t &crc32c) {
+        FileWriter writer;
+        FileWriterOptions options;
+        options.buffer_size = std::min<size_t>(options.buffer_size,std::max<size_t>(file_size,1));
+        options.preallocate = file_size;
+        if(!writer.Open(file_path,options)) return false;
+        std::vector<char> buffer(256 * 1024);
+        crc32c = 0;
+        size_t cursor = 0;
+        while(cursor < file_size) {
+            size_t need_recv_bytes = std::min(buffer.size(),file_size - cursor);
+            if(!recvAll(sock,buffer.data(),need_recv_bytes)) return false;
+            crc32c = Crc32c::Compute(buffer.data(),need_recv_bytes,crc32c);
+            if(!writer.Write(buffer.data(),need_recv_bytes)) return false;
+            cursor += need_recv_bytes;
+        }
+        return writer.Close();
+    }
+
+    bool TcpSocket::SendAll(const char *data, size_t size) {
+        return sendAll(sock,data,size);
+    }
+
+    bool TcpSocket::RecvAll(char *data, size_t size) {
+        return recvAll(sock,data,size);
+    }
+
+    bool TcpSocket::SendFile(const MappedFile &file, size_t offset, size_t length) {
+        auto view = file.View(offset,length);
+        if(!file.IsOpen()) {
+            MOLE_ERROR(io_socket_channel,"file not mapped");
+            return false;
+        }
+#ifdef __linux__
+        // 页面已在页缓存中,sendfile省去用户态到内核的拷贝 & pages are already in page cache,sendfile skips the user-to-kernel copy
+        auto cursor = static_cast<off_t>(view.data ? view.data - file.Data() : 0);
+        auto end = cursor + static_cast<off_t>(view.size);
+        while(cursor < end) {
+            ssize_t had_send_bytes = sendfile(sock,file.Fd(),&cursor,static_cast<size_t>(end - cursor));
+            if(had_send_bytes < 0) {
+                if(errno == EINTR) continue;
+                if(errno == EAGAIN || errno == EWOULDBLOCK) {
+                    if(!waitSocket(sock,POLLOUT)) return false;
+                    continue;
+                }
+                MOLE_ERROR(io_socket_channel,strerror(errno));
+                return false;
+            }
+            if(had_send_bytes == 0) break;
+        }
+        return cursor == end;
+#elif _WIN32
+        return sendAll(sock,view.data,view.size);
+#endif
+    }
+
+    bool TcpSocket::SendSparseFile(const std::string &file_path) {
+        std::vector<filesystem::Extent> extents;
+        uint64_t file_size = 0;
+        if(!filesystem::data_extents(file_path,extents,file_size)) return false;
+        // 头部: 魔数,文件大小,区段数,随后为区段表(偏移,长度),均为大端 & header: magic,file size,extent count,then extent map (offset,length),all big-endian
+        std::string header((3 + extents.size() * 2) * 8,'\0');
+        encodeU64(sparse_magic,&header[0]);
+        encodeU64(file_size,&header[8]);
+        encodeU64(extents.size(),&header[16]);
+        for(size_t i = 0; i < extents.size(); i++) {
+            encodeU64(extents[i].offset,&header[24 + i * 16]);
+            encodeU64(extents[i].length,&header[32 + i * 16]);
+        }
+#ifdef __linux__
+        int file_fd = open(file_path.c_str(),O_RDONLY | O_CLOEXEC);
+        if(file_fd < 0) {
+            MOLE_ERROR(io_socket_channel,strerror(errno),{ MOLE_VAR(file_path) });
+            return false;
+        }
+        bool ret = sendAll(sock,header.data(),header.size());
+        for(size_t i = 0; ret && i < extents.size(); i++) {
+            auto offset = static_cast<off_t>(extents[i].offset);
+            auto end = static_cast<off_t>(extents[i].offset + extents[i].length);
+            while(offset < end) {
+                ssize_t had_send_bytes = sendfile(sock,file_fd,&offset,static_cast<size_t>(end - offset));
+                if(had_send_bytes < 0) {
+                    if(errno == EINTR) continue;
+                    if(errno == EAGAIN || errno == EWOULDBLOCK) {
+                        if(!(ret = waitSocket(sock,POLLOUT))) break;
+                        continue;
+                    }
+                    MOLE_ERROR(io_socket_channel,strerror(errno));
+                    ret = false;
+                    break;
+                }
+                if(had_send_bytes == 0) {
+                    MOLE_ERROR(io_socket_channel,"file truncated while sending",{ MOLE_VAR(file_path) });
+                    ret = false;
+                    break;
+                }
+            }
+        }
+        close(file_fd);
+        return ret;
+#elif _WIN32
+        FILE* file = fopen(file_path.c_str(),"rb");
+        if(!file) {
+            MOLE_ERROR(io_socket_channel,strerror(errno));
+            return false;
+        }
+        bool ret = sendAll(sock,header.data(),header.size());
+        char send_buffer[4096] = {0};
+        for(size_t i = 0; ret && i < extents.size(); i++) {
+            _fseeki64(file,static_cast<long long>(extents[i].offset),SEEK_SET);
+            uint64_t remain = extents[i].length;
+            while(ret && remain > 0) {
+                size_t need_send_bytes = fread(send_buffer,1,static_cast<size_t>(std::min<uint64_t>(remain,sizeof(send_buffer))),file);
+                if(need_send_bytes == 0) {
+                    MOLE_ERROR(io_socket_channel,"file truncated while sending",{ MOLE_VAR(file_path) });
+                    ret = false;
+                    break;
+                }
+                ret = sendAll(sock,send_buffer,need_send_bytes);
+                remain -= need_send_bytes;
+            }
+        }
+        fclose(file);
+        return ret;
+#endif
+    }
+
+    bool TcpSocket::RecvSparseFile(const std::string &file_path) {
+        char head[24];
+        if(!recvAll(sock,head,sizeof(head))) return false;
+        if(decodeU64(head) != sparse_magic) {
+            MOLE_ERROR(io_socket_channel,"invalid sparse file header");
+            return false;
+        }
+        uint64_t file_size = decodeU64(head + 8);
+        uint64_t extent_count = decodeU64(head + 16);
+        if(extent_count > sparse_max_extents) {
+            MOLE_ERROR(io_socket_channel,"too many extents",{ MOLE_VAR(extent_count) });
+            return false;
+        }
+        std::string table(extent_count * 16,'\0');
+        if(!recvAll(sock,&table[0],table.size())) return false;
+        std::vector<filesystem::Extent> extents(extent_count);
+        for(size_t i = 0; i < extents.size(); i++) {
+            extents[i].offset = decodeU64(&table[i * 16]);
+            extents[i].length = decodeU64(&table[i * 16 + 8]);
+            if(extents[i].offset > file_size || extents[i].length > file_size - extents[i].offset) {
+                MOLE_ERROR(io_socket_channel,"extent out of range",{ MOLE_VAR(file_size) });
+                return false;
+            }
+        }
+        char recv_buffer[65536];
+#ifdef __linux__
+        int file_fd = open(file_path.c_str(),O_CREAT | O_WRONLY | O_TRUNC | O_CLOEXEC,0644);
+        if(file_fd < 0) {
+            MOLE_ERROR(io_socket_channel,strerror(errno),{ MOLE_VAR(file_path) });
+            return false;
+        }
+        bool ret = true;
+        for(size_t i = 0; ret && i < extents.size(); i++) {
+            uint64_t cursor = 0;
+            while(ret && cursor < extents[i].length) {
+                size_t need_recv_bytes = static_cast<size_t>(std::min<uint64_t>(extents[i].length - cursor,sizeof(recv_buffer)));
+                if(!(ret = recvAll(sock,recv_buffer,need_recv_bytes))) break;
+                size_t had_write = 0;
+                while(had_write < need_recv_bytes) {
+                    ssize_t written = pwrite(file_fd,recv_buffer + had_write,need_recv_bytes - had_write,
+                                             static_cast<off_t>(extents[i].offset + cursor + had_write));
+                    if(written < 0) {
+                        if(errno == EINTR) continue;
+                        MOLE_ERROR(io_socket_channel,strerror(errno),{ MOLE_VAR(file_path) });
+                        ret = false;
+                        break;
+                    }
+                    had_write += written;
+                }
+                cursor += need_recv_bytes;
+            }
+        }
+        // 未写入的区域即为空洞 & regions never written stay holes
+        if(ret && ftruncate(file_fd,static_cast<off_t>(file_size)) != 0) {
+            MOLE_ERROR(io_socket_channel,strerror(errno),{ MOLE_VAR(file_path) });
+            ret = false;
+        }
+        close(file_fd);
+        return ret;
+#elif _WIN32
+        FILE* file = fopen(file_path.c_str(),"wb");
+        if(!file) {
+            MOLE_ERROR(io_socket_channel,strerror(errno));
+            return false;
+        }
+        bool ret = true;
+        for(size_t i = 0; ret && i < extents.size(); i++) {
+            _fseeki64(file,static_cast<long long>(extents[i].offset),SEEK_SET);
+            uint64_t remain = extents[i].length;
+            while(ret && remain > 0) {
+                size_t need_recv_bytes = static_cast<size_t>(std::min<uint64_t>(remain,sizeof(recv_buffer)));
+                if(!(ret = recvAll(sock,recv_buffer,need_recv_bytes))) break;
+                fwrite(recv_buffer,need_recv_bytes,1,file);
+                remain -= need_recv_bytes;
+            }
+        }
+        if(ret && file_size > 0) {
+            // 写入末字节以确定文件大小 & write last byte to settle file size
+            _fseeki64(file,static_cast<long long>(file_size - 1),SEEK_SET);
+            char last = 0;
+            bool is_covered = !extents.empty() && extents.back().offset + extents.back().length == file_size;
+            if(!is_covered) fwrite(&last,1,1,file);
+        }
+        fclose(file);
+        return ret;
+#endif
+    }
+
+    bool TcpSocket::TcpInfo(TcpInfoSample &info) const {
+#ifdef __linux__
+        tcp_info tcp_info_{};
+        socklen_t size = sizeof(tcp_info_);
+        if(getsockopt(sock,IPPROTO_TCP,TCP_INFO,&tcp_info_,&size) < 0) {
+            MOLE_ERROR(io_socket_channel,strerror(errno));
+            return false;
+        }
+        info.state = tcp_info_.tcpi_state;
+        info.rtt_us = tcp_info_.tcpi_rtt;
+        info.rtt_var_us = tcp_info_.tcpi_rttvar;
+        info.snd_cwnd = tcp_info_.tcpi_snd_cwnd;
+        info.snd_ssthresh = tcp_info_.tcpi_snd_ssthresh;
+        info.snd_mss = tcp_info_.tcpi_snd_mss;
+        info.retransmits = tcp_info_.tcpi_retransmits;
+        info.total_retrans = tcp_info_.tcpi_total_retrans;
+        info.unacked = tcp_info_.tcpi_unacked;
+        info.lost = tcp_info_.tcpi_lost;
+        // 发送队列总字节减去未发送字节即为在途未确认字节 & queued bytes minus not-sent bytes is unacked in-flight bytes
+        int queued = 0,not_sent = 0;
+        if(ioctl(sock,SIOCOUTQ,&queued) == 0 && ioctl(sock,SIOCOUTQNSD,&not_sent) == 0 && queued >= not_sent) {
+            info.unacked_bytes = static_cast<uint32_t>(queued - not_sent);
+        }
+        return true;
+#elif _WIN32
+        MOLE_ERROR(io_socket_channel,"TCP_INFO not supported on this platform");
+        return false;
+#endif
+    }
+
+    long TcpSocket::RecvMessage(std::string &data, size_t size, MessageTimestamps &timestamps) {
+        long ret = recvMessageImpl_(data,size,nullptr,nullptr,timestamps);
+        if(ret == -2) return 0;
+        if(ret == 0) return -1;
+        return ret;
+    }
+
     TcpSocket::TcpSocket(TcpSocket &&tcp_socket) noexcept : Socket(tcp_socket.type) {
         sock = tcp_socket.sock;
         type = tcp_socket.type;
+        family = tcp_socket.family;
         self_addr = tcp_socket.self_addr;
         dest_addr = tcp_socket.dest_addr;
         recv_cursor = tcp_socket.recv_cursor;
@@ -317,6 +972,14 @@ namespace hzd {
         send_bytes_count = tcp_socket.send_bytes_count;
         fd = tcp_socket.fd;
         is_new = tcp_socket.is_new;
+        busy_poll = tcp_socket.busy_poll;
+        busy_poll_blocking = tcp_socket.busy_poll_blocking;
+        busy_poll_options = tcp_socket.busy_poll_options;
+        busy_poll_budget_ns = tcp_socket.busy_poll_budget_ns;
+        busy_poll_wait_ns = tcp_socket.busy_poll_wait_ns;
+#ifdef IO_UTILS_SOCKET_METRICS
+        metrics = tcp_socket.metrics;
+#endif
 
         tcp_socket.sock = BAD_SOCKET;
     }
@@ -324,6 +987,7 @@ namespace hzd {
     TcpSocket &TcpSocket::operator=(TcpSocket &&tcp_socket) noexcept {
         sock = tcp_socket.sock;
         type = tcp_socket.type;
+        family = tcp_socket.family;
         self_addr = tcp_socket.self_addr;
         dest_addr = tcp_socket.dest_addr;
         recv_cursor = tcp_socket.recv_cursor;
@@ -332,6 +996,14 @@ namespace hzd {
         send_bytes_count = tcp_socket.send_bytes_count;
         fd = tcp_socket.fd;
         is_new = tcp_socket.is_new;
+        busy_poll = tcp_socket.busy_poll;
+        busy_poll_blocking = tcp_socket.busy_poll_blocking;
+        busy_poll_options = tcp_socket.busy_poll_options;
+        busy_poll_budget_ns = tcp_socket.busy_poll_budget_ns;
+        busy_poll_wait_ns = tcp_socket.busy_poll_wait_ns;
+#ifdef IO_UTILS_SOCKET_METRICS
+        metrics = tcp_socket.metrics;
+#endif
 
         tcp_socket.sock = BAD_SOCKET;
         return *this;
@@ -345,17 +1017,17 @@ namespace hzd {
         return Socket::Send(data);
     }
 
-    TcpListener::TcpListener(const std::string &ip, unsigned short port) {
-        self_addr.sin_family = AF_INET;
-        self_addr.sin_addr.s_addr = inet_addr(ip.c_str());
-        self_addr.sin_port = htons(port);
+    TcpListener::TcpListener(const std::string &ip, unsigned short port) : TcpListener(Endpoint::Of(ip,port)) {}
 
-        Socket::_init();
+    TcpListener::TcpListener(const Endpoint &endpoint) {
+        self_addr = endpoint;
+        Socket::_init(endpoint.Valid() ? endpoint.Family() : AF_INET);
     }
 
 
     bool TcpListener::Bind() {
-        if(bind(sock,(sockaddr*)&self_addr,sizeof(self_addr)) < 0) {
+        if(!self_addr.Valid()) return false;
+        if(bind(sock,self_addr.Addr(),self_addr.Size()) < 0) {
             return false;
         }
         return true;
@@ -370,27 +1042,34 @@ namespace hzd {
 
     bool TcpListener::Accept(TcpSocket &tcp_socket) {
         SOCKET sock_;
-        sockaddr_in dest_addr_{};
-        socklen_t  dest_addr_len = sizeof(dest_addr_);
-        if((sock_ = accept(sock,(sockaddr*)&dest_addr_,&dest_addr_len)) < 0) return false;
+        Endpoint dest_addr_;
+        if((sock_ = accept(sock,dest_addr_.MutableAddr(),dest_addr_.MutableSize())) < 0) return false;
         tcp_socket = {sock_,dest_addr_};
         return true;
     }
 
 
     bool TcpClient::Connect(const std::string &ip, unsigned short port) {
+        Endpoint endpoint;
+        if(!Endpoint::Parse(ip,port,endpoint)) return false;
+        return Connect(endpoint);
+    }
+
+    bool TcpClient::Connect(const Endpoint &endpoint) {
+        if(!endpoint.Valid()) {
+            MOLE_ERROR(io_socket_channel,"invalid endpoint");
+            return false;
+        }
         if(sock != BAD_SOCKET) Close();
-        _init();
+        _init(endpoint.Family());
 
-        dest_addr.sin_addr.s_addr = inet_addr(ip.c_str());
-        dest_addr.sin_port = htons(port);
-        dest_addr.sin_family = AF_INET;
+        dest_addr = endpoint;
 #ifdef __linux__
         int option = fcntl(sock,F_GETFL);
         int newOption = option | O_NONBLOCK;
         fcntl(sock,F_SETFL,newOption);
 
-        while(connect(sock,(sockaddr*)&dest_addr,sizeof(dest_addr)) < 0){
+        while(connect(sock,dest_addr.Addr(),dest_addr.Size()) < 0){
             if(errno != EINPROGRESS && errno != EALREADY) {
                 MOLE_ERROR(io_socket_channel, strerror(errno));
                 return false;
@@ -399,7 +1078,7 @@ namespace hzd {
 
         fcntl(sock,F_SETFL,option);
 #elif _WIN32
-        if(connect(sock,(sockaddr*)&dest_addr,sizeof(dest_addr))< 0) {
+        if(connect(sock,dest_addr.Addr(),dest_addr.Size())< 0) {
             MOLE_ERROR(io_socket_channel,strerror(errno));
             return false;
         }
@@ -418,7 +1097,10 @@ namespace hzd {
 #elif _WIN32
             int flag = 0;
 #endif
-            if((had_send_bytes = sendto(sock,data + send_cursor,static_cast<int>(need_send_bytes),flag,(const sockaddr*)&dest_addr,sizeof(dest_addr))) <= 0) {
+            IO_METRICS_BEGIN();
+            had_send_bytes = sendto(sock,data + send_cursor,static_cast<int>(need_send_bytes),flag,dest_addr.Addr(),dest_addr.Size());
+            IO_METRICS_SEND(need_send_bytes,had_send_bytes);
+            if(had_send_bytes <= 0) {
                 if(errno == EAGAIN || errno == EWOULDBLOCK) {
                     is_new = false;
                     return 0;
@@ -444,7 +1126,8 @@ namespace hzd {
         }
         char buffer[4096] = {0};
         while(recv_cursor < recv_bytes_count) {
-            if((had_recv_bytes = recvfrom(sock,buffer,sizeof(buffer),0,(struct sockaddr*)&from_addr,(socklen_t*)&from_addr_size)) <= 0) {
+            had_recv_bytes = recvSome_(buffer,sizeof(buffer),from_addr.MutableAddr(),from_addr.MutableSize());
+            if(had_recv_bytes <= 0) {
                 if(errno == EAGAIN || errno == EWOULDBLOCK) {
                     is_new = false;
                     return 0;
@@ -484,6 +1167,37 @@ namespace hzd {
         return recvImpl_(data);
     }
 
+    long UdpSocket::Recv(Buffer &buffer, size_t size, BufferPool &pool) {
+        if(is_new) {
+            if(size <= 0) return -1;
+            if(!buffer || buffer.Capacity() < size || buffer.RefCount() > 1) buffer = pool.Acquire(size);
+            buffer.Resize(0);
+            recv_bytes_count = size;
+            recv_cursor = 0;
+            is_new = false;
+        }
+        long had_recv_bytes;
+        while(recv_cursor < recv_bytes_count) {
+            if((had_recv_bytes = recvSome_(buffer.Data() + recv_cursor,recv_bytes_count - recv_cursor,from_addr.MutableAddr(),from_addr.MutableSize())) <= 0) {
+                if(errno == EAGAIN || errno == EWOULDBLOCK) {
+                    is_new = false;
+                    return 0;
+                }
+#ifdef __linux__
+                MOLE_ERROR(io_socket_channel,strerror(errno));
+#elif _WIN32
+                MOLE_ERROR(io_socket_channel,GetWASockError());
+#endif
+                is_new = true;
+                return -1;
+            }
+            recv_cursor += had_recv_bytes;
+            buffer.Resize(recv_cursor);
+        }
+        is_new = true;
+        return static_cast<long>(recv_bytes_count);
+    }
+
     bool UdpSocket::SendFile(const std::string &file_path) {
 #ifdef __linux__
         if(is_new) {
@@ -502,7 +1216,7 @@ namespace hzd {
         char buffer[4096] = {0};
         while(send_cursor < send_bytes_count) {
             need_send_bytes = read(fd,buffer,sizeof(buffer));
-            if((had_send_bytes = sendto(sock,buffer,need_send_bytes,0,(sockaddr*)&dest_addr,sizeof(dest_addr))) < 0) {
+            if((had_send_bytes = sendto(sock,buffer,need_send_bytes,0,dest_addr.Addr(),dest_addr.Size())) < 0) {
                 if(errno == EAGAIN || errno == EWOULDBLOCK) {
                     continue;
                 }
@@ -535,7 +1249,7 @@ namespace hzd {
         char send_buffer[4096] = {0};
         while(send_cursor < send_bytes_count) {
             need_send_bytes = fread(send_buffer,1,sizeof(send_buffer),fd);
-            if((had_send_bytes = sendto(sock,send_buffer,static_cast<int>(need_send_bytes),0,(sockaddr*)&dest_addr,sizeof(dest_addr))) < 0) {
+            if((had_send_bytes = sendto(sock,send_buffer,static_cast<int>(need_send_bytes),0,dest_addr.Addr(),dest_addr.Size())) < 0) {
                 if(errno == EAGAIN || errno == EWOULDBLOCK) {
                     continue;
                 }
@@ -560,6 +1274,17 @@ namespace hzd {
             recv_bytes_count = file_size;
             is_new = false;
             fd = open(file_path.c_str(),O_CREAT | O_WRONLY,0755);
+            if(fd < 0) {
+                MOLE_ERROR(io_socket_channel,strerror(errno),{ MOLE_VAR(file_path) });
+                is_new = true;
+                return false;
+            }
+            if(!preallocateFile(fd,file_size)) {
+                close(fd);
+                fd = -1;
+                is_new = true;
+                return false;
+            }
         }
         ssize_t had_recv_bytes;
         size_t need_recv_bytes;
@@ -567,10 +1292,12 @@ namespace hzd {
         while(recv_cursor < recv_bytes_count){
             bzero(recv_buffer,sizeof(recv_buffer));
             need_recv_bytes = (recv_bytes_count - recv_cursor) > sizeof(recv_buffer) ? sizeof(recv_buffer) : (recv_bytes_count - recv_cursor);
-            if((had_recv_bytes = ::recvfrom(sock,recv_buffer,need_recv_bytes,0,(sockaddr*)&from_addr,(socklen_t*)&from_addr_size)) < 0){
+            if((had_recv_bytes = ::recvfrom(sock,recv_buffer,need_recv_bytes,0,from_addr.MutableAddr(),from_addr.MutableSize())) < 0){
                 if(errno == EAGAIN || errno == EWOULDBLOCK){
                     continue;
                 }
+                // 截到已接收长度,释放KEEP_SIZE预分配的块 & truncate to received length,releasing blocks preallocated with KEEP_SIZE
+                ftruncate(fd,static_cast<off_t>(recv_cursor));
                 close(fd);
                 fd = -1;
                 return false;
@@ -596,7 +1323,7 @@ namespace hzd {
         ssize_t had_recv_bytes;
         char recv_buffer[4096] = {0};
         while(recv_cursor < recv_bytes_count) {
-            if((had_recv_bytes = recvfrom(sock,recv_buffer,sizeof(recv_buffer),0,(sockaddr*)&from_addr,&from_addr_size)) < 0 ) {
+            if((had_recv_bytes = recvfrom(sock,recv_buffer,sizeof(recv_buffer),0,from_addr.MutableAddr(),from_addr.MutableSize())) < 0 ) {
                 if(errno == EAGAIN || errno == EWOULDBLOCK) {
                     continue;
                 }
@@ -615,26 +1342,84 @@ namespace hzd {
 #endif
     }
 
+    bool UdpSocket::setDest_(const Endpoint &endpoint) {
+        if(!endpoint.Valid()) {
+            MOLE_ERROR(io_socket_channel,"invalid endpoint");
+            return false;
+        }
+        if(endpoint.Family() != family) {
+            if(family == AF_INET6 && endpoint.IsV4()) {
+                dest_addr = endpoint.ToV4Mapped();
+                return true;
+            }
+            if(!ensureFamily_(endpoint.Family())) return false;
+        }
+        dest_addr = endpoint;
+        return true;
+    }
+
     ssize_t UdpSocket::SendTo(const std::string &ip, unsigned short port, const char *data, size_t size) {
-        dest_addr.sin_family = AF_INET;
-        dest_addr.sin_port = htons(port);
-        dest_addr.sin_addr.s_addr = inet_addr(ip.c_str());
+        return SendTo(Endpoint::Of(ip,port),data,size);
+    }
+
+    long UdpSocket::SendTo(const Endpoint &endpoint, const char *data, size_t size) {
+        if(!setDest_(endpoint)) return -1;
         return Send(data,size);
     }
 
+    long UdpSocket::SendTo(const Endpoint &endpoint, const std::string &data) {
+        return SendTo(endpoint,data.c_str(),data.size());
+    }
+
     bool UdpSocket::SendFileTo(const std::string &ip, unsigned short port, const std::string &file_path) {
-        dest_addr.sin_family = AF_INET;
-        dest_addr.sin_port = htons(port);
-        dest_addr.sin_addr.s_addr = inet_addr(ip.c_str());
+        return SendFileTo(Endpoint::Of(ip,port),file_path);
+    }
+
+    bool UdpSocket::SendFileTo(const Endpoint &endpoint, const std::string &file_path) {
+        if(!setDest_(endpoint)) return false;
         return SendFile(file_path);
     }
 
+    long UdpSocket::SendTo(const Endpoint &endpoint, const MappedView &view) {
+        return SendTo(endpoint,view.data,view.size);
+    }
+
+    bool UdpSocket::SendFileTo(const Endpoint &endpoint, const MappedFile &file, size_t datagram_size) {
+        if(!file.IsOpen() || datagram_size == 0) {
+            MOLE_ERROR(io_socket_channel,"file not mapped or invalid datagram size");
+            return false;
+        }
+        if(!setDest_(endpoint)) return false;
+        auto view = file.View();
+        for(size_t cursor = 0; cursor < view.size;) {
+            auto datagram = view.Slice(cursor,datagram_size);
+            IO_METRICS_BEGIN();
+            auto had_send_bytes = sendto(sock,datagram.data,static_cast<int>(datagram.size),0,dest_addr.Addr(),dest_addr.Size());
+            IO_METRICS_SEND(datagram.size,had_send_bytes);
+            if(had_send_bytes < 0) {
+                if(errno == EINTR) continue;
+                if(errno == EAGAIN || errno == EWOULDBLOCK) {
+                    if(!waitSocket(sock,POLLOUT)) return false;
+                    continue;
+                }
+                MOLE_ERROR(io_socket_channel,strerror(errno));
+                return false;
+            }
+            cursor += had_send_bytes;
+        }
+        return true;
+    }
+
     bool UdpSocket::Bind(const std::string& ip, unsigned short port) {
-        self_addr.sin_family = AF_INET;
-        self_addr.sin_addr.s_addr = inet_addr(ip.c_str());
-        self_addr.sin_port = htons(port);
+        return Bind(Endpoint::Of(ip,port));
+    }
 
-        return bind(sock,(sockaddr*)&self_addr,sizeof(self_addr)) >= 0;
+    bool UdpSocket::Bind(const Endpoint &endpoint) {
+        if(!endpoint.Valid()) return false;
+        if(!ensureFamily_(endpoint.Family())) return false;
+        if(bind(sock,endpoint.Addr(),endpoint.Size()) < 0) return false;
+        self_addr = endpoint;
+        return true;
     }
 
     long UdpSocket::Send(const std::string &data) {
@@ -646,20 +1431,20 @@ namespace hzd {
     }
 
     long UdpSocket::SendTo(const std::string &ip, unsigned short port, const std::string &data) {
-        dest_addr.sin_family = AF_INET;
-        dest_addr.sin_port = htons(port);
-        dest_addr.sin_addr.s_addr = inet_addr(ip.c_str());
-        return Send(data);
+        return SendTo(Endpoint::Of(ip,port),data.c_str(),data.size());
     }
 
     long UdpSocket::SendTo(const std::string &ip, unsigned short port, std::string &data) {
-        dest_addr.sin_family = AF_INET;
-        dest_addr.sin_port = htons(port);
-        dest_addr.sin_addr.s_addr = inet_addr(ip.c_str());
-        return Send(data);
+        return SendTo(Endpoint::Of(ip,port),data.c_str(),data.size());
+    }
+
+    long UdpSocket::RecvMessage(std::string &data, size_t size, MessageTimestamps &timestamps) {
+        long ret = recvMessageImpl_(data,size,from_addr.MutableAddr(),from_addr.MutableSize(),timestamps);
+        if(ret == -2) return 0;
+        return ret;
     }
 
-    sockaddr_in UdpSocket::FromAddr() const {
+    const Endpoint& UdpSocket::FromAddr() const {
         return from_addr;
     }
 } // hzd
\ No newline at end of file
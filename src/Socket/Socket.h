@@ -11,7 +11,15 @@
 #define IO_UTILS_SOCKET_H
 
 #include <climits>
+#include <cstdint>
 #include <string>
+#include "../BufferPool/BufferPool.h"
+#include "../MappedFile/MappedFile.h"
+#include "Endpoint.h"
+
+#ifdef IO_UTILS_SOCKET_METRICS
+#include "SocketMetrics.h"
+#endif
 
 #ifdef __linux__
 
@@ -42,6 +50,74 @@ using SocketType = int;
 #define BAD_SOCKET_TYPE (-1)
 
 namespace hzd {
+    // TCP_INFO 采样结果
+    // TCP_INFO sample
+    struct TcpInfoSample {
+        // TCP状态 & tcp state
+        uint8_t         state{0};
+        // 平滑往返时延(us) & smoothed round trip time (us)
+        uint32_t        rtt_us{0};
+        // 往返时延方差(us) & round trip time variance (us)
+        uint32_t        rtt_var_us{0};
+        // 拥塞窗口(段) & congestion window (segments)
+        uint32_t        snd_cwnd{0};
+        // 慢启动阈值 & slow start threshold
+        uint32_t        snd_ssthresh{0};
+        // 最大报文段长度 & max segment size
+        uint32_t        snd_mss{0};
+        // 当前未恢复的重传次数 & unrecovered retransmits
+        uint32_t        retransmits{0};
+        // 累计重传段数 & total retransmitted segments
+        uint32_t        total_retrans{0};
+        // 已发送未确认段数 & unacked segments
+        uint32_t        unacked{0};
+        // 被判定丢失的段数 & lost segments
+        uint32_t        lost{0};
+        // 发送队列中未确认字节数 & unacked bytes in send queue
+        uint32_t        unacked_bytes{0};
+    };
+
+    // 内核时间戳类型
+    // kernel timestamp type
+    enum TimestampType {
+        // 接收时间戳 & receive timestamp
+        TIMESTAMP_RECV = 0,
+        // 进入发送调度队列 & entered packet scheduler
+        TIMESTAMP_SCHED,
+        // 交给网卡驱动 & handed to device driver
+        TIMESTAMP_SEND,
+        // 对端确认(仅TCP) & acknowledged by peer (tcp only)
+        TIMESTAMP_ACK
+    };
+
+    // 单条消息的内核时间戳
+    // kernel timestamps of one message
+    struct MessageTimestamps {
+        // 时间戳类型 & timestamp type
+        TimestampType   type{TIMESTAMP_RECV};
+        // 发送时间戳对应的字节序号(SOF_TIMESTAMPING_OPT_ID) & byte/datagram key of tx timestamp (SOF_TIMESTAMPING_OPT_ID)
+        uint32_t        id{0};
+        // 软件时间戳(ns,CLOCK_REALTIME),0表示无 & software timestamp (ns,CLOCK_REALTIME),0 for none
+        int64_t         software_ns{0};
+        // 硬件时间戳(ns,网卡时钟),0表示无 & hardware timestamp (ns,NIC clock),0 for none
+        int64_t         hardware_ns{0};
+    };
+
+    // 忙轮询接收配置
+    // busy-poll receive options
+    struct BusyPollOptions {
+        // 初始自旋预算(us) & initial spin budget (us)
+        uint32_t        spin_us{50};
+        // 自适应时的最小自旋预算(us) & min spin budget when adaptive (us)
+        uint32_t        min_spin_us{5};
+        // 自适应时的最大自旋预算(us) & max spin budget when adaptive (us)
+        uint32_t        max_spin_us{1000};
+        // SO_BUSY_POLL 内核忙轮询时长(us),0表示不设置 & SO_BUSY_POLL kernel busy poll time (us),0 for not set
+        uint32_t        kernel_busy_poll_us{0};
+        // 是否根据到达间隔自适应自旋预算 & whether adapt spin budget to inter-arrival time
+        bool            is_adaptive{true};
+    };
+
     // 抽象套接字
     // abstract socket
     class Socket {
@@ -52,12 +128,14 @@ namespace hzd {
         // 套接字类型
         // socket type
         SocketType      type{BAD_SOCKET_TYPE};
+        // 地址族 & address family
+        int             family{AF_INET};
         // 本套接字地址
         // self socket addr
-        sockaddr_in     self_addr{};
+        Endpoint        self_addr{};
         // 目标套接字地址
         // destination socket addr
-        sockaddr_in     dest_addr{};
+        Endpoint        dest_addr{};
         // 接收游标
         // recv cursor
         size_t          recv_cursor{0};
@@ -76,8 +154,31 @@ namespace hzd {
         // 是否为新的操作
         // whether new operate or not
         bool            is_new{true};
+        // 是否忙轮询接收 & whether busy-poll receive
+        bool            busy_poll{false};
+        // 忙轮询时套接字是否为阻塞模式 & whether socket is blocking when busy-poll
+        bool            busy_poll_blocking{true};
+        // 忙轮询配置 & busy-poll options
+        BusyPollOptions busy_poll_options{};
+        // 当前自旋预算(ns) & current spin budget (ns)
+        uint64_t        busy_poll_budget_ns{0};
+        // 到达前平均空等时间(ns) & mean idle wait before arrival (ns)
+        uint64_t        busy_poll_wait_ns{0};
+#ifdef IO_UTILS_SOCKET_METRICS
+        // 热路径指标 & hot path metrics
+        SocketMetrics   metrics;
+#endif
 
-        void _init();
+        /**
+         * 创建套接字 & create socket
+         * @param family 地址族 & address family
+         */
+        void _init(int family = AF_INET);
+        /**
+         * 确保套接字为指定地址族,未绑定时按需重建 & ensure socket of given family,recreate if not bound
+         * @return true表示成功,false表示失败 & true for success,false for failed
+         */
+        bool ensureFamily_(int family);
         /**
          * 发送数据 & send data
          * @param data 数据地址 & data address
@@ -90,6 +191,30 @@ namespace hzd {
          * @return >0 表示成功接收的字节数,0表示需要稍后再次调用,-1表示失败 & return >0 for success recv bytes count,0 for again,-1 for failed
          */
         virtual long recvImpl_(std::string& data) = 0;
+        /**
+         * 单次recvmsg并解析内核时间戳 & recvmsg once and parse kernel timestamps
+         * @param data 保存数据的字符串 & string for data-save
+         * @param size 最大接收字节数 & max bytes to receive
+         * @param from 来源地址,可为空 & from address,nullable
+         * @param from_size 来源地址长度 & from address size
+         * @param timestamps 接收时间戳 & receive timestamps
+         * @return >=0 表示接收的字节数,-2表示需要稍后再次调用,-1表示失败 & return >=0 for recv bytes count,-2 for again,-1 for failed
+         */
+        long recvMessageImpl_(std::string& data,size_t size,sockaddr* from,socklen_t* from_size,MessageTimestamps& timestamps);
+        /**
+         * 单次接收,开启忙轮询时先自旋后阻塞等待 & receive once,spin then block wait when busy-poll enabled
+         * @param buffer 接收缓冲区 & recv buffer
+         * @param size 缓冲区大小 & buffer size
+         * @param from 来源地址,可为空 & from address,nullable
+         * @param from_size 来源地址长度 & from address size
+         * @return 同recvfrom & same as recvfrom
+         */
+        long recvSome_(char* buffer,size_t size,sockaddr* from,socklen_t* from_size);
+        /**
+         * 根据到达间隔调整自旋预算 & adapt spin budget by inter-arrival time
+         * @param wait_ns 本次数据到达前的空等时间 & idle wait before this arrival
+         */
+        void busyPollAdapt_(uint64_t wait_ns);
     public:
         /**
          * 构造函数
@@ -111,12 +236,19 @@ namespace hzd {
          * 获取套接字本地地址 & get socket self address
          * @return 套接字本地地址 & socket self address
          */
-        inline const sockaddr_in&  Addr() const { return self_addr; };
+        inline const Endpoint& Addr() const { return self_addr; };
         /**
          * 获取套接字目标地址 & get socket destination address
          * @return 套接字目的地址 & socket destination address
          */
-        inline const sockaddr_in& DestAddr() const { return dest_addr; };
+        inline const Endpoint& DestAddr() const { return dest_addr; };
+#ifdef IO_UTILS_SOCKET_METRICS
+        /**
+         * 获取本套接字的指标快照 & get metrics snapshot of this socket
+         * @return 计数器快照 & counters snapshot
+         */
+        inline SocketCountersSnapshot Metrics() const { return metrics.Snapshot(); };
+#endif
         /**
          * 关闭套接字 & close socket
          * @return true表示成功,false表示失败 & true for success,false for failed
@@ -162,13 +294,40 @@ namespace hzd {
          * @return true 成功, false 失败 & true for success,false for failed
          */
         virtual bool RecvFile(const std::string& file_path,size_t file_size) = 0;
+        /**
+         * 开启内核时间戳(SO_TIMESTAMPING) & enable kernel timestamping (SO_TIMESTAMPING)
+         * @param is_tx 是否记录发送时间戳 & whether record send timestamps
+         * @param is_rx 是否记录接收时间戳 & whether record receive timestamps
+         * @param is_hardware 是否使用网卡硬件时间戳 & whether use NIC hardware timestamps
+         * @return true表示成功,false表示失败 & true for success,false for failed
+         */
+        bool EnableTimestamping(bool is_tx,bool is_rx,bool is_hardware = false);
+        /**
+         * 从错误队列读取一条发送时间戳 & read one send timestamp from error queue
+         * @param timestamps 时间戳返回值 & timestamps return
+         * @return true表示读到,false表示暂无或失败 & true for read,false for none or failed
+         */
+        bool ReadTxTimestamp(MessageTimestamps& timestamps);
+        /**
+         * 设置忙轮询接收模式 & set busy-poll receive mode
+         * @brief 需在套接字创建(Connect/Accept/Bind)之后调用 & must be called after socket created (Connect/Accept/Bind)
+         * @param is_enable 是否开启 & whether enable
+         * @param options 忙轮询配置 & busy-poll options
+         * @return true表示成功,false表示失败 & true for success,false for failed
+         */
+        bool SetBusyPoll(bool is_enable,const BusyPollOptions& options = BusyPollOptions());
+        /**
+         * 获取当前自旋预算 & get current spin budget
+         * @return 自旋预算(us) & spin budget (us)
+         */
+        inline uint64_t BusyPollBudget() const { return busy_poll_budget_ns / 1000; };
     };
 
     class TcpSocket : public Socket {
     public:
         TcpSocket() : Socket(SOCK_STREAM) {}
 
-        TcpSocket(SOCKET sock,sockaddr_in dest_addr);
+        TcpSocket(SOCKET sock,const Endpoint& dest_addr);
 
         TcpSocket(const TcpSocket&) = delete;
         TcpSocket& operator=(TcpSocket&) = delete;
@@ -182,10 +341,87 @@ namespace hzd {
         long Send(std::string& data) override;
 
         long Recv(std::string &data, size_t size, bool is_append) override;
+        /**
+         * 接收数据到池化缓冲区 & recv data into pooled buffer
+         * @brief 缓冲区容量不足或被共享时从池中重新申请 & re-acquire from pool when buffer is too small or shared
+         * @param buffer 缓冲区 & buffer
+         * @param size 需要接收数据大小 & size of data need recv
+         * @param pool 缓冲区池 & buffer pool
+         * @return >0 表示成功接收的字节数,0表示需要稍后再次调用,-1表示失败 & return >0 for success recv bytes count,0 for again,-1 for failed
+         */
+        long Recv(Buffer& buffer,size_t size,BufferPool& pool = BufferPool::Default());
 
         bool SendFile(const std::string &file_path) override;
 
         bool RecvFile(const std::string &file_path, size_t file_size) override;
+        /**
+         * 发送已映射文件的区间,Linux下经sendfile零拷贝 & send range of mapped file,zero-copy via sendfile on Linux
+         * @brief 阻塞直到发送完成 & blocks until done
+         * @param file 已映射文件 & mapped file
+         * @param offset 偏移 & offset
+         * @param length 长度,越界部分被截断 & length,clamped to file size
+         * @return true表示成功,false表示失败 & true for success,false for failed
+         */
+        bool SendFile(const MappedFile& file,size_t offset = 0,size_t length = SIZE_MAX);
+        /**
+         * 发送稀疏文件,只传输区段表和数据区段,跳过空洞 & send sparse file,only extent map and data extents are sent,holes skipped
+         * @brief 阻塞直到发送完成,对端需使用RecvSparseFile接收 & blocks until done,peer must receive with RecvSparseFile
+         * @param file_path 文件路径 & file path
+         * @return true表示成功,false表示失败 & true for success,false for failed
+         */
+        bool SendSparseFile(const std::string& file_path);
+        /**
+         * 接收稀疏文件并在本地重建空洞 & recv sparse file and recreate holes locally
+         * @brief 阻塞直到接收完成,文件大小由发送端给出 & blocks until done,file size is given by sender
+         * @param file_path 文件路径 & file path
+         * @return true表示成功,false表示失败 & true for success,false for failed
+         */
+        bool RecvSparseFile(const std::string& file_path);
+        /**
+         * 发送文件并同时计算CRC32C,数据经mmap读取后sendfile,页面只读入一次 & send file and compute CRC32C on the way,pages are read once via mmap then sendfile
+         * @brief 阻塞直到发送完成 & blocks until done
+         * @param file_path 文件路径 & file path
+         * @param crc32c 文件的CRC32C & CRC32C of file
+         * @return true表示成功,false表示失败 & true for success,false for failed
+         */
+        bool SendFile(const std::string& file_path,uint32_t& crc32c);
+        /**
+         * 接收文件并同时计算CRC32C,经FileWriter后台落盘 & recv file and compute CRC32C on the way,written in background by FileWriter
+         * @brief 阻塞直到接收完成 & blocks until done
+         * @param file_path 文件路径 & file path
+         * @param file_size 文件大小 & file size
+         * @param crc32c 接收内容的CRC32C & CRC32C of received content
+         * @return true表示成功,false表示失败 & true for success,false for failed
+         */
+        bool RecvFile(const std::string& file_path,size_t file_size,uint32_t& crc32c);
+        /**
+         * 阻塞发送全部数据,非阻塞socket上等待可写 & send all data blocking,waits for writability on non-blocking sockets
+         * @param data 数据地址 & data address
+         * @param size 数据大小 & data size
+         * @return true表示成功,false表示失败 & true for success,false for failed
+         */
+        bool SendAll(const char* data,size_t size);
+        /**
+         * 阻塞接收指定长度数据,非阻塞socket上等待可读 & recv exact size blocking,waits for readability on non-blocking sockets
+         * @param data 缓冲区 & buffer
+         * @param size 需要接收数据大小 & size of data need recv
+         * @return true表示成功,false表示失败或对端关闭 & true for success,false for failed or closed by peer
+         */
+        bool RecvAll(char* data,size_t size);
+        /**
+         * 采样TCP_INFO & sample TCP_INFO
+         * @param info 采样结果 & sample return
+         * @return true表示成功,false表示失败 & true for success,false for failed
+         */
+        bool TcpInfo(TcpInfoSample& info) const;
+        /**
+         * 单次接收并获取内核接收时间戳 & receive once with kernel receive timestamp
+         * @param data 保存数据的字符串 & string for data-save
+         * @param size 最大接收字节数 & max bytes to receive
+         * @param timestamps 接收时间戳 & receive timestamps
+         * @return >0 表示成功接收的字节数,0表示需要稍后再次调用,-1表示失败 & return >0 for success recv bytes count,0 for again,-1 for failed
+         */
+        long RecvMessage(std::string& data,size_t size,MessageTimestamps& timestamps);
 
     protected:
         long sendImpl_(const char *data) override;
@@ -201,6 +437,12 @@ namespace hzd {
          * @param port 绑定端口 & bind port
          */
         TcpListener(const std::string& ip,unsigned short port);
+        /**
+         * 构造函数 & constructor
+         * @brief IPv6地址默认双栈监听 & IPv6 address listens dual-stack by default
+         * @param endpoint 绑定地址 & bind address
+         */
+        explicit TcpListener(const Endpoint& endpoint);
         /**
          * bind address
          * @return true表示成功,false表示失败 & true for success,false for failed
@@ -228,11 +470,16 @@ namespace hzd {
          * @return true表示成功,false表示失败 & true for success,false for failed
          */
         bool Connect(const std::string& ip,unsigned short port);
+        /**
+         * 连接到目标套接字 & connect to destination socket
+         * @param endpoint 目标地址 & destination address
+         * @return true表示成功,false表示失败 & true for success,false for failed
+         */
+        bool Connect(const Endpoint& endpoint);
     };
 
     class UdpSocket : public Socket {
-        sockaddr_in             from_addr{};
-        int                     from_addr_size{sizeof(sockaddr_in)};
+        Endpoint                from_addr{};
     private:
         long Send(const char *data, size_t size) override;
 
@@ -249,6 +496,13 @@ namespace hzd {
         UdpSocket() : Socket(SOCK_DGRAM) {_init();}
 
         bool Bind(const std::string& ip,unsigned short port);
+        /**
+         * 绑定地址 & bind address
+         * @brief 地址族与当前套接字不同时重建套接字 & recreate socket when family differs
+         * @param endpoint 绑定地址 & bind address
+         * @return true表示成功,false表示失败 & true for success,false for failed
+         */
+        bool Bind(const Endpoint& endpoint);
         /**
          * 发送数据到ip:port & send data to ip:port
          * @param ip 目标ip & destination ip
@@ -282,14 +536,75 @@ namespace hzd {
          * @return
          */
         bool SendFileTo(const std::string& ip,unsigned short port,const std::string& file_path);
+        /**
+         * 发送数据到预解析地址 & send data to pre-resolved address
+         * @param endpoint 目标地址 & destination address
+         * @param data 数据地址 & data address
+         * @param size 数据大小 & data size
+         * @return >0 表示成功发送的字节数,0表示需要稍后再次调用,-1表示失败 & return >0 for success send bytes count,0 for again,-1 for failed
+         */
+        long SendTo(const Endpoint& endpoint,const char* data,size_t size);
+        /**
+         * 发送数据到预解析地址 & send data to pre-resolved address
+         * @param endpoint 目标地址 & destination address
+         * @param data 数据 & data
+         * @return >0 表示成功发送的字节数,0表示需要稍后再次调用,-1表示失败 & return >0 for success send bytes count,0 for again,-1 for failed
+         */
+        long SendTo(const Endpoint& endpoint,const std::string& data);
+        /**
+         * 发送文件到预解析地址 & send file to pre-resolved address
+         * @param endpoint 目标地址 & destination address
+         * @param file_path 文件路径 & file path
+         * @return true 成功, false 失败 & true for success,false for failed
+         */
+        bool SendFileTo(const Endpoint& endpoint,const std::string& file_path);
+        /**
+         * 直接从映射内存发送一个数据报 & send one datagram directly from mapped memory
+         * @param endpoint 目标地址 & destination address
+         * @param view 映射区间视图 & mapped range view
+         * @return >0 表示成功发送的字节数,0表示需要稍后再次调用,-1表示失败 & return >0 for success send bytes count,0 for again,-1 for failed
+         */
+        long SendTo(const Endpoint& endpoint,const MappedView& view);
+        /**
+         * 将已映射文件按数据报切分发送,不经过中间缓冲区 & send mapped file split into datagrams,without intermediate buffer
+         * @param endpoint 目标地址 & destination address
+         * @param file 已映射文件 & mapped file
+         * @param datagram_size 每个数据报的大小 & size of each datagram
+         * @return true 成功, false 失败 & true for success,false for failed
+         */
+        bool SendFileTo(const Endpoint& endpoint,const MappedFile& file,size_t datagram_size = 4096);
 
         long Recv(std::string &data, size_t size, bool is_append) override;
+        /**
+         * 接收数据报到池化缓冲区 & recv datagrams into pooled buffer
+         * @brief 缓冲区容量不足或被共享时从池中重新申请 & re-acquire from pool when buffer is too small or shared
+         * @param buffer 缓冲区 & buffer
+         * @param size 需要接收数据大小 & size of data need recv
+         * @param pool 缓冲区池 & buffer pool
+         * @return >0 表示成功接收的字节数,0表示需要稍后再次调用,-1表示失败 & return >0 for success recv bytes count,0 for again,-1 for failed
+         */
+        long Recv(Buffer& buffer,size_t size,BufferPool& pool = BufferPool::Default());
 
         bool RecvFile(const std::string &file_path, size_t file_size) override;
+    private:
+        /**
+         * 设置目标地址,双栈套接字发往IPv4时转为映射地址 & set destination,IPv4 mapped for dual-stack socket
+         * @return true表示成功,false表示失败 & true for success,false for failed
+         */
+        bool setDest_(const Endpoint& endpoint);
+    public:
+        /**
+         * 接收一个数据报并获取内核接收时间戳 & receive one datagram with kernel receive timestamp
+         * @param data 保存数据的字符串 & string for data-save
+         * @param size 最大接收字节数 & max bytes to receive
+         * @param timestamps 接收时间戳 & receive timestamps
+         * @return >0 表示成功接收的字节数,0表示需要稍后再次调用,-1表示失败 & return >0 for success recv bytes count,0 for again,-1 for failed
+         */
+        long RecvMessage(std::string& data,size_t size,MessageTimestamps& timestamps);
         /**
          * @return 接受数据的来源地址 & data-recv from address
          */
-        sockaddr_in FromAddr() const;
+        const Endpoint& FromAddr() const;
     };
 } // hzd
 
@@ -0,0 +1,262 @@
+/**
+  ******************************************************************************
+  * @file           : SocketMetrics.cpp
+  * @author         : huzhida
+  * @brief          : None
+  * @date           : 2026/10/18
+  ******************************************************************************
+  */
+#include "SocketMetrics.h"
+#include <cerrno>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+
+namespace hzd {
+
+    namespace {
+        enum CounterIndex {
+            BYTES_SENT = 0,
+            BYTES_RECV,
+            SEND_CALLS,
+            RECV_CALLS,
+            SEND_EAGAIN,
+            RECV_EAGAIN,
+            SHORT_SENDS,
+            SHORT_RECVS,
+            SEND_ERRORS,
+            RECV_ERRORS,
+            COUNTER_COUNT
+        };
+
+        // 线程本地分片,仅由所属线程写入,因此使用load+store而非原子读改写
+        // thread local shard,written by owner thread only,so load+store is used instead of atomic RMW
+        struct MetricsShard {
+            std::atomic<uint64_t>   counters[COUNTER_COUNT];
+            std::atomic<uint64_t>   send_hist[LatencyHistogramSnapshot::bucket_count];
+            std::atomic<uint64_t>   recv_hist[LatencyHistogramSnapshot::bucket_count];
+            std::atomic<uint64_t>   send_sum;
+            std::atomic<uint64_t>   send_max;
+            std::atomic<uint64_t>   recv_sum;
+            std::atomic<uint64_t>   recv_max;
+        };
+
+        struct MetricsRegistry {
+            std::mutex                  mutex;
+            std::vector<MetricsShard*>  shards;
+            // 已退出线程的累计值 & accumulation of exited threads
+            SocketMetricsSnapshot       retired;
+        };
+
+        // 故意不释放,保证晚于thread_local析构 & intentionally leaked so it outlives thread_local destructors
+        MetricsRegistry& registry() {
+            static auto* instance = new MetricsRegistry;
+            return *instance;
+        }
+
+        inline void bump(std::atomic<uint64_t>& value,uint64_t n) {
+            value.store(value.load(std::memory_order_relaxed) + n,std::memory_order_relaxed);
+        }
+
+        inline void bumpMax(std::atomic<uint64_t>& value,uint64_t n) {
+            if(n > value.load(std::memory_order_relaxed)) value.store(n,std::memory_order_relaxed);
+        }
+
+        void collect(const MetricsShard& shard,SocketMetricsSnapshot& snapshot) {
+            uint64_t c[COUNTER_COUNT];
+            for(size_t i = 0; i < COUNTER_COUNT; i++) c[i] = shard.counters[i].load(std::memory_order_relaxed);
+            SocketCountersSnapshot counters;
+            counters.bytes_sent = c[BYTES_SENT];
+            counters.bytes_recv = c[BYTES_RECV];
+            counters.send_calls = c[SEND_CALLS];
+            counters.recv_calls = c[RECV_CALLS];
+            counters.send_eagain = c[SEND_EAGAIN];
+            counters.recv_eagain = c[RECV_EAGAIN];
+            counters.short_sends = c[SHORT_SENDS];
+            counters.short_recvs = c[SHORT_RECVS];
+            counters.send_errors = c[SEND_ERRORS];
+            counters.recv_errors = c[RECV_ERRORS];
+            snapshot.counters.Merge(counters);
+
+            LatencyHistogramSnapshot send,recv;
+            for(size_t i = 0; i < LatencyHistogramSnapshot::bucket_count; i++) {
+                send.counts[i] = shard.send_hist[i].load(std::memory_order_relaxed);
+                send.total += send.counts[i];
+                recv.counts[i] = shard.recv_hist[i].load(std::memory_order_relaxed);
+                recv.total += recv.counts[i];
+            }
+            send.sum = shard.send_sum.load(std::memory_order_relaxed);
+            send.max = shard.send_max.load(std::memory_order_relaxed);
+            recv.sum = shard.recv_sum.load(std::memory_order_relaxed);
+            recv.max = shard.recv_max.load(std::memory_order_relaxed);
+            snapshot.send_latency.Merge(send);
+            snapshot.recv_latency.Merge(recv);
+        }
+
+        struct ShardHolder {
+            MetricsShard* shard;
+
+            ShardHolder() : shard(new MetricsShard()) {
+                auto& r = registry();
+                std::lock_guard<std::mutex> guard(r.mutex);
+                r.shards.push_back(shard);
+            }
+
+            ~ShardHolder() {
+                auto& r = registry();
+                std::lock_guard<std::mutex> guard(r.mutex);
+                collect(*shard,r.retired);
+                r.shards.erase(std::remove(r.shards.begin(),r.shards.end(),shard),r.shards.end());
+                delete shard;
+            }
+        };
+
+        inline MetricsShard& localShard() {
+            thread_local ShardHolder holder;
+            return *holder.shard;
+        }
+    }
+
+    constexpr size_t LatencyHistogramSnapshot::sub_bucket_bits;
+    constexpr size_t LatencyHistogramSnapshot::max_value_bits;
+    constexpr size_t LatencyHistogramSnapshot::linear_count;
+    constexpr size_t LatencyHistogramSnapshot::bucket_count;
+
+    size_t LatencyHistogramSnapshot::BucketIndex(uint64_t ns) {
+        if(ns < linear_count) return static_cast<size_t>(ns);
+        const uint64_t limit = (uint64_t(1) << max_value_bits) - 1;
+        if(ns > limit) ns = limit;
+        size_t exponent = 63;
+        while(!(ns >> exponent)) exponent--;
+        size_t sub = static_cast<size_t>(ns >> (exponent - sub_bucket_bits)) & ((size_t(1) << sub_bucket_bits) - 1);
+        return linear_count + (exponent - sub_bucket_bits - 1) * (size_t(1) << sub_bucket_bits) + sub;
+    }
+
+    uint64_t LatencyHistogramSnapshot::BucketUpperBound(size_t index) {
+        if(index < linear_count) return index;
+        size_t offset = index - linear_count;
+        size_t exponent = offset / (size_t(1) << sub_bucket_bits) + sub_bucket_bits + 1;
+        uint64_t sub = offset % (size_t(1) << sub_bucket_bits);
+        uint64_t lower = ((uint64_t(1) << sub_bucket_bits) + sub) << (exponent - sub_bucket_bits);
+        return lower + (uint64_t(1) << (exponent - sub_bucket_bits)) - 1;
+    }
+
+    uint64_t LatencyHistogramSnapshot::Percentile(double percentile) const {
+        if(total == 0) return 0;
+        if(percentile < 0) percentile = 0;
+        if(percentile > 100) percentile = 100;
+        auto target = static_cast<uint64_t>(percentile / 100.0 * static_cast<double>(total) + 0.5);
+        if(target == 0) target = 1;
+        uint64_t seen = 0;
+        for(size_t i = 0; i < bucket_count; i++) {
+            seen += counts[i];
+            if(seen >= target) return std::min(BucketUpperBound(i),max);
+        }
+        return max;
+    }
+
+    void LatencyHistogramSnapshot::Merge(const LatencyHistogramSnapshot &other) {
+        for(size_t i = 0; i < bucket_count; i++) counts[i] += other.counts[i];
+        total += other.total;
+        sum += other.sum;
+        if(other.max > max) max = other.max;
+    }
+
+    void SocketCountersSnapshot::Merge(const SocketCountersSnapshot &other) {
+        bytes_sent += other.bytes_sent;
+        bytes_recv += other.bytes_recv;
+        send_calls += other.send_calls;
+        recv_calls += other.recv_calls;
+        send_eagain += other.send_eagain;
+        recv_eagain += other.recv_eagain;
+        short_sends += other.short_sends;
+        short_recvs += other.short_recvs;
+        send_errors += other.send_errors;
+        recv_errors += other.recv_errors;
+    }
+
+    void SocketMetrics::RecordSend(size_t requested, long ret, int err, uint64_t ns) {
+        auto& shard = localShard();
+        send_calls.fetch_add(1,std::memory_order_relaxed);
+        bump(shard.counters[SEND_CALLS],1);
+        if(ret > 0) {
+            bytes_sent.fetch_add(ret,std::memory_order_relaxed);
+            bump(shard.counters[BYTES_SENT],ret);
+            if(static_cast<size_t>(ret) < requested) {
+                short_sends.fetch_add(1,std::memory_order_relaxed);
+                bump(shard.counters[SHORT_SENDS],1);
+            }
+        }else if(ret < 0 && (err == EAGAIN || err == EWOULDBLOCK)) {
+            send_eagain.fetch_add(1,std::memory_order_relaxed);
+            bump(shard.counters[SEND_EAGAIN],1);
+        }else {
+            send_errors.fetch_add(1,std::memory_order_relaxed);
+            bump(shard.counters[SEND_ERRORS],1);
+        }
+        bump(shard.send_hist[LatencyHistogramSnapshot::BucketIndex(ns)],1);
+        bump(shard.send_sum,ns);
+        bumpMax(shard.send_max,ns);
+    }
+
+    void SocketMetrics::RecordRecv(size_t requested, long ret, int err, uint64_t ns) {
+        auto& shard = localShard();
+        recv_calls.fetch_add(1,std::memory_order_relaxed);
+        bump(shard.counters[RECV_CALLS],1);
+        if(ret > 0) {
+            bytes_recv.fetch_add(ret,std::memory_order_relaxed);
+            bump(shard.counters[BYTES_RECV],ret);
+            if(static_cast<size_t>(ret) < requested) {
+                short_recvs.fetch_add(1,std::memory_order_relaxed);
+                bump(shard.counters[SHORT_RECVS],1);
+            }
+        }else if(ret < 0) {
+            if(err == EAGAIN || err == EWOULDBLOCK) {
+                recv_eagain.fetch_add(1,std::memory_order_relaxed);
+                bump(shard.counters[RECV_EAGAIN],1);
+            }else {
+                recv_errors.fetch_add(1,std::memory_order_relaxed);
+                bump(shard.counters[RECV_ERRORS],1);
+            }
+        }
+        bump(shard.recv_hist[LatencyHistogramSnapshot::BucketIndex(ns)],1);
+        bump(shard.recv_sum,ns);
+        bumpMax(shard.recv_max,ns);
+    }
+
+    SocketCountersSnapshot SocketMetrics::Snapshot() const {
+        SocketCountersSnapshot snapshot;
+        snapshot.bytes_sent = bytes_sent.load(std::memory_order_relaxed);
+        snapshot.bytes_recv = bytes_recv.load(std::memory_order_relaxed);
+        snapshot.send_calls = send_calls.load(std::memory_order_relaxed);
+        snapshot.recv_calls = recv_calls.load(std::memory_order_relaxed);
+        snapshot.send_eagain = send_eagain.load(std::memory_order_relaxed);
+        snapshot.recv_eagain = recv_eagain.load(std::memory_order_relaxed);
+        snapshot.short_sends = short_sends.load(std::memory_order_relaxed);
+        snapshot.short_recvs = short_recvs.load(std::memory_order_relaxed);
+        snapshot.send_errors = send_errors.load(std::memory_order_relaxed);
+        snapshot.recv_errors = recv_errors.load(std::memory_order_relaxed);
+        return snapshot;
+    }
+
+    void SocketMetrics::Assign(const SocketMetrics &other) {
+        auto snapshot = other.Snapshot();
+        bytes_sent.store(snapshot.bytes_sent,std::memory_order_relaxed);
+        bytes_recv.store(snapshot.bytes_recv,std::memory_order_relaxed);
+        send_calls.store(snapshot.send_calls,std::memory_order_relaxed);
+        recv_calls.store(snapshot.recv_calls,std::memory_order_relaxed);
+        send_eagain.store(snapshot.send_eagain,std::memory_order_relaxed);
+        recv_eagain.store(snapshot.recv_eagain,std::memory_order_relaxed);
+        short_sends.store(snapshot.short_sends,std::memory_order_relaxed);
+        short_recvs.store(snapshot.short_recvs,std::memory_order_relaxed);
+        send_errors.store(snapshot.send_errors,std::memory_order_relaxed);
+        recv_errors.store(snapshot.recv_errors,std::memory_order_relaxed);
+    }
+
+    SocketMetricsSnapshot GlobalSocketMetrics() {
+        auto& r = registry();
+        std::lock_guard<std::mutex> guard(r.mutex);
+        SocketMetricsSnapshot snapshot = r.retired;
+        for(auto shard : r.shards) collect(*shard,snapshot);
+        return snapshot;
+    }
+} // hzd
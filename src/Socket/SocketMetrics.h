@@ -0,0 +1,162 @@
+/**
+  ******************************************************************************
+  * @file           : SocketMetrics.h
+  * @author         : huzhida
+  * @brief          : 套接字热路径指标统计
+  * @date           : 2026/10/18
+  ******************************************************************************
+  */
+
+#ifndef IO_UTILS_SOCKETMETRICS_H
+#define IO_UTILS_SOCKETMETRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace hzd {
+    // 延迟直方图快照,对数线性分桶(HDR风格),单位为纳秒
+    // latency histogram snapshot,log-linear buckets (HDR style),unit is ns
+    struct LatencyHistogramSnapshot {
+        // 每个2的幂区间内的子桶位数 & sub-bucket bits per power of two
+        static constexpr size_t  sub_bucket_bits = 3;
+        // 可记录的最大值位数,更大的值被截断 & max recordable value bits,larger values are clamped
+        static constexpr size_t  max_value_bits = 41;
+        static constexpr size_t  linear_count = size_t(1) << (sub_bucket_bits + 1);
+        static constexpr size_t  bucket_count = linear_count + (max_value_bits - sub_bucket_bits - 1) * (size_t(1) << sub_bucket_bits);
+
+        // 各桶计数 & bucket counts
+        uint64_t        counts[bucket_count]{};
+        // 样本总数 & sample count
+        uint64_t        total{0};
+        // 样本总和 & sample sum
+        uint64_t        sum{0};
+        // 最大样本 & max sample
+        uint64_t        max{0};
+
+        /**
+         * 计算样本值所在桶 & get bucket index of value
+         * @param ns 样本值 & sample value
+         * @return 桶下标 & bucket index
+         */
+        static size_t BucketIndex(uint64_t ns);
+        /**
+         * 桶可表示的最大值 & max value represented by bucket
+         * @param index 桶下标 & bucket index
+         * @return 桶上界 & bucket upper bound
+         */
+        static uint64_t BucketUpperBound(size_t index);
+        /**
+         * 百分位数 & percentile
+         * @param percentile 0~100
+         * @return 百分位延迟(ns),无样本时为0 & percentile latency (ns),0 if no sample
+         */
+        uint64_t Percentile(double percentile) const;
+        /**
+         * 平均值 & mean
+         * @return 平均延迟(ns) & mean latency (ns)
+         */
+        uint64_t Mean() const { return total ? sum / total : 0; }
+        /**
+         * 合并另一个直方图 & merge another histogram
+         */
+        void Merge(const LatencyHistogramSnapshot& other);
+    };
+
+    // 套接字计数器快照
+    // socket counters snapshot
+    struct SocketCountersSnapshot {
+        // 发送字节数 & bytes sent
+        uint64_t        bytes_sent{0};
+        // 接收字节数 & bytes received
+        uint64_t        bytes_recv{0};
+        // 发送系统调用次数 & send syscalls issued
+        uint64_t        send_calls{0};
+        // 接收系统调用次数 & recv syscalls issued
+        uint64_t        recv_calls{0};
+        // 发送EAGAIN次数 & send EAGAIN count
+        uint64_t        send_eagain{0};
+        // 接收EAGAIN次数 & recv EAGAIN count
+        uint64_t        recv_eagain{0};
+        // 短写次数 & short write count
+        uint64_t        short_sends{0};
+        // 短读次数 & short read count
+        uint64_t        short_recvs{0};
+        // 发送错误次数 & send error count
+        uint64_t        send_errors{0};
+        // 接收错误次数 & recv error count
+        uint64_t        recv_errors{0};
+
+        void Merge(const SocketCountersSnapshot& other);
+    };
+
+    // 全局指标快照
+    // global metrics snapshot
+    struct SocketMetricsSnapshot {
+        SocketCountersSnapshot      counters;
+        // send/sendto调用延迟 & send/sendto call latency
+        LatencyHistogramSnapshot    send_latency;
+        // recv/recvfrom调用延迟 & recv/recvfrom call latency
+        LatencyHistogramSnapshot    recv_latency;
+    };
+
+    // 单个套接字的指标,计数以relaxed原子累加,同时汇入当前线程的全局分片
+    // per socket metrics,counters accumulate with relaxed atomics and also feed the calling thread's global shard
+    class SocketMetrics {
+    public:
+        SocketMetrics() = default;
+        SocketMetrics(const SocketMetrics& other) { Assign(other); }
+        SocketMetrics& operator=(const SocketMetrics& other) { Assign(other); return *this; }
+        /**
+         * 记录一次发送系统调用 & record one send syscall
+         * @param requested 请求发送字节数 & requested bytes
+         * @param ret 系统调用返回值 & syscall return value
+         * @param err 系统调用后的errno & errno after syscall
+         * @param ns 调用耗时 & call latency (ns)
+         */
+        void RecordSend(size_t requested,long ret,int err,uint64_t ns);
+        /**
+         * 记录一次接收系统调用 & record one recv syscall
+         * @param requested 接收缓冲区大小 & recv buffer size
+         * @param ret 系统调用返回值 & syscall return value
+         * @param err 系统调用后的errno & errno after syscall
+         * @param ns 调用耗时 & call latency (ns)
+         */
+        void RecordRecv(size_t requested,long ret,int err,uint64_t ns);
+        /**
+         * 获取本套接字计数快照 & get counters snapshot of this socket
+         */
+        SocketCountersSnapshot Snapshot() const;
+        /**
+         * 复制另一个套接字的计数 & copy counters from other socket
+         */
+        void Assign(const SocketMetrics& other);
+        /**
+         * 单调时钟纳秒 & monotonic clock in ns
+         */
+        static inline uint64_t Now() {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+    private:
+        std::atomic<uint64_t>       bytes_sent{0};
+        std::atomic<uint64_t>       bytes_recv{0};
+        std::atomic<uint64_t>       send_calls{0};
+        std::atomic<uint64_t>       recv_calls{0};
+        std::atomic<uint64_t>       send_eagain{0};
+        std::atomic<uint64_t>       recv_eagain{0};
+        std::atomic<uint64_t>       short_sends{0};
+        std::atomic<uint64_t>       short_recvs{0};
+        std::atomic<uint64_t>       send_errors{0};
+        std::atomic<uint64_t>       recv_errors{0};
+    };
+
+    /**
+     * 获取全部套接字的全局指标(汇总所有线程分片) & get global metrics of all sockets (sum of all thread shards)
+     * @return 全局指标快照 & global metrics snapshot
+     */
+    SocketMetricsSnapshot GlobalSocketMetrics();
+} // hzd
+
+#endif //IO_UTILS_SOCKETMETRICS_H
@@ -0,0 +1,216 @@
+/**
+  ******************************************************************************
+  * @file           : TailReader.cpp
+  * @author         : huzhida
+  * @brief          : None
+  * @date           : 2026/10/18
+  ******************************************************************************
+  */
+#ifdef __linux__
+#include <sys/stat.h>
+#include <sys/sendfile.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+#include <Mole.h>
+#include "TailReader.h"
+#include "../FileSystem/FileSystem.h"
+#include "../Socket/Socket.h"
+#include <algorithm>
+#include <chrono>
+
+namespace hzd {
+
+    const std::string io_tail_reader_channel = "io.TailReader";
+
+    TailReader::~TailReader() {
+        Close();
+    }
+
+    bool TailReader::Open(const std::string &path_, const TailOptions &options_) {
+        Close();
+#ifdef __linux__
+        path = path_;
+        options = options_;
+        // 监视所在目录而非文件本身,才能看到轮转后新建的同名文件 & watch the parent dir instead of the file,so the recreated file after rotation is seen
+        WatchOptions watch_options;
+        watch_options.is_recursive = false;
+        if(!watcher.Open([](const WatchEvent&) {}) || !watcher.Add(filesystem::parent_dir(path),watch_options)) {
+            watcher.Close();
+            return false;
+        }
+        if(reopen_() && !options.is_from_start) {
+            struct stat st{};
+            if(fstat(fd,&st) == 0) offset = st.st_size;
+        }
+        rotations = 0;
+        return true;
+#elif _WIN32
+        MOLE_ERROR(io_tail_reader_channel,"TailReader is not supported on windows");
+        return false;
+#endif
+    }
+
+    void TailReader::Close() {
+#ifdef __linux__
+        if(fd >= 0) close(fd);
+#endif
+        fd = -1;
+        offset = 0;
+        watcher.Close();
+    }
+
+    long TailReader::Read(char *buffer, size_t size) {
+#ifdef __linux__
+        if(watcher.Fd() < 0) {
+            MOLE_ERROR(io_tail_reader_channel,"reader not opened");
+            return -1;
+        }
+        while(true) {
+            if(fd >= 0) {
+                checkTruncate_();
+                ssize_t ret = pread(fd,buffer,size,static_cast<off_t>(offset));
+                if(ret < 0) {
+                    if(errno == EINTR) continue;
+                    MOLE_ERROR(io_tail_reader_channel,strerror(errno),{ MOLE_VAR(path) });
+                    return -1;
+                }
+                if(ret > 0) {
+                    offset += static_cast<uint64_t>(ret);
+                    return ret;
+                }
+            }
+            // 旧文件读完后才切换,轮转前的尾部不会丢失 & switch only after old file is drained,so the tail before rotation isn't lost
+            if(!reopen_()) return 0;
+        }
+#elif _WIN32
+        return -1;
+#endif
+    }
+
+    long TailReader::Read(std::string &data) {
+        data.resize(options.read_size);
+        long ret = Read(&data[0],data.size());
+        data.resize(ret > 0 ? static_cast<size_t>(ret) : 0);
+        return ret;
+    }
+
+    long TailReader::SendTo(TcpSocket &socket, size_t max_size) {
+#ifdef __linux__
+        if(watcher.Fd() < 0) {
+            MOLE_ERROR(io_tail_reader_channel,"reader not opened");
+            return -1;
+        }
+        while(true) {
+            struct stat st{};
+            if(fd >= 0) {
+                checkTruncate_();
+                if(fstat(fd,&st) != 0) {
+                    MOLE_ERROR(io_tail_reader_channel,strerror(errno),{ MOLE_VAR(path) });
+                    return -1;
+                }
+            }
+            if(fd >= 0 && static_cast<uint64_t>(st.st_size) > offset) {
+                auto cursor = static_cast<off_t>(offset);
+                auto end = cursor + static_cast<off_t>(std::min<uint64_t>(st.st_size - offset,max_size));
+                while(cursor < end) {
+                    ssize_t ret = sendfile(socket.Sock(),fd,&cursor,static_cast<size_t>(end - cursor));
+                    if(ret < 0) {
+                        if(errno == EINTR) continue;
+                        // socket写满时返回已发送部分(可能为0),由调用者等待可写 & when socket is full return what was sent (maybe 0),caller waits for writability
+                        if(errno == EAGAIN || errno == EWOULDBLOCK) break;
+                        MOLE_ERROR(io_tail_reader_channel,strerror(errno),{ MOLE_VAR(path) });
+                        return -1;
+                    }
+                    if(ret == 0) break;
+                }
+                long sent = static_cast<long>(cursor - static_cast<off_t>(offset));
+                offset = static_cast<uint64_t>(cursor);
+                return sent;
+            }
+            if(!reopen_()) return 0;
+        }
+#elif _WIN32
+        return -1;
+#endif
+    }
+
+    bool TailReader::Wait(int timeout_ms) {
+#ifdef __linux__
+        if(watcher.Fd() < 0) return false;
+        // 先分发已到达的事件,Wait(0)也会读空inotify队列 & dispatch pending events first,so Wait(0) also drains inotify queue
+        if(watcher.Poll(0) < 0) return false;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(std::max(timeout_ms,0));
+        while(true) {
+            if(hasData_()) return true;
+            int remaining = -1;
+            if(timeout_ms >= 0) {
+                auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+                if(left <= 0) return false;
+                remaining = static_cast<int>(left);
+            }
+            // 目录内其他文件的事件也会唤醒,重新检查即可 & events of other files in the dir also wake,just check again
+            if(watcher.Poll(remaining) < 0) return false;
+        }
+#elif _WIN32
+        return false;
+#endif
+    }
+
+    bool TailReader::checkTruncate_() {
+#ifdef __linux__
+        struct stat st{};
+        if(fstat(fd,&st) != 0 || static_cast<uint64_t>(st.st_size) >= offset) return false;
+        MOLE_WARN(io_tail_reader_channel,"file truncated,reading from start",{ MOLE_VAR(path) });
+        offset = 0;
+        rotations++;
+        return true;
+#elif _WIN32
+        return false;
+#endif
+    }
+
+    bool TailReader::reopen_() {
+#ifdef __linux__
+        struct stat st{};
+        if(stat(path.c_str(),&st) != 0) return false;
+        if(fd >= 0 && st.st_dev == device && st.st_ino == inode) return false;
+        int new_fd = open(path.c_str(),O_RDONLY | O_CLOEXEC);
+        if(new_fd < 0) {
+            MOLE_WARN(io_tail_reader_channel,strerror(errno),{ MOLE_VAR(path) });
+            return false;
+        }
+        // 以打开后的fd为准,避免stat与open之间再次轮转 & trust the opened fd,in case of another rotation between stat and open
+        if(fstat(new_fd,&st) != 0) {
+            close(new_fd);
+            return false;
+        }
+        if(fd >= 0) {
+            close(fd);
+            rotations++;
+        }
+        fd = new_fd;
+        device = st.st_dev;
+        inode = st.st_ino;
+        offset = 0;
+        return true;
+#elif _WIN32
+        return false;
+#endif
+    }
+
+    bool TailReader::hasData_() {
+#ifdef __linux__
+        struct stat st{};
+        if(fd >= 0 && fstat(fd,&st) == 0 && static_cast<uint64_t>(st.st_size) != offset) return true;
+        // 路径已指向新文件 & path now points to a new file
+        if(stat(path.c_str(),&st) != 0) return false;
+        return fd < 0 || st.st_dev != device || st.st_ino != inode;
+#elif _WIN32
+        return false;
+#endif
+    }
+
+} // hzd
@@ -0,0 +1,106 @@
+/**
+  ******************************************************************************
+  * @file           : TailReader.h
+  * @author         : huzhida
+  * @brief          : 跟随轮转的日志尾部读取
+  * @date           : 2026/10/18
+  ******************************************************************************
+  */
+
+#ifndef IO_UTILS_TAILREADER_H
+#define IO_UTILS_TAILREADER_H
+
+#include "../FileWatcher/FileWatcher.h"
+#include <cstdint>
+#include <string>
+
+namespace hzd {
+
+    class TcpSocket;
+
+    // 尾部读取配置
+    // tail reader options
+    struct TailOptions {
+        // 是否从文件开头读取,否则从打开时的末尾开始 & whether read from file start,otherwise from the end at open time
+        bool            is_from_start{false};
+        // Read(std::string&)单次读取的上限 & max bytes per Read(std::string&)
+        size_t          read_size{256 * 1024};
+    };
+
+    // 按inode跟随文件,rename轮转时先读完旧文件再切换到新文件,截断时从头读取,经inotify唤醒
+    // follows file by inode,on rename rotation drains the old file before switching to the new one,restarts on truncation,woken by inotify
+    class TailReader {
+    public:
+        TailReader() = default;
+        TailReader(const TailReader&) = delete;
+        TailReader& operator=(const TailReader&) = delete;
+        ~TailReader();
+        /**
+         * 打开,文件可以尚不存在 & open,file may not exist yet
+         * @param path 文件路径 & file path
+         * @param options 配置 & options
+         * @return true表示成功,false表示失败 & true for success,false for failed
+         */
+        bool Open(const std::string& path,const TailOptions& options = TailOptions());
+        /**
+         * 关闭 & close
+         */
+        void Close();
+        /**
+         * 非阻塞读取新追加的数据 & read newly appended data without blocking
+         * @param buffer 缓冲区 & buffer
+         * @param size 缓冲区大小 & buffer size
+         * @return 读取的字节数,0表示暂无新数据,-1表示失败 & bytes read,0 for no new data,-1 for failed
+         */
+        long Read(char* buffer,size_t size);
+        /**
+         * 非阻塞读取新追加的数据,复用data的容量 & read newly appended data without blocking,reusing capacity of data
+         * @param data 数据,被覆盖 & data,overwritten
+         * @return 读取的字节数,0表示暂无新数据,-1表示失败 & bytes read,0 for no new data,-1 for failed
+         */
+        long Read(std::string& data);
+        /**
+         * 将新追加的数据直接发送到socket,Linux下经sendfile不经过用户态 & send newly appended data straight to socket,via sendfile without user space on Linux
+         * @param socket 已连接的socket & connected socket
+         * @param max_size 单次发送上限 & max bytes per call
+         * @return 发送的字节数,socket写满时返回已发送部分,0表示暂无新数据或socket不可写,-1表示失败 & bytes sent,partial count when socket is full,0 for no new data or socket not writable,-1 for failed
+         */
+        long SendTo(TcpSocket& socket,size_t max_size = SIZE_MAX);
+        /**
+         * 等待新数据或轮转 & wait for new data or rotation
+         * @param timeout_ms 超时(ms),-1表示一直等待 & timeout (ms),-1 for infinite
+         * @return true表示有数据可读,false表示超时或失败 & true for data available,false for timeout or failed
+         */
+        bool Wait(int timeout_ms);
+        /**
+         * 可读时应调用Wait(0)分发事件,供调用者的事件循环使用 & when readable call Wait(0) to dispatch events,for caller's event loop
+         */
+        inline int Fd() const { return watcher.Fd(); }
+        /**
+         * 当前文件中的读取位置 & read position in current file
+         */
+        inline uint64_t Offset() const { return offset; }
+        /**
+         * 已跟随的轮转与截断次数 & rotations and truncations followed
+         */
+        inline uint64_t Rotations() const { return rotations; }
+    private:
+        // 截断时回到开头 & rewind on truncation
+        bool checkTruncate_();
+        // 路径指向新inode时切换过去,返回是否切换 & switch when path points to a new inode,returns whether switched
+        bool reopen_();
+        bool hasData_();
+
+        std::string     path;
+        TailOptions     options;
+        int             fd{-1};
+        uint64_t        device{0};
+        uint64_t        inode{0};
+        uint64_t        offset{0};
+        uint64_t        rotations{0};
+        FileWatcher     watcher;
+    };
+
+} // hzd
+
+#endif //IO_UTILS_TAILREADER_H
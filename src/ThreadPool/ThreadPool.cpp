@@ -0,0 +1,97 @@
+/**
+  ******************************************************************************
+  * @file           : ThreadPool.cpp
+  * @author         : huzhida
+  * @brief          : None
+  * @date           : 2026/10/18
+  ******************************************************************************
+  */
+#include "ThreadPool.h"
+
+namespace hzd {
+
+    namespace {
+        // 当前线程所属的线程池与队列下标 & pool and queue index the current thread belongs to
+        thread_local const ThreadPool* current_pool = nullptr;
+        thread_local size_t current_index = 0;
+    }
+
+    ThreadPool::ThreadPool(size_t thread_count) {
+        if(thread_count == 0) thread_count = std::thread::hardware_concurrency();
+        if(thread_count == 0) thread_count = 1;
+        for(size_t i = 0; i < thread_count; i++) queues.emplace_back(new WorkQueue);
+        for(size_t i = 0; i < thread_count; i++) threads.emplace_back(&ThreadPool::run_,this,i);
+    }
+
+    ThreadPool::~ThreadPool() {
+        Wait();
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            is_stop = true;
+        }
+        work_condition.notify_all();
+        for(auto& thread : threads) thread.join();
+    }
+
+    void ThreadPool::Submit(Task task) {
+        size_t index = current_pool == this ? current_index : next_queue.fetch_add(1,std::memory_order_relaxed) % queues.size();
+        pending.fetch_add(1,std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> guard(queues[index]->mutex);
+            queues[index]->tasks.push_back(std::move(task));
+        }
+        queued.fetch_add(1,std::memory_order_release);
+        // 持锁通知,避免与准备休眠的线程之间丢失唤醒 & notify under lock to avoid lost wakeup with a worker going to sleep
+        std::lock_guard<std::mutex> guard(mutex);
+        work_condition.notify_one();
+    }
+
+    void ThreadPool::Wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle_condition.wait(lock,[this] { return pending.load(std::memory_order_acquire) == 0; });
+    }
+
+    bool ThreadPool::take_(size_t index,Task& task) {
+        // 先取自身队列尾部,局部性更好 & own queue back first,better locality
+        {
+            std::lock_guard<std::mutex> guard(queues[index]->mutex);
+            if(!queues[index]->tasks.empty()) {
+                task = std::move(queues[index]->tasks.back());
+                queues[index]->tasks.pop_back();
+                return true;
+            }
+        }
+        for(size_t i = 1; i < queues.size(); i++) {
+            auto& victim = *queues[(index + i) % queues.size()];
+            std::lock_guard<std::mutex> guard(victim.mutex);
+            if(!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void ThreadPool::run_(size_t index) {
+        current_pool = this;
+        current_index = index;
+        Task task;
+        while(true) {
+            if(queued.load(std::memory_order_acquire) > 0 && take_(index,task)) {
+                queued.fetch_sub(1,std::memory_order_relaxed);
+                task();
+                task = nullptr;
+                if(pending.fetch_sub(1,std::memory_order_acq_rel) == 1) {
+                    std::lock_guard<std::mutex> guard(mutex);
+                    idle_condition.notify_all();
+                }
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(mutex);
+            work_condition.wait(lock,[this] { return is_stop || queued.load(std::memory_order_acquire) > 0; });
+            if(is_stop && queued.load(std::memory_order_acquire) == 0) return;
+        }
+    }
+
+} // hzd
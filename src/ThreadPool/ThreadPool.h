@@ -0,0 +1,77 @@
+/**
+  ******************************************************************************
+  * @file           : ThreadPool.h
+  * @author         : huzhida
+  * @brief          : 工作窃取线程池
+  * @date           : 2026/10/18
+  ******************************************************************************
+  */
+
+#ifndef IO_UTILS_THREADPOOL_H
+#define IO_UTILS_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace hzd {
+
+    // 工作窃取线程池,工作线程提交的任务进入自身队列尾部(LIFO),空闲线程从其他队列头部窃取
+    // work-stealing thread pool,tasks submitted by a worker go to the back of its own queue (LIFO),idle workers steal from the front of others
+    class ThreadPool {
+    public:
+        using Task = std::function<void()>;
+        /**
+         * 构造函数 & constructor
+         * @param threads 线程数,0表示硬件并发数 & thread count,0 for hardware concurrency
+         */
+        explicit ThreadPool(size_t threads = 0);
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+        /**
+         * 析构函数,执行完所有已提交任务后退出 & destructor,exits after all submitted tasks are done
+         */
+        ~ThreadPool();
+        /**
+         * 提交任务,可在任务内部调用 & submit task,can be called inside a task
+         * @param task 任务 & task
+         */
+        void Submit(Task task);
+        /**
+         * 等待所有任务(含任务中提交的任务)完成,不可在任务内部调用 & wait until all tasks (including nested ones) are done,must not be called inside a task
+         */
+        void Wait();
+        /**
+         * 线程数 & thread count
+         */
+        inline size_t Size() const { return threads.size(); }
+    private:
+        struct WorkQueue {
+            std::mutex          mutex;
+            std::deque<Task>    tasks;
+        };
+
+        void run_(size_t index);
+        bool take_(size_t index,Task& task);
+
+        std::vector<std::unique_ptr<WorkQueue>>     queues;
+        std::vector<std::thread>                    threads;
+        std::mutex                                  mutex;
+        std::condition_variable                     work_condition;
+        std::condition_variable                     idle_condition;
+        // 已入队未取出的任务数 & queued but not taken tasks
+        std::atomic<size_t>                         queued{0};
+        // 未完成的任务数 & unfinished tasks
+        std::atomic<size_t>                         pending{0};
+        std::atomic<size_t>                         next_queue{0};
+        bool                                        is_stop{false};
+    };
+
+} // hzd
+
+#endif //IO_UTILS_THREADPOOL_H
@@ -10,8 +10,28 @@
 #include "../src/Socket/Socket.h"
 #include "../src/FileSystem/FileSystem.h"
 #include "../src/TimerTask/TimerTask.h"
+#include "../src/BufferPool/BufferPool.h"
+#include "../src/ThreadPool/ThreadPool.h"
+#include "../src/MappedFile/MappedFile.h"
+#include "../src/FileWriter/FileWriter.h"
+#include "../src/AsyncFile/AsyncFile.h"
+#include "../src/FileWatcher/FileWatcher.h"
+#include "../src/MetadataCache/MetadataCache.h"
+#include "../src/GroupCommitWriter/GroupCommitWriter.h"
+#include "../src/Checksum/Checksum.h"
+#include "../src/DeltaSync/DeltaSync.h"
+#include "../src/TailReader/TailReader.h"
+#include "../src/Path/Path.h"
 #include <gtest/gtest.h>
 #include <thread>
+#include <fstream>
+#include <set>
+#include <map>
+#include <atomic>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <netinet/tcp.h>
+#include <poll.h>
 
 #ifdef __linux__
 #define __sleep(x) usleep(1000*x)
@@ -103,6 +123,304 @@ TEST(TEST_TCP,SEND_RECV_FILE) {
     remove("../test/temp_main.cpp");
 }
 
+TEST(TEST_TCP,SEND_RECV_SPARSE_FILE) {
+    int sparse_fd = open("sparse_src.img",O_CREAT | O_WRONLY | O_TRUNC,0644);
+    ASSERT_GE(sparse_fd,0);
+    ASSERT_EQ(pwrite(sparse_fd,"head",4,0),4);
+    ASSERT_EQ(pwrite(sparse_fd,"middle",6,4 * 1024 * 1024),6);
+    ASSERT_EQ(ftruncate(sparse_fd,16 * 1024 * 1024),0);
+    close(sparse_fd);
+
+    hzd::TcpListener listener("127.0.0.1",9999);
+    ASSERT_EQ(listener.Bind(),true);
+    ASSERT_EQ(listener.Listen(),true);
+    hzd::TcpSocket tcp;
+
+    std::thread t([&] {
+        hzd::TcpClient client;
+        ASSERT_EQ(client.Connect("127.0.0.1",9999),true);
+        ASSERT_EQ(client.SendSparseFile("sparse_src.img"),true);
+    });
+
+    ASSERT_EQ(listener.Accept(tcp),true);
+    ASSERT_EQ(tcp.RecvSparseFile("sparse_dest.img"),true);
+    t.join();
+
+    struct stat src_st{},dest_st{};
+    stat("sparse_src.img",&src_st);
+    stat("sparse_dest.img",&dest_st);
+    ASSERT_EQ(dest_st.st_size,src_st.st_size);
+    ASSERT_LT(dest_st.st_blocks * 512,dest_st.st_size);
+    std::ifstream src("sparse_src.img",std::ios::binary),dest("sparse_dest.img",std::ios::binary);
+    std::string src_content((std::istreambuf_iterator<char>(src)),std::istreambuf_iterator<char>());
+    std::string dest_content((std::istreambuf_iterator<char>(dest)),std::istreambuf_iterator<char>());
+    ASSERT_EQ(src_content == dest_content,true);
+    remove("sparse_src.img");
+    remove("sparse_dest.img");
+}
+
+#ifdef IO_UTILS_SOCKET_METRICS
+TEST(TEST_TCP,METRICS) {
+    hzd::TcpListener listener("127.0.0.1",9999);
+    ASSERT_EQ(listener.Bind(),true);
+    ASSERT_EQ(listener.Listen(),true);
+    hzd::TcpSocket tcp;
+    auto before = hzd::GlobalSocketMetrics();
+    bool is_end = false;
+    std::thread t([&] {
+        hzd::TcpClient client;
+        __sleep(1);
+        ASSERT_EQ(client.Connect("127.0.0.1",9999),true);
+        ASSERT_EQ(client.Send("123456"),6);
+        ASSERT_EQ(client.Metrics().bytes_sent,6);
+        ASSERT_EQ(client.Metrics().send_calls,1);
+        while(!is_end) { }
+    });
+
+    ASSERT_EQ(listener.Accept(tcp),true);
+    std::string str;
+    ASSERT_EQ(tcp.Recv(str,6,false),6);
+    ASSERT_EQ(tcp.Metrics().bytes_recv,6);
+    is_end = true;
+    t.join();
+    auto after = hzd::GlobalSocketMetrics();
+    ASSERT_GE(after.counters.bytes_sent - before.counters.bytes_sent,6);
+    ASSERT_GE(after.counters.bytes_recv - before.counters.bytes_recv,6);
+    ASSERT_GE(after.send_latency.total - before.send_latency.total,1);
+}
+
+TEST(TEST_TCP,METRICS_HISTOGRAM) {
+    hzd::LatencyHistogramSnapshot histogram;
+    for(uint64_t v : {1ull,15ull,16ull,100ull,1000ull,123456ull,1ull << 50}) {
+        auto index = hzd::LatencyHistogramSnapshot::BucketIndex(v);
+        ASSERT_LT(index,hzd::LatencyHistogramSnapshot::bucket_count);
+        if(v < (1ull << 41)) {
+            ASSERT_GE(hzd::LatencyHistogramSnapshot::BucketUpperBound(index),v);
+            ASSERT_LE(hzd::LatencyHistogramSnapshot::BucketUpperBound(index),v + v / 8);
+        }
+    }
+    for(uint64_t v = 1; v <= 100; v++) {
+        histogram.counts[hzd::LatencyHistogramSnapshot::BucketIndex(v * 1000)]++;
+        histogram.total++;
+        histogram.sum += v * 1000;
+        histogram.max = v * 1000;
+    }
+    auto p50 = histogram.Percentile(50);
+    ASSERT_GE(p50,50000);
+    ASSERT_LE(p50,50000 + 50000 / 8);
+    ASSERT_EQ(histogram.Percentile(100),100000);
+}
+#endif
+
+TEST(TEST_TCP,TCP_INFO_SAMPLE) {
+    hzd::TcpListener listener("127.0.0.1",9999);
+    ASSERT_EQ(listener.Bind(),true);
+    ASSERT_EQ(listener.Listen(),true);
+    hzd::TcpSocket tcp;
+    bool is_end = false;
+    std::thread t([&] {
+        hzd::TcpClient client;
+        __sleep(1);
+        ASSERT_EQ(client.Connect("127.0.0.1",9999),true);
+        ASSERT_EQ(client.Send("123456"),6);
+        while(!is_end) { }
+    });
+
+    ASSERT_EQ(listener.Accept(tcp),true);
+    std::string str;
+    ASSERT_EQ(tcp.Recv(str,6,false),6);
+    hzd::TcpInfoSample info;
+    ASSERT_EQ(tcp.TcpInfo(info),true);
+    ASSERT_EQ(info.state,TCP_ESTABLISHED);
+    ASSERT_GT(info.snd_mss,0);
+    is_end = true;
+    t.join();
+}
+
+TEST(TEST_UDP,TIMESTAMPING) {
+    hzd::UdpSocket listener;
+    ASSERT_EQ(listener.Bind("127.0.0.1",9999),true);
+    ASSERT_EQ(listener.EnableTimestamping(false,true),true);
+    hzd::UdpSocket client;
+    ASSERT_EQ(client.EnableTimestamping(true,false),true);
+    ASSERT_EQ(client.SendTo("127.0.0.1",9999,"123456",6),6);
+
+    std::string str;
+    hzd::MessageTimestamps rx;
+    ASSERT_EQ(listener.RecvMessage(str,64,rx),6);
+    ASSERT_EQ(str,"123456");
+    ASSERT_GT(rx.software_ns,0);
+
+    hzd::MessageTimestamps tx;
+    bool is_read = false;
+    for(int i = 0; i < 100 && !is_read; i++) {
+        is_read = client.ReadTxTimestamp(tx);
+        if(!is_read) __sleep(1);
+    }
+    ASSERT_EQ(is_read,true);
+    ASSERT_GT(tx.software_ns,0);
+}
+
+TEST(TEST_UDP,BUSY_POLL) {
+    hzd::UdpSocket listener;
+    ASSERT_EQ(listener.Bind("127.0.0.1",9999),true);
+    hzd::BusyPollOptions options;
+    options.spin_us = 100;
+    options.max_spin_us = 100;
+    ASSERT_EQ(listener.SetBusyPoll(true,options),true);
+    ASSERT_EQ(listener.BusyPollBudget(),100);
+    bool is_end = false;
+    std::thread t([&] {
+        hzd::UdpSocket client;
+        for(int i = 0; i < 3; i++) {
+            __sleep(1);
+            ASSERT_EQ(client.SendTo("127.0.0.1",9999,"123456",6),6);
+        }
+        while(!is_end) { }
+    });
+
+    std::string str;
+    for(int i = 0; i < 3; i++) {
+        ASSERT_EQ(listener.Recv(str,6,false),6);
+        ASSERT_EQ(str,"123456");
+    }
+    // 毫秒级到达间隔超过最大预算,自旋应收缩到最小值 & ms-level arrivals exceed max budget,spin shrinks to min
+    ASSERT_EQ(listener.BusyPollBudget(),options.min_spin_us);
+    is_end = true;
+    t.join();
+}
+
+TEST(TEST_TCP,SEND_RECV_BUFFER) {
+    hzd::TcpListener listener("127.0.0.1",9999);
+    ASSERT_EQ(listener.Bind(),true);
+    ASSERT_EQ(listener.Listen(),true);
+    hzd::TcpSocket tcp;
+    bool is_end = false;
+    std::thread t([&] {
+        hzd::TcpClient client;
+        __sleep(1);
+        ASSERT_EQ(client.Connect("127.0.0.1",9999),true);
+        client.Send("123456");
+        while(!is_end) { }
+    });
+
+    ASSERT_EQ(listener.Accept(tcp),true);
+    hzd::BufferPool pool;
+    hzd::Buffer buffer;
+    ASSERT_EQ(tcp.Recv(buffer,6,pool),6);
+    ASSERT_EQ(buffer.ToString(),"123456");
+    hzd::Buffer shared = buffer;
+    ASSERT_EQ(buffer.RefCount(),2);
+    ASSERT_EQ(shared.Data(),buffer.Data());
+    is_end = true;
+    t.join();
+}
+
+TEST(TEST_BUFFERPOOL,ACQUIRE_RELEASE) {
+    hzd::BufferPoolOptions options;
+    options.size_classes = {1024,4096};
+    options.thread_cache_size = 4;
+    hzd::BufferPool pool(options);
+    {
+        std::vector<hzd::Buffer> buffers;
+        for(int i = 0; i < 10; i++) buffers.push_back(pool.Acquire(1000));
+        buffers.push_back(pool.Acquire(2000));
+        buffers.push_back(pool.Acquire(100000));
+        ASSERT_EQ(buffers[10].Capacity(),4096);
+        ASSERT_EQ(buffers[11].Capacity(),100000);
+        ASSERT_EQ(buffers[0].Append("abc",3),true);
+        ASSERT_EQ(buffers[0].Append(std::string(2000,'x').c_str(),2000),false);
+        auto stats = pool.Stats();
+        ASSERT_EQ(stats.classes[0].in_use,10);
+        ASSERT_EQ(stats.classes[1].in_use,1);
+        ASSERT_EQ(stats.oversize_in_use,1);
+    }
+    auto stats = pool.Stats();
+    ASSERT_EQ(stats.classes[0].in_use,0);
+    ASSERT_EQ(stats.classes[0].high_water,10);
+    ASSERT_EQ(stats.oversize_high_water,1);
+    ASSERT_EQ(stats.classes[0].slabs,1);
+
+    std::thread t([&] {
+        for(int i = 0; i < 100; i++) {
+            auto buffer = pool.Acquire(10);
+            buffer.Append("x",1);
+        }
+    });
+    t.join();
+    ASSERT_EQ(pool.Stats().classes[0].in_use,0);
+}
+
+TEST(TEST_TCP,DUAL_STACK) {
+    hzd::TcpListener listener(hzd::Endpoint::Of("::",9999));
+    ASSERT_EQ(listener.Bind(),true);
+    ASSERT_EQ(listener.Listen(),true);
+    hzd::TcpSocket tcp;
+    bool is_end = false;
+    std::thread t([&] {
+        hzd::TcpClient client;
+        __sleep(1);
+        ASSERT_EQ(client.Connect(hzd::Endpoint::Of("127.0.0.1",9999)),true);
+        client.Send("123456");
+        while(!is_end) { }
+    });
+
+    ASSERT_EQ(listener.Accept(tcp),true);
+    ASSERT_EQ(tcp.DestAddr().IsV6(),true);
+    ASSERT_EQ(tcp.DestAddr().Ip(),"::ffff:127.0.0.1");
+    std::string str;
+    ASSERT_EQ(tcp.Recv(str,6,false),6);
+    ASSERT_EQ(str,"123456");
+    is_end = true;
+    t.join();
+}
+
+TEST(TEST_TCP,UNIX) {
+    const std::string path = "@io.utils.test";
+    hzd::TcpListener listener(hzd::Endpoint::Unix(path));
+    ASSERT_EQ(listener.Bind(),true);
+    ASSERT_EQ(listener.Listen(),true);
+    hzd::TcpSocket tcp;
+    bool is_end = false;
+    std::thread t([&] {
+        hzd::TcpClient client;
+        __sleep(1);
+        ASSERT_EQ(client.Connect(hzd::Endpoint::Unix(path)),true);
+        client.Send("123456");
+        while(!is_end) { }
+    });
+
+    ASSERT_EQ(listener.Accept(tcp),true);
+    std::string str;
+    ASSERT_EQ(tcp.Recv(str,6,false),6);
+    ASSERT_EQ(str,"123456");
+    ASSERT_EQ(listener.Addr().ToString(),"unix:" + path);
+    is_end = true;
+    t.join();
+}
+
+TEST(TEST_UDP,ENDPOINT) {
+    hzd::Endpoint endpoint;
+    ASSERT_EQ(hzd::Endpoint::Parse("::1",9999,endpoint),true);
+    ASSERT_EQ(endpoint.IsV6(),true);
+    ASSERT_EQ(endpoint.ToString(),"[::1]:9999");
+    ASSERT_EQ(hzd::Endpoint::Parse("1.2.3",9999,endpoint),false);
+    ASSERT_EQ(hzd::Endpoint::Of("10.0.0.1",80).ToV4Mapped().Ip(),"::ffff:10.0.0.1");
+
+    hzd::UdpSocket listener;
+    ASSERT_EQ(listener.Bind(hzd::Endpoint::Of("::1",9999)),true);
+    hzd::UdpSocket client;
+    auto peer = hzd::Endpoint::Of("::1",9999);
+    for(int i = 0; i < 3; i++) ASSERT_EQ(client.SendTo(peer,"123456",6),6);
+    std::string str;
+    for(int i = 0; i < 3; i++) {
+        ASSERT_EQ(listener.Recv(str,6,false),6);
+        ASSERT_EQ(str,"123456");
+    }
+    ASSERT_EQ(listener.FromAddr().IsV6(),true);
+    ASSERT_EQ(listener.FromAddr().Ip(),"::1");
+}
+
 TEST(TEST_UDP,BIND) {
     hzd::UdpSocket socket;
     ASSERT_EQ(socket.Bind("127.0.0.1",9999),true);
@@ -197,6 +515,59 @@ TEST(TEST_FILESYSTEM,COPY) {
 
 }
 
+TEST(TEST_FILESYSTEM,COPY_PRESERVE) {
+    ASSERT_EQ(hzd::filesystem::copy("../test/main.cpp","copy_src.cpp"),true);
+    chmod("copy_src.cpp",0640);
+    timespec times[2] = {{1000000,0},{2000000,0}};
+    utimensat(AT_FDCWD,"copy_src.cpp",times,0);
+
+    ASSERT_EQ(hzd::filesystem::copy("copy_src.cpp","copy_dest.cpp",false,true),true);
+    struct stat src_st{},dest_st{};
+    stat("copy_src.cpp",&src_st);
+    stat("copy_dest.cpp",&dest_st);
+    ASSERT_EQ(dest_st.st_mode & 07777,0640);
+    ASSERT_EQ(dest_st.st_mtim.tv_sec,2000000);
+    ASSERT_EQ(dest_st.st_size,src_st.st_size);
+    std::ifstream src("copy_src.cpp",std::ios::binary),dest("copy_dest.cpp",std::ios::binary);
+    std::string src_content((std::istreambuf_iterator<char>(src)),std::istreambuf_iterator<char>());
+    std::string dest_content((std::istreambuf_iterator<char>(dest)),std::istreambuf_iterator<char>());
+    ASSERT_EQ(src_content,dest_content);
+
+    ASSERT_EQ(hzd::filesystem::copy("copy_src.cpp","copy_dest.cpp"),false);
+    ASSERT_EQ(hzd::filesystem::copy("copy_src.cpp","copy_src.cpp",true),false);
+    ASSERT_EQ(hzd::filesystem::remove("copy_src.cpp"),true);
+    ASSERT_EQ(hzd::filesystem::remove("copy_dest.cpp"),true);
+}
+
+TEST(TEST_FILESYSTEM,COPY_SPARSE) {
+    int sparse_fd = open("sparse_copy_src.img",O_CREAT | O_WRONLY | O_TRUNC,0644);
+    ASSERT_GE(sparse_fd,0);
+    ASSERT_EQ(pwrite(sparse_fd,"data",4,1024 * 1024),4);
+    ASSERT_EQ(ftruncate(sparse_fd,8 * 1024 * 1024),0);
+    close(sparse_fd);
+
+    std::vector<hzd::filesystem::Extent> extents;
+    uint64_t file_size = 0;
+    ASSERT_EQ(hzd::filesystem::data_extents("sparse_copy_src.img",extents,file_size),true);
+    ASSERT_EQ(file_size,8 * 1024 * 1024u);
+    ASSERT_EQ(extents.empty(),false);
+    uint64_t data_bytes = 0;
+    for(auto& extent : extents) data_bytes += extent.length;
+    ASSERT_LT(data_bytes,file_size);
+
+    ASSERT_EQ(hzd::filesystem::copy("sparse_copy_src.img","sparse_copy_dest.img"),true);
+    struct stat dest_st{};
+    stat("sparse_copy_dest.img",&dest_st);
+    ASSERT_EQ(dest_st.st_size,8 * 1024 * 1024);
+    ASSERT_LT(dest_st.st_blocks * 512,dest_st.st_size);
+    std::ifstream src("sparse_copy_src.img",std::ios::binary),dest("sparse_copy_dest.img",std::ios::binary);
+    std::string src_content((std::istreambuf_iterator<char>(src)),std::istreambuf_iterator<char>());
+    std::string dest_content((std::istreambuf_iterator<char>(dest)),std::istreambuf_iterator<char>());
+    ASSERT_EQ(src_content == dest_content,true);
+    ASSERT_EQ(hzd::filesystem::remove("sparse_copy_src.img"),true);
+    ASSERT_EQ(hzd::filesystem::remove("sparse_copy_dest.img"),true);
+}
+
 TEST(TEST_FILESYSTEM,MOVE) {
     ASSERT_EQ(hzd::filesystem::move("../test/test_move","./"),true);
     ASSERT_EQ(hzd::filesystem::exists("../test/test_move"),false);
@@ -207,6 +578,60 @@ TEST(TEST_FILESYSTEM,MOVE) {
 
 }
 
+TEST(TEST_FILESYSTEM,MOVE_DIR_AND_OVERWRITE) {
+    ASSERT_EQ(hzd::filesystem::createdir("move_dir_src"),true);
+    ASSERT_EQ(hzd::filesystem::copy("../test/test_move","move_dir_src/a"),true);
+    ASSERT_EQ(hzd::filesystem::copy("../test/test_move","move_dir_src/b"),true);
+    struct stat src_st{};
+    stat("move_dir_src/a",&src_st);
+
+    ASSERT_EQ(hzd::filesystem::move("move_dir_src","move_dir_dest"),true);
+    ASSERT_EQ(hzd::filesystem::exists("move_dir_src"),false);
+    struct stat dest_st{};
+    stat("move_dir_dest/a",&dest_st);
+    ASSERT_EQ(dest_st.st_ino,src_st.st_ino);
+
+    ASSERT_EQ(hzd::filesystem::move("move_dir_dest/a","move_dir_dest/b"),false);
+    ASSERT_EQ(hzd::filesystem::exists("move_dir_dest/a"),true);
+    ASSERT_EQ(hzd::filesystem::move("move_dir_dest/a","move_dir_dest/b",true),true);
+    ASSERT_EQ(hzd::filesystem::exists("move_dir_dest/a"),false);
+    ASSERT_EQ(hzd::filesystem::remove("move_dir_dest/b"),true);
+    ASSERT_EQ(hzd::filesystem::remove("move_dir_dest"),true);
+
+    // 同设备rename不能覆盖非空目录 & same-device rename can't overwrite a non-empty dir
+    ASSERT_EQ(hzd::filesystem::createdir("move_dir_src"),true);
+    ASSERT_EQ(hzd::filesystem::createdir("move_dir_dest"),true);
+    ASSERT_EQ(hzd::filesystem::createdir("move_dir_dest/move_dir_src"),true);
+    ASSERT_EQ(hzd::filesystem::copy("../test/test_move","move_dir_dest/move_dir_src/a"),true);
+    ASSERT_EQ(hzd::filesystem::move("move_dir_src","move_dir_dest",true),false);
+    ASSERT_EQ(hzd::filesystem::exists("move_dir_src"),true);
+    ASSERT_EQ(hzd::filesystem::remove("move_dir_src"),true);
+    ASSERT_EQ(hzd::filesystem::remove_all("move_dir_dest"),true);
+}
+
+TEST(TEST_FILESYSTEM,MOVE_CROSS_DEVICE_OVERWRITE) {
+    struct stat local_st{},shm_st{};
+    // 需要与当前目录不同设备的/dev/shm & needs /dev/shm on a different device from cwd
+    if(stat(".",&local_st) != 0 || stat("/dev/shm",&shm_st) != 0 || local_st.st_dev == shm_st.st_dev) return;
+    ASSERT_EQ(hzd::filesystem::createdir("move_xdev_src"),true);
+    ASSERT_EQ(hzd::filesystem::copy("../test/test_move","move_xdev_src/new"),true);
+    ASSERT_EQ(hzd::filesystem::createdir("/dev/shm/move_xdev_parent"),true);
+    ASSERT_EQ(hzd::filesystem::createdir("/dev/shm/move_xdev_parent/move_xdev_src"),true);
+    ASSERT_EQ(hzd::filesystem::copy("../test/test_move","/dev/shm/move_xdev_parent/move_xdev_src/old"),true);
+
+    ASSERT_EQ(hzd::filesystem::move("move_xdev_src","/dev/shm/move_xdev_parent"),false);
+    ASSERT_EQ(hzd::filesystem::exists("/dev/shm/move_xdev_parent/move_xdev_src/old"),true);
+    // 非空目录目标在复制完成后才被替换,不留临时目录 & non-empty dir target is replaced only after the copy,no temp dir left behind
+    ASSERT_EQ(hzd::filesystem::move("move_xdev_src","/dev/shm/move_xdev_parent",true),true);
+    ASSERT_EQ(hzd::filesystem::exists("move_xdev_src"),false);
+    ASSERT_EQ(hzd::filesystem::exists("/dev/shm/move_xdev_parent/move_xdev_src/new"),true);
+    ASSERT_EQ(hzd::filesystem::exists("/dev/shm/move_xdev_parent/move_xdev_src/old"),false);
+    std::vector<std::string> dirs,files;
+    ASSERT_EQ(hzd::filesystem::listdir("/dev/shm/move_xdev_parent",dirs,files),true);
+    ASSERT_EQ(dirs.size() + files.size(),1u);
+    ASSERT_EQ(hzd::filesystem::remove_all("/dev/shm/move_xdev_parent"),true);
+}
+
 TEST(TEST_FILESYSTEM,LIST_DIR_AND_ABS) {
     std::vector<std::string> files,dirs;
     ASSERT_EQ(hzd::filesystem::listdir("./",dirs,files),true);
@@ -216,6 +641,836 @@ TEST(TEST_FILESYSTEM,LIST_DIR_AND_ABS) {
 }
 
 
+TEST(TEST_FILESYSTEM,WALK) {
+    ASSERT_EQ(hzd::filesystem::createdir("walk_root"),true);
+    ASSERT_EQ(hzd::filesystem::createdir("walk_root/a"),true);
+    ASSERT_EQ(hzd::filesystem::createdir("walk_root/a/b"),true);
+    ASSERT_EQ(hzd::filesystem::createdir("walk_root/skip"),true);
+    for(auto& path : {"walk_root/1","walk_root/a/2","walk_root/a/b/3","walk_root/skip/4"}) {
+        ASSERT_EQ(hzd::filesystem::copy("../test/test_move",path),true);
+    }
+    symlink("a","walk_root/link");
+
+    std::mutex mutex;
+    std::set<std::string> paths;
+    hzd::filesystem::WalkOptions options;
+    options.threads = 4;
+    ASSERT_EQ(hzd::filesystem::walk("walk_root/",[&](const hzd::filesystem::WalkEntry& entry) {
+        std::lock_guard<std::mutex> guard(mutex);
+        paths.insert(entry.path);
+        if(entry.path == "walk_root/link") {
+            EXPECT_EQ(entry.type == hzd::filesystem::EntryType::SYMLINK,true);
+        }
+        if(entry.path == "walk_root/a/b/3") {
+            EXPECT_EQ(entry.depth,3);
+        }
+        return entry.path != "walk_root/skip";
+    },options),true);
+    std::set<std::string> expect{"walk_root/1","walk_root/a","walk_root/a/2","walk_root/a/b","walk_root/a/b/3","walk_root/skip","walk_root/link"};
+    ASSERT_EQ(paths,expect);
+
+    size_t count = 0;
+    options.threads = 1;
+    options.max_depth = 1;
+    ASSERT_EQ(hzd::filesystem::walk("walk_root",[&](const hzd::filesystem::WalkEntry&) { count++; return true; },options),true);
+    ASSERT_EQ(count,4u);
+    ASSERT_EQ(hzd::filesystem::walk("walk_root_not_exist",[](const hzd::filesystem::WalkEntry&) { return true; }),false);
+
+    // 回调中再次列目录,不得破坏外层遍历 & listing a dir inside the callback must not corrupt the outer walk
+    std::set<std::string> nested_paths;
+    options.max_depth = -1;
+    ASSERT_EQ(hzd::filesystem::walk("walk_root",[&](const hzd::filesystem::WalkEntry& entry) {
+        nested_paths.insert(entry.path);
+        hzd::filesystem::DirListing listing;
+        if(entry.type == hzd::filesystem::EntryType::DIRECTORY) {
+            EXPECT_EQ(hzd::filesystem::listdir(entry.path,listing),true);
+        }
+        return entry.path != "walk_root/skip";
+    },options),true);
+    ASSERT_EQ(nested_paths,expect);
+
+    // 指向祖先的符号链接不会无限展开 & symlink to an ancestor doesn't expand forever
+    symlink("..","walk_root/a/loop");
+    options.threads = 4;
+    options.is_follow_symlink = true;
+    std::atomic<size_t> followed{0};
+    ASSERT_EQ(hzd::filesystem::walk("walk_root",[&](const hzd::filesystem::WalkEntry&) { followed++; return true; },options),true);
+    ASSERT_LT(followed.load(),20u);
+    unlink("walk_root/a/loop");
+
+    unlink("walk_root/link");
+    for(auto& path : {"walk_root/1","walk_root/a/2","walk_root/a/b/3","walk_root/skip/4","walk_root/a/b","walk_root/a","walk_root/skip","walk_root"}) {
+        ASSERT_EQ(hzd::filesystem::remove(path),true);
+    }
+}
+
+TEST(TEST_FILESYSTEM,COPY_TREE_AND_REMOVE_ALL) {
+    ASSERT_EQ(hzd::filesystem::createdir("tree_src"),true);
+    std::string dir = "tree_src";
+    for(int i = 0; i < 4; i++) {
+        dir += "/d" + std::to_string(i);
+        ASSERT_EQ(hzd::filesystem::createdir(dir),true);
+        for(int j = 0; j < 8; j++) ASSERT_EQ(hzd::filesystem::copy("../test/test_move",dir + "/f" + std::to_string(j)),true);
+    }
+    symlink("d0","tree_src/link");
+    chmod("tree_src/d0/d1",0750);
+
+    hzd::filesystem::TreeOptions options;
+    options.threads = 4;
+    std::vector<hzd::filesystem::TreeError> errors;
+    ASSERT_EQ(hzd::filesystem::copy_tree("tree_src","tree_dest",options,&errors),true);
+    ASSERT_EQ(errors.empty(),true);
+    std::set<std::string> src_paths,dest_paths;
+    std::mutex mutex;
+    hzd::filesystem::walk("tree_src",[&](const hzd::filesystem::WalkEntry& entry) {
+        std::lock_guard<std::mutex> guard(mutex);
+        src_paths.insert(entry.path.substr(8));
+        return true;
+    });
+    hzd::filesystem::walk("tree_dest",[&](const hzd::filesystem::WalkEntry& entry) {
+        std::lock_guard<std::mutex> guard(mutex);
+        dest_paths.insert(entry.path.substr(9));
+        return true;
+    });
+    ASSERT_EQ(src_paths.size(),1u + 4 + 4 * 8);
+    ASSERT_EQ(src_paths,dest_paths);
+    struct stat st{};
+    lstat("tree_dest/link",&st);
+    ASSERT_EQ(S_ISLNK(st.st_mode),true);
+    stat("tree_dest/d0/d1",&st);
+    ASSERT_EQ(st.st_mode & 07777,0750);
+    ASSERT_EQ(hzd::filesystem::fsize("tree_dest/d0/d1/d2/d3/f7"),hzd::filesystem::fsize("../test/test_move"));
+
+    ASSERT_EQ(hzd::filesystem::copy_tree("tree_src","tree_dest",options,&errors),false);
+    ASSERT_EQ(errors.size(),1u + 4 * 8);
+    ASSERT_EQ(errors.front().code,EEXIST);
+    options.is_overwrite = true;
+    ASSERT_EQ(hzd::filesystem::copy_tree("tree_src","tree_dest",options),true);
+
+    errors.clear();
+    ASSERT_EQ(hzd::filesystem::remove_all("tree_src",options,&errors),true);
+    ASSERT_EQ(hzd::filesystem::remove_all("tree_dest",options,&errors),true);
+    ASSERT_EQ(errors.empty(),true);
+    ASSERT_EQ(hzd::filesystem::exists("tree_src"),false);
+    ASSERT_EQ(hzd::filesystem::exists("tree_dest"),false);
+    ASSERT_EQ(hzd::filesystem::remove_all("tree_src"),false);
+}
+
+TEST(TEST_FILESYSTEM,DISK_USAGE) {
+    mkdir("usage_root",0755);
+    std::string dir = "usage_root";
+    for(int i = 0; i < 3; i++) {
+        dir += "/d" + std::to_string(i);
+        mkdir(dir.c_str(),0755);
+        for(int j = 0; j < 10; j++) std::ofstream(dir + "/f" + std::to_string(j),std::ios::binary) << std::string(1000,'x');
+    }
+    link("usage_root/d0/f0","usage_root/hard");
+    symlink("d0","usage_root/link");
+
+    hzd::filesystem::DiskUsage usage;
+    hzd::filesystem::DiskUsageOptions options;
+    options.threads = 4;
+    std::vector<hzd::filesystem::TreeError> errors;
+    ASSERT_EQ(hzd::filesystem::disk_usage("usage_root",usage,options,&errors),true);
+    ASSERT_EQ(errors.empty(),true);
+    ASSERT_EQ(usage.files,30u);
+    ASSERT_EQ(usage.dirs,4u);
+    ASSERT_EQ(usage.symlinks,1u);
+    ASSERT_EQ(usage.hardlinks,1u);
+    ASSERT_EQ(usage.is_limit_reached,false);
+    ASSERT_GE(usage.apparent_size,30u * 1000);
+    ASSERT_GT(usage.allocated_size,0u);
+
+    ASSERT_EQ(hzd::filesystem::disk_usage("usage_root/d0/f1",usage),true);
+    ASSERT_EQ(usage.files,1u);
+    ASSERT_EQ(usage.apparent_size,1000u);
+
+    options.limit = 1;
+    ASSERT_EQ(hzd::filesystem::disk_usage("usage_root",usage,options),true);
+    ASSERT_EQ(usage.is_limit_reached,true);
+    ASSERT_LT(usage.files,30u);
+    ASSERT_EQ(hzd::filesystem::disk_usage("usage_missing",usage),false);
+    ASSERT_EQ(hzd::filesystem::remove_all("usage_root"),true);
+}
+
+TEST(TEST_FILESYSTEM,GLOB) {
+    ASSERT_EQ(hzd::filesystem::match_name("seg-*.log","seg-001.log"),true);
+    ASSERT_EQ(hzd::filesystem::match_name("seg-?.log","seg-12.log"),false);
+    ASSERT_EQ(hzd::filesystem::match_name("[a-c]*[!0-9]","b12x"),true);
+    ASSERT_EQ(hzd::filesystem::match_name("[a-c]*[!0-9]","b123"),false);
+    ASSERT_EQ(hzd::filesystem::match_name("\\*","*"),true);
+    ASSERT_EQ(hzd::filesystem::match_name("\\*","a"),false);
+    ASSERT_EQ(hzd::filesystem::match_name("*a*b*c","xxaxxbxxbxc"),true);
+
+    mkdir("glob_root",0755);
+    mkdir("glob_root/app",0755);
+    mkdir("glob_root/app/2024",0755);
+    mkdir("glob_root/db",0755);
+    std::ofstream("glob_root/app/seg-1.log") << "1";
+    std::ofstream("glob_root/app/2024/seg-2.log") << std::string(100,'x');
+    std::ofstream("glob_root/app/2024/seg-2.idx") << "2";
+    std::ofstream("glob_root/db/seg-3.log") << "3";
+    std::ofstream("glob_root/top.log") << "4";
+
+    std::vector<std::string> results;
+    hzd::filesystem::GlobOptions options;
+    options.threads = 4;
+    ASSERT_EQ(hzd::filesystem::glob("glob_root","**/*.log",results,options),true);
+    ASSERT_EQ(results,(std::vector<std::string>{"glob_root/app/2024/seg-2.log","glob_root/app/seg-1.log","glob_root/db/seg-3.log","glob_root/top.log"}));
+    ASSERT_EQ(hzd::filesystem::glob("glob_root/","app/*/seg-?.*",results,options),true);
+    ASSERT_EQ(results,(std::vector<std::string>{"glob_root/app/2024/seg-2.idx","glob_root/app/2024/seg-2.log"}));
+    ASSERT_EQ(hzd::filesystem::glob("glob_root","[ab]*",results,options),true);
+    ASSERT_EQ(results,(std::vector<std::string>{"glob_root/app"}));
+    options.is_files_only = true;
+    ASSERT_EQ(hzd::filesystem::glob("glob_root","app/**",results,options),true);
+    ASSERT_EQ(results.size(),3u);
+    options.min_size = 10;
+    ASSERT_EQ(hzd::filesystem::glob("glob_root","**/seg-*",results,options),true);
+    ASSERT_EQ(results,(std::vector<std::string>{"glob_root/app/2024/seg-2.log"}));
+    ASSERT_EQ(hzd::filesystem::glob("glob_root","app/2024/seg-2.log",results),true);
+    ASSERT_EQ(results.size(),1u);
+    ASSERT_EQ(hzd::filesystem::glob("glob_root","missing/*",results),true);
+    ASSERT_EQ(results.empty(),true);
+    ASSERT_EQ(hzd::filesystem::glob("glob_root","",results),false);
+    ASSERT_EQ(hzd::filesystem::remove_all("glob_root"),true);
+}
+
+TEST(TEST_FILESYSTEM,SPACE_MANAGEMENT) {
+    remove("space.bin");
+    const uint64_t size = 4 * 1024 * 1024;
+    ASSERT_EQ(hzd::filesystem::preallocate("space.bin",0,size),true);
+    ASSERT_EQ(hzd::filesystem::fsize("space.bin"),static_cast<long long>(size));
+    struct stat st{};
+    stat("space.bin",&st);
+    ASSERT_GE(static_cast<uint64_t>(st.st_blocks) * 512,size);
+
+    ASSERT_EQ(hzd::filesystem::truncate("space.bin",size / 2),true);
+    ASSERT_EQ(hzd::filesystem::fsize("space.bin"),static_cast<long long>(size / 2));
+    ASSERT_EQ(hzd::filesystem::preallocate("space.bin",size / 2,size / 2,true),true);
+    ASSERT_EQ(hzd::filesystem::fsize("space.bin"),static_cast<long long>(size / 2));
+
+    std::string data(size / 2,'x');
+    ASSERT_EQ(hzd::filesystem::atomic_write("space.bin",data,false),true);
+    // 部分文件系统(如overlayfs)不支持打洞 & some filesystems (e.g. overlayfs) don't support punching holes
+    if(hzd::filesystem::punch_hole("space.bin",0,size / 4)) {
+        std::ifstream in("space.bin",std::ios::binary);
+        std::string content((std::istreambuf_iterator<char>(in)),std::istreambuf_iterator<char>());
+        ASSERT_EQ(content.size(),size / 2);
+        ASSERT_EQ(content[0],'\0');
+        ASSERT_EQ(content[size / 4],'x');
+    }
+    ASSERT_EQ(hzd::filesystem::truncate("space_missing.bin",0),false);
+
+    hzd::filesystem::SpaceInfo info{};
+    ASSERT_EQ(hzd::filesystem::space(".",info),true);
+    ASSERT_GT(info.capacity,0u);
+    ASSERT_LE(info.available,info.capacity);
+    ASSERT_LE(info.free,info.capacity);
+    ASSERT_EQ(hzd::filesystem::space("space_missing_dir/x",info),false);
+    remove("space.bin");
+}
+
+TEST(TEST_FILESYSTEM,LIST_DIR_ENTRIES) {
+    ASSERT_EQ(hzd::filesystem::createdir("list_root"),true);
+    ASSERT_EQ(hzd::filesystem::createdir("list_root/sub"),true);
+    ASSERT_EQ(hzd::filesystem::copy("../test/test_move","list_root/file"),true);
+
+    hzd::filesystem::DirListing listing;
+    ASSERT_EQ(hzd::filesystem::listdir("list_root",listing),true);
+    ASSERT_EQ(listing.Size(),2u);
+    ASSERT_EQ(hzd::filesystem::listdir("list_root",listing,hzd::filesystem::DIR_STAT_SIZE | hzd::filesystem::DIR_STAT_INODE),true);
+    ASSERT_EQ(listing.Size(),2u);
+    struct stat st{};
+    stat("list_root/file",&st);
+    for(auto& entry : listing) {
+        std::string name = listing.Name(entry);
+        ASSERT_EQ(name.size(),entry.name_length);
+        if(name == "file") {
+            ASSERT_EQ(entry.type == hzd::filesystem::EntryType::FILE,true);
+            ASSERT_EQ(entry.size,static_cast<uint64_t>(st.st_size));
+            ASSERT_EQ(entry.inode,static_cast<uint64_t>(st.st_ino));
+        }else {
+            ASSERT_EQ(name,"sub");
+            ASSERT_EQ(entry.type == hzd::filesystem::EntryType::DIRECTORY,true);
+        }
+    }
+    ASSERT_EQ(hzd::filesystem::listdir("list_root_not_exist",listing),false);
+    ASSERT_EQ(hzd::filesystem::remove_all("list_root"),true);
+}
+
+TEST(TEST_FILESYSTEM,STAT_BATCH) {
+    std::vector<std::string> paths;
+    for(int i = 0; i < 300; i++) paths.emplace_back(i % 3 == 2 ? "stat_batch_not_exist" : i % 3 ? "../test/test_move" : "../test");
+    std::vector<hzd::filesystem::StatResult> results;
+    ASSERT_EQ(hzd::filesystem::stat_batch(paths,results,hzd::filesystem::DIR_STAT_SIZE,4),false);
+    ASSERT_EQ(results.size(),paths.size());
+    for(size_t i = 0; i < paths.size(); i++) {
+        if(i % 3 == 2) {
+            ASSERT_EQ(results[i].error,ENOENT);
+        }else if(i % 3) {
+            ASSERT_EQ(results[i].error,0);
+            ASSERT_EQ(results[i].type == hzd::filesystem::EntryType::FILE,true);
+            ASSERT_EQ(static_cast<long long>(results[i].size),hzd::filesystem::fsize("../test/test_move"));
+        }else {
+            ASSERT_EQ(results[i].type == hzd::filesystem::EntryType::DIRECTORY,true);
+        }
+    }
+    paths.resize(2);
+    ASSERT_EQ(hzd::filesystem::stat_batch(paths,results),true);
+    ASSERT_EQ(results.size(),2u);
+}
+
+TEST(TEST_FILESYSTEM,ATOMIC_WRITE) {
+    ASSERT_EQ(hzd::filesystem::atomic_write("atomic.txt","old"),true);
+    ASSERT_EQ(hzd::filesystem::atomic_write("atomic.txt",std::string("new content")),true);
+    std::ifstream in("atomic.txt");
+    std::string content((std::istreambuf_iterator<char>(in)),std::istreambuf_iterator<char>());
+    ASSERT_EQ(content,"new content");
+    // 替换不会放宽原文件的权限 & replacing doesn't widen the original mode
+    ASSERT_EQ(chmod("atomic.txt",0600),0);
+    ASSERT_EQ(hzd::filesystem::atomic_write("atomic.txt","secret"),true);
+    struct stat st{};
+    ASSERT_EQ(stat("atomic.txt",&st),0);
+    ASSERT_EQ(st.st_mode & 07777,0600u);
+    ASSERT_EQ(hzd::filesystem::parent_dir("a/b/c.txt"),"a/b");
+    ASSERT_EQ(hzd::filesystem::parent_dir("c.txt"),".");
+    ASSERT_EQ(hzd::filesystem::atomic_write("atomic_not_exist/a.txt","x"),false);
+    remove("atomic.txt");
+}
+
+TEST(TEST_MAPPEDFILE,READ_WRITE_RESIZE) {
+    hzd::MappedFile file;
+    hzd::MapOptions options;
+    options.is_create = true;
+    options.size = 4096;
+    ASSERT_EQ(file.Open("mapped.bin",hzd::MapMode::READ_WRITE,options),true);
+    ASSERT_EQ(file.Size(),4096u);
+    memcpy(file.MutableData(),"head",4);
+    ASSERT_EQ(file.Resize(3 * 4096),true);
+    memcpy(file.MutableData() + 2 * 4096,"tail",4);
+    ASSERT_EQ(file.Sync(),true);
+    file.Close();
+
+    hzd::MappedFile reader;
+    options = hzd::MapOptions();
+    options.is_populate = true;
+    ASSERT_EQ(reader.Open("mapped.bin",hzd::MapMode::READ_ONLY,options),true);
+    ASSERT_EQ(reader.MutableData(),nullptr);
+    ASSERT_EQ(reader.Size(),3 * 4096u);
+    ASSERT_EQ(reader.Advise(hzd::MapAdvice::SEQUENTIAL),true);
+    ASSERT_EQ(reader.Advise(hzd::MapAdvice::WILLNEED,100,10),true);
+    ASSERT_EQ(reader.Prefault(4096),true);
+    ASSERT_EQ(reader.View(0,4).ToString(),"head");
+    ASSERT_EQ(reader.View(2 * 4096).Slice(0,4).ToString(),"tail");
+    ASSERT_EQ(reader.View(4 * 4096).size,0u);
+    ASSERT_EQ(reader.Resize(10),false);
+
+    hzd::MappedFile moved(std::move(reader));
+    ASSERT_EQ(reader.IsOpen(),false);
+    ASSERT_EQ(moved.View(0,4).ToString(),"head");
+    ASSERT_EQ(hzd::MappedFile().Open("mapped_not_exist.bin"),false);
+    remove("mapped.bin");
+}
+
+TEST(TEST_TCP,SEND_MAPPED_FILE) {
+    hzd::MappedFile file;
+    ASSERT_EQ(file.Open("../test/main.cpp"),true);
+    hzd::TcpListener listener("127.0.0.1",9999);
+    ASSERT_EQ(listener.Bind(),true);
+    ASSERT_EQ(listener.Listen(),true);
+    hzd::TcpSocket tcp;
+    std::thread t([&] {
+        hzd::TcpClient client;
+        ASSERT_EQ(client.Connect("127.0.0.1",9999),true);
+        ASSERT_EQ(client.SendFile(file,10,1000),true);
+    });
+    ASSERT_EQ(listener.Accept(tcp),true);
+    std::string str;
+    while(tcp.Recv(str,1000,false) == 0) {}
+    t.join();
+    ASSERT_EQ(str,file.View(10,1000).ToString());
+
+    hzd::UdpSocket udp_listener,udp_client;
+    ASSERT_EQ(udp_listener.Bind("127.0.0.1",9999),true);
+    ASSERT_EQ(udp_client.SendTo(hzd::Endpoint::Of("127.0.0.1",9999),file.View(0,16)),16);
+    std::string datagram;
+    ASSERT_EQ(udp_listener.Recv(datagram,16,false),16);
+    ASSERT_EQ(datagram,file.View(0,16).ToString());
+}
+
+TEST(TEST_FILEWRITER,WRITE_FLUSH_DIRECT) {
+    std::string expect;
+    for(int i = 0; i < 3000; i++) expect += "line " + std::to_string(i) + "\n";
+    for(bool is_direct : {false,true}) {
+        hzd::FileWriter writer;
+        hzd::FileWriterOptions options;
+        options.buffer_size = 8192;
+        options.is_direct = is_direct;
+        options.preallocate = 1 << 20;
+        ASSERT_EQ(writer.Open("writer.bin",options),true);
+        ASSERT_EQ(writer.Write(expect.data(),100),true);
+        // 中途刷新后继续写入,O_DIRECT下未对齐的尾块会被重写 & keep writing after a flush,unaligned O_DIRECT tail gets rewritten
+        ASSERT_EQ(writer.Flush(),true);
+        ASSERT_EQ(writer.Write(expect.substr(100)),true);
+        ASSERT_EQ(writer.Size(),expect.size());
+        ASSERT_EQ(writer.Close(),true);
+        std::ifstream in("writer.bin",std::ios::binary);
+        std::string content((std::istreambuf_iterator<char>(in)),std::istreambuf_iterator<char>());
+        ASSERT_EQ(content,expect);
+    }
+    hzd::FileWriterOptions options;
+    options.is_append = true;
+    hzd::FileWriter writer;
+    ASSERT_EQ(writer.Open("writer.bin",options),true);
+    ASSERT_EQ(writer.Write("tail"),true);
+    ASSERT_EQ(writer.Close(),true);
+    struct stat st{};
+    ASSERT_EQ(stat("writer.bin",&st),0);
+    ASSERT_EQ(static_cast<size_t>(st.st_size),expect.size() + 4);
+    ASSERT_EQ(writer.Write("closed"),false);
+    remove("writer.bin");
+}
+
+TEST(TEST_ASYNCFILE,READ_WRITE_STAT) {
+    for(auto backend : {hzd::AsyncBackend::THREAD_POOL,hzd::AsyncBackend::AUTO}) {
+        hzd::AsyncFileOptions options;
+        options.backend = backend;
+        options.queue_depth = 8;
+        hzd::AsyncFileService service(options);
+        auto opened = service.Open("async.bin",O_RDWR | O_CREAT | O_TRUNC).get();
+        ASSERT_GE(opened.result,0);
+        int fd = static_cast<int>(opened.result);
+        std::atomic<int> written{0};
+        for(int i = 0; i < 4; i++) {
+            service.Write(fd,i * 4,"abcd",[&written](hzd::AsyncResult& result) { written += static_cast<int>(result.result); });
+        }
+        service.Wait();
+        ASSERT_EQ(written.load(),16);
+        ASSERT_EQ(service.Fsync(fd,true).get().result,0);
+        auto read = service.Read(fd,2,100).get();
+        ASSERT_EQ(read.result,14);
+        ASSERT_EQ(read.data,"cdabcdabcdabcd");
+        auto stat = service.Stat("async.bin").get();
+        ASSERT_EQ(stat.result,0);
+        ASSERT_EQ(stat.stat.size,16u);
+        ASSERT_EQ(stat.stat.type,hzd::filesystem::EntryType::FILE);
+        ASSERT_EQ(service.Stat("async_not_exist.bin").get().stat.error,ENOENT);
+        ASSERT_EQ(service.Close(fd).get().result,0);
+        ASSERT_EQ(service.Read(fd,0,10).get().result,-EBADF);
+    }
+    remove("async.bin");
+}
+
+TEST(TEST_FILEWATCHER,RECURSIVE_COALESCE) {
+    hzd::filesystem::remove_all("watch_dir");
+    ASSERT_EQ(mkdir("watch_dir",0755),0);
+    std::map<std::string,uint32_t> seen;
+    hzd::FileWatcher watcher;
+    ASSERT_EQ(watcher.Open([&seen](const hzd::WatchEvent& event) { seen[event.path] |= event.mask; }),true);
+    ASSERT_EQ(watcher.Add("watch_dir/"),true);
+    ASSERT_GE(watcher.Fd(),0);
+    {
+        std::ofstream out("watch_dir/a.txt");
+        for(int i = 0; i < 100; i++) out << i << std::endl;
+    }
+    ASSERT_EQ(mkdir("watch_dir/sub",0755),0);
+    std::ofstream("watch_dir/sub/b.txt") << "b";
+    for(int i = 0; i < 50 && !(seen["watch_dir/sub/b.txt"] & hzd::WATCH_CREATE); i++) watcher.Poll(20);
+    ASSERT_EQ(seen["watch_dir/a.txt"] & (hzd::WATCH_CREATE | hzd::WATCH_CLOSE_WRITE),hzd::WATCH_CREATE | hzd::WATCH_CLOSE_WRITE);
+    ASSERT_NE(seen["watch_dir/sub"] & hzd::WATCH_CREATE,0u);
+    ASSERT_NE(seen["watch_dir/sub/b.txt"] & hzd::WATCH_CREATE,0u);
+    ASSERT_EQ(watcher.WatchCount(),2u);
+    ASSERT_EQ(watcher.Remove("watch_dir"),true);
+    ASSERT_EQ(watcher.WatchCount(),0u);
+    ASSERT_EQ(watcher.Remove("watch_dir"),false);
+    hzd::filesystem::remove_all("watch_dir");
+}
+
+TEST(TEST_METADATACACHE,TTL_NEGATIVE_AND_WATCH) {
+    hzd::filesystem::remove_all("meta_dir");
+    ASSERT_EQ(mkdir("meta_dir",0755),0);
+    hzd::MetadataCacheOptions options;
+    options.capacity = 4;
+    options.shards = 1;
+    options.ttl_ms = 60000;
+    options.negative_ttl_ms = 60000;
+    hzd::MetadataCache cache(options);
+    ASSERT_EQ(cache.Exists("meta_dir/a.txt"),false);
+    std::ofstream("meta_dir/a.txt") << "hello";
+    // 负缓存命中,仍视为不存在 & negative entry hit,still reported missing
+    ASSERT_EQ(cache.Exists("meta_dir/a.txt"),false);
+    ASSERT_EQ(cache.Hits(),1u);
+    cache.Invalidate("meta_dir/a.txt");
+    ASSERT_EQ(cache.IsFile("meta_dir/a.txt"),true);
+    ASSERT_EQ(cache.Size("meta_dir/a.txt"),5);
+    ASSERT_EQ(cache.IsDirectory("meta_dir"),true);
+    for(int i = 0; i < 10; i++) cache.Exists("meta_dir/missing" + std::to_string(i));
+    ASSERT_EQ(cache.Count(),4u);
+
+    ASSERT_EQ(cache.Watch("meta_dir"),true);
+    ASSERT_EQ(cache.Exists("meta_dir/b.txt"),false);
+    std::ofstream("meta_dir/b.txt") << "b";
+    bool is_seen = false;
+    for(int i = 0; i < 100 && !is_seen; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        is_seen = cache.Exists("meta_dir/b.txt");
+    }
+    ASSERT_EQ(is_seen,true);
+    hzd::filesystem::remove_all("meta_dir");
+}
+
+TEST(TEST_GROUPCOMMIT,BATCHED_WRITES) {
+    hzd::filesystem::remove_all("commit_dir");
+    ASSERT_EQ(mkdir("commit_dir",0755),0);
+    std::vector<std::future<bool>> futures;
+    {
+        hzd::GroupCommitOptions options;
+        options.max_delay_us = 20000;
+        hzd::GroupCommitWriter writer(options);
+        for(int i = 0; i < 100; i++) {
+            futures.push_back(writer.Write("commit_dir/" + std::to_string(i) + ".ckpt",std::to_string(i)));
+        }
+        futures.push_back(writer.Write("commit_not_exist/a.ckpt","x"));
+        writer.Flush();
+        ASSERT_EQ(chmod("commit_dir/0.ckpt",0640),0);
+        ASSERT_EQ(writer.Write("commit_dir/0.ckpt","0").get(),true);
+        ASSERT_LT(writer.Batches(),10u);
+    }
+    for(int i = 0; i < 100; i++) {
+        ASSERT_EQ(futures[i].get(),true);
+        std::ifstream in("commit_dir/" + std::to_string(i) + ".ckpt");
+        std::string content;
+        in >> content;
+        ASSERT_EQ(content,std::to_string(i));
+    }
+    ASSERT_EQ(futures.back().get(),false);
+    struct stat st{};
+    ASSERT_EQ(stat("commit_dir/0.ckpt",&st),0);
+    ASSERT_EQ(st.st_mode & 07777,0640u);
+    {
+        hzd::GroupCommitOptions options;
+        options.is_syncfs = true;
+        hzd::GroupCommitWriter writer(options);
+        auto first = writer.Write("commit_dir/syncfs_a.ckpt","a");
+        auto second = writer.Write("commit_dir/syncfs_b.ckpt","b");
+        ASSERT_EQ(first.get(),true);
+        ASSERT_EQ(second.get(),true);
+    }
+    hzd::filesystem::DirListing listing;
+    ASSERT_EQ(hzd::filesystem::listdir("commit_dir",listing),true);
+    ASSERT_EQ(listing.Size(),102u);
+    hzd::filesystem::remove_all("commit_dir");
+}
+
+TEST(TEST_CHECKSUM,CRC32C_XXH64_CHUNKED) {
+    ASSERT_EQ(hzd::Crc32c::Compute("123456789",9),0xE3069283u);
+    ASSERT_EQ(hzd::Xxh64::Compute("",0),0xEF46DB3751D8E999ull);
+    ASSERT_EQ(hzd::Xxh64::Compute("abc",3),0x44BC2CF5AD770999ull);
+    std::string data;
+    for(int i = 0; i < 100000; i++) data += std::to_string(i * 7919);
+    uint32_t crc1 = hzd::Crc32c::Compute(data.data(),1000);
+    uint32_t crc2 = hzd::Crc32c::Compute(data.data() + 1000,data.size() - 1000);
+    uint32_t whole = hzd::Crc32c::Compute(data.data(),data.size());
+    ASSERT_EQ(hzd::Crc32c::Combine(crc1,crc2,data.size() - 1000),whole);
+    hzd::Xxh64 state;
+    for(size_t i = 0; i < data.size(); i += 13) state.Update(data.data() + i,std::min<size_t>(13,data.size() - i));
+    ASSERT_EQ(state.Digest(),hzd::Xxh64::Compute(data.data(),data.size()));
+
+    hzd::HashOptions options;
+    options.chunk_size = 4096;
+    options.threads = 4;
+    ASSERT_EQ(hzd::hash_buffer(data.data(),data.size(),hzd::HashType::CRC32C,options),whole);
+    uint64_t parallel = hzd::hash_buffer(data.data(),data.size(),hzd::HashType::XXH64,options);
+    options.threads = 1;
+    ASSERT_EQ(hzd::hash_buffer(data.data(),data.size(),hzd::HashType::XXH64,options),parallel);
+    std::ofstream("checksum.bin",std::ios::binary) << data;
+    uint64_t result = 0;
+    ASSERT_EQ(hzd::hash_file("checksum.bin",hzd::HashType::CRC32C,result,options),true);
+    ASSERT_EQ(result,whole);
+    ASSERT_EQ(hzd::hash_file("checksum_not_exist.bin",hzd::HashType::CRC32C,result),false);
+
+    hzd::TcpListener listener("127.0.0.1",9999);
+    ASSERT_EQ(listener.Bind(),true);
+    ASSERT_EQ(listener.Listen(),true);
+    uint32_t send_crc = 0;
+    std::thread t([&send_crc] {
+        hzd::TcpClient client;
+        ASSERT_EQ(client.Connect("127.0.0.1",9999),true);
+        ASSERT_EQ(client.SendFile("checksum.bin",send_crc),true);
+    });
+    hzd::TcpSocket tcp;
+    ASSERT_EQ(listener.Accept(tcp),true);
+    uint32_t recv_crc = 0;
+    ASSERT_EQ(tcp.RecvFile("checksum_recv.bin",data.size(),recv_crc),true);
+    t.join();
+    ASSERT_EQ(send_crc,whole);
+    ASSERT_EQ(recv_crc,whole);
+    ASSERT_EQ(hzd::hash_file("checksum_recv.bin",hzd::HashType::CRC32C,result),true);
+    ASSERT_EQ(result,whole);
+    remove("checksum.bin");
+    remove("checksum_recv.bin");
+}
+
+TEST(TEST_DELTASYNC,LOCAL_AND_TCP) {
+    std::string basis;
+    for(int i = 0; i < 20000; i++) basis += "record " + std::to_string(i) + "\n";
+    std::string changed = basis;
+    changed.insert(1000,"inserted");
+    changed.replace(100000,5,"XXXXX");
+    changed += "appended tail";
+    std::ofstream("delta_old.txt",std::ios::binary) << basis;
+    std::ofstream("delta_new.txt",std::ios::binary) << changed;
+    auto read_all = [](const std::string& path) {
+        std::ifstream in(path,std::ios::binary);
+        return std::string((std::istreambuf_iterator<char>(in)),std::istreambuf_iterator<char>());
+    };
+
+    hzd::delta::Signature signature,decoded_signature,truncated_signature;
+    ASSERT_EQ(hzd::delta::signature("delta_old.txt",signature),true);
+    std::string blob;
+    hzd::delta::encode(signature,blob);
+    ASSERT_EQ(hzd::delta::decode(blob,decoded_signature),true);
+    ASSERT_EQ(decoded_signature.blocks.size(),signature.blocks.size());
+    ASSERT_EQ(hzd::delta::decode(blob.substr(0,blob.size() - 1),truncated_signature),false);
+    hzd::delta::Delta file_delta,decoded_delta;
+    ASSERT_EQ(hzd::delta::generate("delta_new.txt",decoded_signature,file_delta),true);
+    ASSERT_LT(file_delta.LiteralBytes(),changed.size() / 10);
+    hzd::delta::encode(file_delta,blob);
+    ASSERT_EQ(hzd::delta::decode(blob,decoded_delta),true);
+    ASSERT_EQ(hzd::delta::apply("delta_old.txt",decoded_delta,"delta_out.txt"),true);
+    ASSERT_EQ(read_all("delta_out.txt"),changed);
+    // 流式生成,DATA按上限拆分 & streaming generate,DATA split by the limit
+    hzd::delta::DeltaHeader header;
+    size_t max_data = 0;
+    ASSERT_EQ(hzd::delta::generate("delta_new.txt",decoded_signature,header,[&max_data](const hzd::delta::DeltaOp& op) {
+        max_data = std::max(max_data,op.data.size());
+        return true;
+    },4),true);
+    ASSERT_EQ(max_data,4u);
+    ASSERT_EQ(header.file_size,changed.size());
+
+    uint64_t literal_bytes = 0;
+    ASSERT_EQ(hzd::delta::sync("delta_new.txt","delta_old.txt",&literal_bytes),true);
+    ASSERT_EQ(read_all("delta_old.txt"),changed);
+    ASSERT_EQ(hzd::delta::sync("delta_new.txt","delta_old.txt",&literal_bytes),true);
+    ASSERT_EQ(literal_bytes,0u);
+
+    std::ofstream("delta_old.txt",std::ios::binary) << basis;
+    hzd::TcpListener listener("127.0.0.1",9999);
+    ASSERT_EQ(listener.Bind(),true);
+    ASSERT_EQ(listener.Listen(),true);
+    std::thread t([] {
+        hzd::TcpClient client;
+        ASSERT_EQ(client.Connect("127.0.0.1",9999),true);
+        ASSERT_EQ(hzd::delta::send(client,"delta_new.txt"),true);
+    });
+    hzd::TcpSocket tcp;
+    ASSERT_EQ(listener.Accept(tcp),true);
+    ASSERT_EQ(hzd::delta::recv(tcp,"delta_old.txt"),true);
+    t.join();
+    ASSERT_EQ(read_all("delta_old.txt"),changed);
+
+    // 本地文件不存在时全部为新数据,需分多帧传输 & missing local file makes everything literal,sent in several frames
+    remove("delta_old.txt");
+    std::string large;
+    while(large.size() < 9 * 1024 * 1024) large += changed;
+    std::ofstream("delta_new.txt",std::ios::binary) << large;
+    std::thread large_thread([] {
+        hzd::TcpClient client;
+        ASSERT_EQ(client.Connect("127.0.0.1",9999),true);
+        ASSERT_EQ(hzd::delta::send(client,"delta_new.txt"),true);
+    });
+    hzd::TcpSocket large_tcp;
+    ASSERT_EQ(listener.Accept(large_tcp),true);
+    ASSERT_EQ(hzd::delta::recv(large_tcp,"delta_old.txt"),true);
+    large_thread.join();
+    ASSERT_EQ(read_all("delta_old.txt") == large,true);
+
+    // 超过帧上限的长度头部直接拒绝,不做分配 & a length header over the frame limit is rejected without allocating
+    std::thread bogus_thread([] {
+        hzd::TcpClient client;
+        ASSERT_EQ(client.Connect("127.0.0.1",9999),true);
+        ASSERT_EQ(client.Send(std::string(8,'\xff')),8);
+    });
+    hzd::TcpSocket bogus_tcp;
+    ASSERT_EQ(listener.Accept(bogus_tcp),true);
+    ASSERT_EQ(hzd::delta::recv(bogus_tcp,"delta_old.txt"),false);
+    bogus_thread.join();
+    ASSERT_EQ(read_all("delta_old.txt") == large,true);
+    remove("delta_old.txt");
+    remove("delta_new.txt");
+    remove("delta_out.txt");
+}
+
+TEST(TEST_TAILREADER,FOLLOW_ROTATION) {
+    remove("tail.log");
+    remove("tail.log.1");
+    std::ofstream("tail.log") << "old content\n";
+    hzd::TailReader reader;
+    ASSERT_EQ(reader.Open("tail.log"),true);
+    std::string data;
+    ASSERT_EQ(reader.Read(data),0);
+    ASSERT_EQ(reader.Wait(50),false);
+
+    std::ofstream("tail.log",std::ios::app) << "line1\n";
+    ASSERT_EQ(reader.Wait(1000),true);
+    ASSERT_EQ(reader.Read(data),6);
+    ASSERT_EQ(data,"line1\n");
+
+    // rename轮转:旧文件的尾部先读完,再切换到新文件 & rename rotation: drain old file first,then switch to new one
+    std::ofstream("tail.log",std::ios::app) << "line2\n";
+    rename("tail.log","tail.log.1");
+    std::ofstream("tail.log.1",std::ios::app) << "line3\n";
+    std::ofstream("tail.log") << "new1\n";
+    ASSERT_EQ(reader.Wait(1000),true);
+    std::string all;
+    while(reader.Read(data) > 0) all += data;
+    ASSERT_EQ(all,"line2\nline3\nnew1\n");
+    ASSERT_EQ(reader.Rotations(),1u);
+
+    // copytruncate轮转 & copytruncate rotation
+    truncate("tail.log",0);
+    std::ofstream("tail.log",std::ios::app) << "x\n";
+    ASSERT_EQ(reader.Wait(1000),true);
+    ASSERT_EQ(reader.Read(data),2);
+    ASSERT_EQ(data,"x\n");
+    ASSERT_EQ(reader.Rotations(),2u);
+
+    hzd::TcpListener listener("127.0.0.1",9999);
+    ASSERT_EQ(listener.Bind(),true);
+    ASSERT_EQ(listener.Listen(),true);
+    std::thread t([] {
+        hzd::TcpClient client;
+        ASSERT_EQ(client.Connect("127.0.0.1",9999),true);
+        std::string received;
+        ASSERT_EQ(client.Recv(received,10,false),10);
+        ASSERT_EQ(received,"0123456789");
+    });
+    hzd::TcpSocket tcp;
+    ASSERT_EQ(listener.Accept(tcp),true);
+    std::ofstream("tail.log",std::ios::app) << "0123456789";
+    ASSERT_EQ(reader.SendTo(tcp),10);
+    ASSERT_EQ(reader.SendTo(tcp),0);
+    t.join();
+    reader.Close();
+    remove("tail.log");
+    remove("tail.log.1");
+}
+
+TEST(TEST_TAILREADER,EVENT_LOOP) {
+    remove("tail_loop.log");
+    std::ofstream("tail_loop.log") << "old\n";
+    hzd::TailReader reader;
+    ASSERT_EQ(reader.Open("tail_loop.log"),true);
+    std::string data;
+    ASSERT_EQ(reader.Read(data),0);
+    // 调用者的事件循环:Fd()可读后Wait(0)须读空事件,否则水平触发会一直可读 & caller's event loop: Wait(0) must drain events once Fd() is readable,otherwise level-triggered poll keeps firing
+    std::ofstream("tail_loop.log",std::ios::app) << "line1\n";
+    pollfd poll_fd{};
+    poll_fd.fd = reader.Fd();
+    poll_fd.events = POLLIN;
+    ASSERT_EQ(poll(&poll_fd,1,1000),1);
+    ASSERT_EQ(reader.Wait(0),true);
+    ASSERT_EQ(poll(&poll_fd,1,0),0);
+    ASSERT_EQ(reader.Read(data),6);
+    ASSERT_EQ(data,"line1\n");
+    ASSERT_EQ(reader.Wait(0),false);
+    reader.Close();
+    remove("tail_loop.log");
+}
+
+TEST(TEST_PATH,JOIN_AND_VIEWS) {
+    hzd::Path path("logs");
+    path /= "app";
+    path /= std::string("/seg-1.log");
+    ASSERT_STREQ(path.CStr(),"logs/app/seg-1.log");
+    ASSERT_EQ(path.IsHeap(),false);
+    ASSERT_EQ(path.Filename(),"seg-1.log");
+    ASSERT_EQ(path.Parent(),"logs/app");
+    ASSERT_EQ(path.Extension(),".log");
+    ASSERT_EQ(hzd::Path(".bashrc").Extension().Empty(),true);
+    ASSERT_EQ(hzd::Path("name").Parent(),".");
+    ASSERT_EQ(hzd::Path("/name").Parent(),"/");
+    path.PopBack();
+    ASSERT_EQ(path.View(),"logs/app");
+    ASSERT_EQ((hzd::Path("/") / "usr").String(),"/usr");
+    hzd::Path root("/usr");
+    root.PopBack();
+    ASSERT_EQ(root.View(),"/");
+
+    hzd::Path windows("C:\\data\\\\logs\\");
+    ASSERT_EQ(windows.Normalize().View(),"C:/data/logs");
+
+    hzd::Path deep;
+    for(int i = 0; i < 40; i++) deep /= "level" + std::to_string(i);
+    ASSERT_EQ(deep.IsHeap(),true);
+    hzd::Path copied(deep);
+    hzd::Path moved(std::move(copied));
+    ASSERT_EQ(moved,deep);
+    ASSERT_EQ(copied.Empty(),true);
+    moved = path;
+    ASSERT_EQ(moved.View(),"logs/app");
+
+    // 追加自身的片段,扩容不能读到已释放的旧缓冲区 & appending a piece of itself,growing must not read the freed old buffer
+    std::string long_name(200,'n');
+    hzd::Path self(long_name);
+    ASSERT_EQ(self.IsHeap(),true);
+    self.Append(self.Filename());
+    ASSERT_EQ(self.String(),long_name + "/" + long_name);
+
+    hzd::Path cwd;
+    ASSERT_EQ(hzd::Path::Current(cwd),true);
+    ASSERT_EQ(cwd.String(),hzd::filesystem::pwd());
+}
+
+TEST(TEST_PATH,INTERNER) {
+    hzd::PathInterner interner("/data");
+    uint32_t logs = interner.Intern(hzd::PathInterner::root_id,"logs");
+    uint32_t app = interner.Intern(logs,"app");
+    ASSERT_EQ(interner.Intern(logs,"app"),app);
+    ASSERT_NE(interner.Intern(hzd::PathInterner::root_id,"app"),app);
+    ASSERT_EQ(interner.Count(),4u);
+    ASSERT_EQ(interner.Parent(app),logs);
+    ASSERT_EQ(interner.Name(app),"app");
+    hzd::Path path;
+    interner.Resolve(app,path);
+    ASSERT_EQ(path.View(),"/data/logs/app");
+    interner.Resolve(hzd::PathInterner::root_id,path);
+    ASSERT_EQ(path.View(),"/data");
+
+    std::vector<std::thread> threads;
+    for(int t = 0; t < 4; t++) {
+        threads.emplace_back([&interner,app] {
+            for(int i = 0; i < 1000; i++) interner.Intern(app,"d" + std::to_string(i));
+        });
+    }
+    for(auto& thread : threads) thread.join();
+    ASSERT_EQ(interner.Count(),4u + 1000);
+    interner.Resolve(interner.Intern(app,"d999"),path);
+    ASSERT_EQ(path.View(),"/data/logs/app/d999");
+    std::string long_name(40000,'x');
+    uint32_t long_id = interner.Intern(app,long_name);
+    ASSERT_EQ(interner.Name(long_id).String(),long_name);
+    ASSERT_EQ(interner.Name(logs),"logs");
+}
+
+TEST(TEST_THREADPOOL,NESTED_SUBMIT) {
+    std::atomic<int> count{0};
+    hzd::ThreadPool pool(3);
+    ASSERT_EQ(pool.Size(),3u);
+    std::function<void(int)> spawn = [&](int level) {
+        count++;
+        if(level == 0) return;
+        for(int i = 0; i < 4; i++) pool.Submit([&spawn,level] { spawn(level - 1); });
+    };
+    pool.Submit([&] { spawn(4); });
+    pool.Wait();
+    ASSERT_EQ(count.load(),1 + 4 + 16 + 64 + 256);
+    pool.Submit([&] { count = 0; });
+    pool.Wait();
+    ASSERT_EQ(count.load(),0);
+}
+
 TEST(TEST_TIMERTASK,TIMER_TASK) {
     hzd::TimerTask task(true);
     std::atomic<int> x(0);